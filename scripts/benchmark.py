@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+"""
+Benchmark the DuckDB USD extension on generated scenes.
+
+For every scale and format, a scene is generated with generate_scene.py
+(and kept in --data-dir for later runs). Each function is then measured in
+a fresh process, so that peak RSS belongs to that function alone:
+
+    open_seconds     composing the stage, cold (usd_stage_layers)
+    scan_seconds     the best of --repeat scans of the cached stage
+    rows_per_second  rows of the scan / scan_seconds
+    peak_rss_bytes   peak resident set of the process
+
+Scans aggregate the hash of every column, so every column is computed.
+Results are written as JSON lines, one object per (scale, format, function).
+With --baseline, results are compared to an earlier run and the exit status
+is 1 if a function got slower by more than --threshold.
+
+Requires the usd-core (pxr) and duckdb Python packages.
+
+Examples:
+    python3 scripts/benchmark.py --scales 1000,10000,100000
+    python3 scripts/benchmark.py --scales 1000000 --formats usdc --functions usd_prims,usd_scene
+    python3 scripts/benchmark.py --output new.jsonl --baseline main.jsonl --threshold 0.15
+"""
+
+import argparse
+import json
+import os
+import platform
+import resource
+import subprocess
+import sys
+import time
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_EXTENSION = os.path.join(SCRIPT_DIR, "..", "build", "release", "extension", "usd", "usd.duckdb_extension")
+DEFAULT_DATA_DIR = os.path.join(SCRIPT_DIR, "..", "build", "benchmark")
+
+# Scan of each function; {file} is the scene as a SQL string literal
+QUERIES = {
+    "usd_prims": "FROM usd_prims({file})",
+    "usd_properties": "FROM usd_properties({file})",
+    "usd_relationships": "FROM usd_relationships({file})",
+    "usd_xforms": "FROM usd_xforms({file})",
+    "usd_scene": "FROM usd_scene({file})",
+    "usd_bounds": "FROM usd_bounds({file})",
+    "usd_attribute_values": "FROM usd_attribute_values({file}, attr_name := 'points')",
+    "usd_time_samples": "FROM usd_time_samples({file})",
+    "usd_layer_specs": "FROM usd_layer_specs({file})",
+}
+
+
+def sql_literal(text):
+    return "'" + text.replace("'", "''") + "'"
+
+
+def peak_rss_bytes():
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # Kilobytes on Linux, bytes on macOS
+    return peak if platform.system() == "Darwin" else peak * 1024
+
+
+def run_worker(args):
+    """Measures one function on one scene and prints a JSON object."""
+    import duckdb
+
+    con = duckdb.connect(config={"allow_unsigned_extensions": "true"})
+    con.execute("LOAD " + sql_literal(args.extension))
+    file = sql_literal(args.file)
+
+    start = time.perf_counter()
+    con.execute("SELECT COUNT(*) FROM usd_stage_layers(%s)" % file).fetchall()
+    open_seconds = time.perf_counter() - start
+
+    query = "SELECT COUNT(*), SUM(hash(COLUMNS(*))) " + QUERIES[args.function].format(file=file)
+    rows = 0
+    scan_seconds = None
+    for _ in range(args.repeat):
+        start = time.perf_counter()
+        result = con.execute(query).fetchone()
+        elapsed = time.perf_counter() - start
+        rows = result[0]
+        scan_seconds = elapsed if scan_seconds is None else min(scan_seconds, elapsed)
+
+    print(json.dumps({
+        "function": args.function,
+        "rows": rows,
+        "open_seconds": round(open_seconds, 6),
+        "scan_seconds": round(scan_seconds, 6),
+        "rows_per_second": round(rows / scan_seconds, 1) if scan_seconds > 0 else None,
+        "peak_rss_bytes": peak_rss_bytes(),
+        "duckdb_version": duckdb.__version__,
+    }))
+
+
+def ensure_scene(args, prims, extension):
+    # Every generator argument is in the name, so changed arguments make a new scene
+    name = "scene_%d_f%d_d%d_s%d_i%g_t%d_a%d.%s" % (prims, args.fanout, args.depth, args.servers, args.instanced,
+                                                    args.time_samples, args.array_size, extension)
+    path = os.path.join(args.data_dir, name)
+    if not os.path.exists(path):
+        command = [sys.executable, os.path.join(SCRIPT_DIR, "generate_scene.py"), path, "--prims", str(prims),
+                   "--fanout", str(args.fanout), "--depth", str(args.depth), "--servers", str(args.servers),
+                   "--instanced", str(args.instanced), "--time-samples", str(args.time_samples),
+                   "--array-size", str(args.array_size)]
+        subprocess.run(command, check=True)
+    return path
+
+
+def measure(args, path, function):
+    command = [sys.executable, os.path.abspath(__file__), "--worker", "--extension", args.extension, "--file", path,
+               "--function", function, "--repeat", str(args.repeat)]
+    completed = subprocess.run(command, check=False, capture_output=True, text=True)
+    if completed.returncode != 0:
+        return {"function": function, "error": completed.stderr.strip().splitlines()[-1:] or ["failed"]}
+    return json.loads(completed.stdout.strip().splitlines()[-1])
+
+
+def compare(results, baseline_path, threshold):
+    """Results more than threshold slower than the baseline, as messages."""
+    key = lambda record: (record["prims"], record["format"], record["function"])
+    baseline = {}
+    with open(baseline_path) as baseline_file:
+        for line in baseline_file:
+            if line.strip():
+                record = json.loads(line)
+                baseline[key(record)] = record
+    regressions = []
+    for record in results:
+        before = baseline.get(key(record))
+        if not before or not before.get("rows_per_second") or not record.get("rows_per_second"):
+            continue
+        change = record["rows_per_second"] / before["rows_per_second"] - 1
+        if change < -threshold:
+            regressions.append("%s on %d prims (%s): %.0f -> %.0f rows/s (%+.0f%%)" % (
+                record["function"], record["prims"], record["format"], before["rows_per_second"],
+                record["rows_per_second"], change * 100))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--extension", default=DEFAULT_EXTENSION, help="extension to load")
+    parser.add_argument("--scales", default="1000,10000,100000,1000000",
+                        help="comma-separated prim counts (default: 1000,10000,100000,1000000)")
+    parser.add_argument("--formats", default="usda,usdc", help="comma-separated scene formats (default: usda,usdc)")
+    parser.add_argument("--functions", default=",".join(QUERIES), help="comma-separated functions (default: all)")
+    parser.add_argument("--repeat", type=int, default=3, help="scans per function; the best is kept (default: 3)")
+    parser.add_argument("--data-dir", default=DEFAULT_DATA_DIR, help="where generated scenes are kept")
+    parser.add_argument("--output", help="JSON lines file to write (default: standard output)")
+    parser.add_argument("--baseline", help="JSON lines of an earlier run to compare rows/sec against")
+    parser.add_argument("--threshold", type=float, default=0.2,
+                        help="slowdown that counts as a regression (default: 0.2, i.e. 20%%)")
+    # Scene shape, passed to generate_scene.py
+    parser.add_argument("--fanout", type=int, default=10)
+    parser.add_argument("--depth", type=int, default=2)
+    parser.add_argument("--servers", type=int, default=8)
+    parser.add_argument("--instanced", type=float, default=0.0)
+    parser.add_argument("--time-samples", type=int, default=4)
+    parser.add_argument("--array-size", type=int, default=256)
+    # A single measurement, run by the driver in a fresh process
+    parser.add_argument("--worker", action="store_true", help=argparse.SUPPRESS)
+    parser.add_argument("--file", help=argparse.SUPPRESS)
+    parser.add_argument("--function", help=argparse.SUPPRESS)
+    args = parser.parse_args()
+    args.extension = os.path.abspath(args.extension)
+
+    if args.worker:
+        run_worker(args)
+        return 0
+
+    functions = [name for name in args.functions.split(",") if name]
+    unknown = [name for name in functions if name not in QUERIES]
+    if unknown:
+        parser.error("unknown functions: " + ", ".join(unknown))
+    if args.repeat < 1:
+        parser.error("--repeat must be at least 1")
+
+    results = []
+    output = open(args.output, "w") if args.output else sys.stdout
+    try:
+        for prims in (int(scale) for scale in args.scales.split(",") if scale):
+            for extension in (name for name in args.formats.split(",") if name):
+                path = ensure_scene(args, prims, extension)
+                for function in functions:
+                    record = {"prims": prims, "format": extension, "file_bytes": os.path.getsize(path)}
+                    record.update(measure(args, path, function))
+                    results.append(record)
+                    output.write(json.dumps(record) + "\n")
+                    output.flush()
+                    if "error" in record:
+                        print("%-22s %9d %s  error: %s" % (function, prims, extension, record["error"][0]),
+                              file=sys.stderr)
+                    else:
+                        print("%-22s %9d %s  open %8.3fs  scan %8.3fs  %12.0f rows/s  %7.1f MB" % (
+                            function, prims, extension, record["open_seconds"], record["scan_seconds"],
+                            record["rows_per_second"] or 0, record["peak_rss_bytes"] / 1e6), file=sys.stderr)
+    finally:
+        if output is not sys.stdout:
+            output.close()
+
+    if args.baseline:
+        regressions = compare(results, args.baseline, args.threshold)
+        for message in regressions:
+            print("REGRESSION " + message, file=sys.stderr)
+        if regressions:
+            return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""
+Generate synthetic datacenter scenes for benchmarking the DuckDB USD extension.
+
+A scene is a tree of Xform groups (--fanout children per level, --depth
+levels) holding racks. Each rack has a PDU, --servers Cube servers with a
+powerDraw attribute (time-sampled with --time-samples) and a power:source
+relationship to the PDU, and a Mesh panel with --array-size points. Racks
+feed from a tree of power feeds, so relationship closures have depth.
+--instanced makes that fraction of the racks instanceable references to one
+rack prototype instead of authoring them inline.
+
+The output format follows the extension (.usda or .usdc). Scenes are
+deterministic: the same arguments always produce the same file.
+
+Examples:
+    python3 scripts/generate_scene.py bench.usdc --prims 1000000
+    python3 scripts/generate_scene.py deep.usda --prims 10000 --fanout 2 --depth 12
+    python3 scripts/generate_scene.py inst.usdc --prims 1000000 --instanced 0.9
+"""
+
+import argparse
+import os
+import sys
+
+from pxr import Gf, Sdf, Vt
+
+# Rack prims besides the servers: the rack, its PDU and its panel
+RACK_FIXED_PRIMS = 3
+PROTOTYPE_PATH = Sdf.Path("/_Prototypes/Rack")
+# Racks per power feed, and feeds per upstream feed
+RACKS_PER_FEED = 16
+FEED_FANOUT = 4
+
+
+def prims_per_rack(servers):
+    return servers + RACK_FIXED_PRIMS
+
+
+def rack_count(prims, servers):
+    """Racks needed for about prims prims once instances are expanded."""
+    return max(1, prims // prims_per_rack(servers))
+
+
+def define(layer, path, type_name, specifier=Sdf.SpecifierDef):
+    spec = Sdf.CreatePrimInLayer(layer, path)
+    spec.specifier = specifier
+    spec.typeName = type_name
+    return spec
+
+
+def set_attribute(spec, name, type_name, value, uniform=False):
+    variability = Sdf.VariabilityUniform if uniform else Sdf.VariabilityVarying
+    attr = Sdf.AttributeSpec(spec, name, type_name, variability)
+    if value is not None:
+        attr.default = value
+    return attr
+
+
+def set_translate(spec, translation):
+    set_attribute(spec, "xformOp:translate", Sdf.ValueTypeNames.Double3, Gf.Vec3d(*translation))
+    set_attribute(spec, "xformOpOrder", Sdf.ValueTypeNames.TokenArray, Vt.TokenArray(["xformOp:translate"]),
+                  uniform=True)
+
+
+def set_target(spec, name, target):
+    rel = Sdf.RelationshipSpec(spec, name, custom=True)
+    rel.targetPathList.explicitItems = [target]
+
+
+def panel_points(size, offset):
+    """A size-point grid, shifted by offset so that racks hold distinct arrays."""
+    try:
+        import numpy
+        grid = numpy.zeros((size, 3), dtype=numpy.float32)
+        grid[:, 0] = numpy.arange(size, dtype=numpy.float32) % 64 * 0.01 + offset
+        grid[:, 1] = numpy.arange(size, dtype=numpy.float32) // 64 * 0.01
+        return Vt.Vec3fArray.FromNumpy(grid)
+    except ImportError:
+        return Vt.Vec3fArray([Gf.Vec3f(i % 64 * 0.01 + offset, i // 64 * 0.01, 0) for i in range(size)])
+
+
+def author_rack_contents(layer, rack_path, args, index):
+    """The PDU, servers and panel of a rack (or of the rack prototype)."""
+    pdu_path = rack_path.AppendChild("PDU")
+    pdu = define(layer, pdu_path, "Xform")
+    set_translate(pdu, (0, 0, -0.5))
+
+    for server_index in range(args.servers):
+        server = define(layer, rack_path.AppendChild("Server_%02d" % server_index), "Cube")
+        set_translate(server, (0, 0.1 + 0.05 * server_index, 0))
+        draw = set_attribute(server, "powerDraw", Sdf.ValueTypeNames.Double, 350.0 + server_index)
+        draw.custom = True
+        for sample in range(args.time_samples):
+            layer.SetTimeSample(draw.path, float(sample), 350.0 + server_index + (index + sample) % 50)
+        set_target(server, "power:source", pdu_path)
+
+    if args.array_size > 0:
+        panel = define(layer, rack_path.AppendChild("Panel"), "Mesh")
+        offset = index % 97 * 0.001
+        set_attribute(panel, "points", Sdf.ValueTypeNames.Point3fArray, panel_points(args.array_size, offset))
+        extent_max = Gf.Vec3f((min(args.array_size, 64) - 1) * 0.01 + offset, (args.array_size - 1) // 64 * 0.01, 0)
+        set_attribute(panel, "extent", Sdf.ValueTypeNames.Float3Array,
+                      Vt.Vec3fArray([Gf.Vec3f(offset, 0, 0), extent_max]))
+    else:
+        define(layer, rack_path.AppendChild("Panel"), "Xform")
+
+
+def group_path(index, args):
+    """Group holding leaf group index: its digits in base fanout, one per level."""
+    path = Sdf.Path("/World/Racks")
+    digits = []
+    for _ in range(args.depth):
+        digits.append(index % args.fanout if args.fanout > 1 else 0)
+        index = index // args.fanout if args.fanout > 1 else index
+    for level, digit in enumerate(reversed(digits)):
+        path = path.AppendChild("Group_%d_%d" % (level, digit))
+    return path
+
+
+def generate(output_path, args):
+    racks = rack_count(args.prims, args.servers)
+    instanced = int(racks * args.instanced)
+    leaves = racks if args.fanout <= 1 else min(racks, args.fanout ** args.depth)
+    feeds = max(1, (racks + RACKS_PER_FEED - 1) // RACKS_PER_FEED)
+
+    layer = Sdf.Layer.CreateNew(output_path)
+    layer.defaultPrim = "World"
+    with Sdf.ChangeBlock():
+        world = define(layer, Sdf.Path("/World"), "Xform")
+        world.kind = "assembly"
+        define(layer, Sdf.Path("/World/Racks"), "Xform")
+
+        # Power feeds, each fed by its parent feed
+        define(layer, Sdf.Path("/World/Power"), "Xform")
+        for feed in range(feeds):
+            spec = define(layer, Sdf.Path("/World/Power/Feed_%d" % feed), "Xform")
+            set_translate(spec, (feed * 2.0, 0, -10))
+            if feed > 0:
+                set_target(spec, "power:upstream", Sdf.Path("/World/Power/Feed_%d" % ((feed - 1) // FEED_FANOUT)))
+
+        if instanced > 0:
+            prototype = define(layer, PROTOTYPE_PATH, "Xform", Sdf.SpecifierClass)
+            prototype.kind = "component"
+            author_rack_contents(layer, PROTOTYPE_PATH, args, 0)
+
+        groups = set()
+        for index in range(racks):
+            parent = group_path(index % leaves, args)
+            if parent not in groups:
+                for prefix in parent.GetPrefixes():
+                    if prefix not in groups and prefix.pathElementCount > 2:
+                        define(layer, prefix, "Xform")
+                        groups.add(prefix)
+            rack_path = parent.AppendChild("Rack_%d" % index)
+            rack = define(layer, rack_path, "Xform")
+            rack.kind = "component"
+            set_translate(rack, (index % 100 * 1.2, 0, index // 100 * 2.5))
+            set_target(rack, "power:feed", Sdf.Path("/World/Power/Feed_%d" % (index // RACKS_PER_FEED)))
+            # Instanced racks are spread over the scene, not grouped at its start
+            if instanced > 0 and index * instanced // racks != (index + 1) * instanced // racks:
+                rack.instanceable = True
+                rack.referenceList.Prepend(Sdf.Reference("", PROTOTYPE_PATH))
+            else:
+                author_rack_contents(layer, rack_path, args, index)
+
+    layer.Save()
+    return racks
+
+
+def add_arguments(parser):
+    parser.add_argument("--prims", type=int, default=10000,
+                        help="approximate prim count with instances expanded (default: 10000)")
+    parser.add_argument("--fanout", type=int, default=10, help="child groups per group level (default: 10)")
+    parser.add_argument("--depth", type=int, default=2, help="group levels above the racks (default: 2)")
+    parser.add_argument("--servers", type=int, default=8, help="servers per rack (default: 8)")
+    parser.add_argument("--instanced", type=float, default=0.0,
+                        help="fraction of racks authored as instances of one prototype (default: 0)")
+    parser.add_argument("--time-samples", type=int, default=0,
+                        help="time samples of each server's powerDraw (default: 0, default values only)")
+    parser.add_argument("--array-size", type=int, default=256, help="points of each rack panel mesh (default: 256)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("output", help="scene to write (.usda or .usdc)")
+    add_arguments(parser)
+    args = parser.parse_args()
+    if not 0 <= args.instanced <= 1:
+        parser.error("--instanced must be between 0 and 1")
+    if args.depth < 0 or args.fanout < 1 or args.servers < 0:
+        parser.error("--depth, --fanout and --servers must not be negative (and --fanout at least 1)")
+
+    output_path = args.output
+    directory = os.path.dirname(output_path)
+    if directory:
+        os.makedirs(directory, exist_ok=True)
+    if os.path.exists(output_path):
+        os.remove(output_path)
+    racks = generate(output_path, args)
+    print("Created %s: %d racks, about %d prims" % (output_path, racks, racks * prims_per_rack(args.servers)),
+          file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
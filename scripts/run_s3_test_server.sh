@@ -0,0 +1,33 @@
+#!/usr/bin/env bash
+# Starts a local MinIO server holding test/data in the usd-test bucket and
+# exports the variables test/sql/usd_remote.test requires. Source it:
+#
+#   source scripts/run_s3_test_server.sh
+#   make test
+#
+# Requires docker. Stop the server with: docker rm -f duckdb-usd-minio
+
+ROOT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")/.." && pwd)"
+
+export S3_TEST_SERVER_AVAILABLE=1
+export AWS_DEFAULT_REGION=eu-west-1
+export AWS_ACCESS_KEY_ID=minio_duckdb_user
+export AWS_SECRET_ACCESS_KEY=minio_duckdb_user_password
+export DUCKDB_S3_ENDPOINT=localhost:9000
+export DUCKDB_S3_USE_SSL=false
+
+docker rm -f duckdb-usd-minio >/dev/null 2>&1
+docker run -d --name duckdb-usd-minio -p 9000:9000 \
+    -e MINIO_ROOT_USER="$AWS_ACCESS_KEY_ID" \
+    -e MINIO_ROOT_PASSWORD="$AWS_SECRET_ACCESS_KEY" \
+    minio/minio:latest server /data >/dev/null || return 1 2>/dev/null || exit 1
+
+for _ in $(seq 1 30); do
+    curl -sf "http://$DUCKDB_S3_ENDPOINT/minio/health/live" >/dev/null && break
+    sleep 1
+done
+
+docker run --rm --network host -v "$ROOT_DIR/test/data:/seed:ro" --entrypoint sh minio/mc:latest -c "
+    mc alias set local http://$DUCKDB_S3_ENDPOINT $AWS_ACCESS_KEY_ID $AWS_SECRET_ACCESS_KEY >/dev/null &&
+    mc mb --ignore-existing local/usd-test >/dev/null &&
+    mc cp --recursive /seed/ local/usd-test/ >/dev/null"
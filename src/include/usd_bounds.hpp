@@ -0,0 +1,12 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+class UsdBoundsFunction {
+public:
+    static TableFunction GetFunction();
+};
+
+} // namespace duckdb
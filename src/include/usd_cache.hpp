@@ -0,0 +1,17 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+class UsdCacheStatsFunction {
+public:
+    static TableFunction GetFunction();
+};
+
+class UsdCacheClearFunction {
+public:
+    static TableFunction GetFunction();
+};
+
+} // namespace duckdb
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+// usd_changes(file_path, since := token): paths of the cached stage of
+// file_path recomposed by layer reloads after token
+class UsdChangesFunction {
+public:
+    static TableFunction GetFunction();
+};
+
+} // namespace duckdb
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include <pxr/usd/sdf/types.h>
+#include <string>
+
+namespace duckdb {
+
+// Read-only reader of the structural sections of .usdc (crate) files. Only the
+// bootstrap header, the table of contents and the sections a scan needs are
+// fetched, through DuckDB's FileSystem (ranged reads for remote files). Specs
+// are decoded into flat arrays, never into an SdfLayer, and field values that
+// are not inlined in their value reps are left unread in the file.
+class UsdCrateReader {
+public:
+    // Sections to decode besides SPECS (always decoded), as bits of a mask
+    enum Sections : uint8_t {
+        // TOKENS and PATHS, for spec paths
+        CRATE_PATHS = 1 << 0,
+        // TOKENS, FIELDS and FIELDSETS, for inlined fields such as typeName
+        CRATE_FIELDS = 1 << 1
+    };
+
+    // Reads the requested sections of path. Returns nullptr if path is not a
+    // crate file of a supported version (text layers, .usdz packages, crate
+    // versions before 0.4.0), so callers can fall back to SdfLayer.
+    static unique_ptr<UsdCrateReader> TryOpen(ClientContext &context, const std::string &path, uint8_t sections);
+    // Reads only the spec count of path (a few hundred bytes); false if path
+    // is not a supported crate file
+    static bool TryReadSpecCount(ClientContext &context, const std::string &path, idx_t &count);
+
+    idx_t SpecCount() const {
+        return spec_paths.size();
+    }
+    pxr::SdfSpecType GetSpecType(idx_t spec) const {
+        return static_cast<pxr::SdfSpecType>(spec_types[spec]);
+    }
+    // Requires CRATE_PATHS
+    std::string GetSpecPath(idx_t spec) const;
+    // Requires CRATE_PATHS; false for the pseudo-root
+    bool GetParentPath(idx_t spec, std::string &result) const;
+    // Require CRATE_FIELDS; false if the spec has no such field
+    bool GetSpecifier(idx_t spec, pxr::SdfSpecifier &result) const;
+    bool GetTypeName(idx_t spec, std::string &result) const;
+
+private:
+    // One node of the path tree: parent node and element token (negative
+    // for property names)
+    struct PathNode {
+        uint32_t parent;
+        int32_t element;
+    };
+
+    std::string path;
+    std::vector<std::string> tokens;
+    std::vector<PathNode> paths;
+    std::vector<uint32_t> field_tokens;
+    std::vector<uint64_t> field_reps;
+    std::vector<uint32_t> field_sets;
+    std::vector<uint32_t> spec_paths;
+    std::vector<uint32_t> spec_field_sets;
+    std::vector<uint32_t> spec_types;
+    // Token indexes of the field names read from inlined value reps
+    uint32_t specifier_token = ~uint32_t(0);
+    uint32_t type_name_token = ~uint32_t(0);
+
+    UsdCrateReader() = default;
+    void ReadTokens(const std::vector<char> &section);
+    void ReadPaths(const std::vector<char> &section);
+    void ReadFields(const std::vector<char> &section);
+    void ReadFieldSets(const std::vector<char> &section);
+    void ReadSpecs(const std::vector<char> &section, uint8_t sections);
+    uint32_t FindToken(const char *token) const;
+    std::string PathString(uint32_t node) const;
+    // Inlined value rep of field_token in the spec's field set, if present
+    bool FindInlinedField(idx_t spec, uint32_t field_token, uint8_t value_type, uint64_t &payload) const;
+};
+
+} // namespace duckdb
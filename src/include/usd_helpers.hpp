@@ -1,23 +1,370 @@
 #pragma once
 
 #include "duckdb.hpp"
+#include "usd_statistics.hpp"
 #include <pxr/usd/usd/stage.h>
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usd/primFlags.h>
+#include <pxr/usd/usd/property.h>
+#include <pxr/usd/usd/relationship.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/base/tf/token.h>
 #include <string>
 #include <memory>
+#include <functional>
+#include <atomic>
+#include <unordered_map>
 
 namespace duckdb {
 
+// Snapshot of the process-wide stage cache counters
+struct UsdStageCacheStats {
+    idx_t entries = 0;
+    idx_t resident_bytes = 0;
+    idx_t memory_limit = 0;
+    idx_t hits = 0;
+    idx_t misses = 0;
+    idx_t evictions = 0;
+    idx_t invalidations = 0;
+    idx_t reloads = 0;
+};
+
+// A prim or property path recomposed by a layer reload of a cached stage.
+// Tokens increase with every change notice, across all stages.
+struct UsdStageChange {
+    idx_t token;
+    pxr::SdfPath path;
+    // Whether the path and its descendants were recomposed (prims or
+    // properties added, removed or restructured), rather than only metadata
+    // or values changed
+    bool resynced;
+};
+
+struct UsdScanFilter;
+
+// On-disk identity of one layer used by a composed stage
+struct UsdLayerStamp {
+    std::string path;
+    int64_t mtime;
+    uint64_t size;
+};
+
+// How a stage is composed: which prims are populated and whether payloads
+// are loaded. Set through the mask := and load := parameters of every scan.
+struct UsdStageLoadOptions {
+    // Prims to populate, together with their ancestors and descendants
+    // (empty = the whole stage)
+    std::vector<pxr::SdfPath> population_mask;
+    // Set when population_mask was derived from a pushed-down path filter:
+    // any stage populating at least those prims, such as an already cached
+    // unmasked stage, can serve the scan
+    bool mask_is_hint = false;
+    bool load_payloads = true;
+
+    // Reads the mask and load named parameters of function_name
+    void Bind(const std::string &function_name, const named_parameter_map_t &named_parameters);
+    // Masks the stage to the subtree that can satisfy filter, unless an
+    // explicit mask was given
+    UsdStageLoadOptions WithFilter(const UsdScanFilter &filter) const;
+    // Cache key suffix identifying the composed stage (empty for the default)
+    std::string CacheKeySuffix() const;
+
+    static void RegisterParameters(TableFunction &func);
+};
+
+// Data derived from a composed stage (such as a spatial index), cached
+// together with the stage and dropped when the stage is evicted
+class UsdStageDerivedData {
+public:
+    virtual ~UsdStageDerivedData() = default;
+    // Estimated memory footprint, counted against the stage cache limit
+    virtual idx_t EstimatedSize() const = 0;
+};
+
 class UsdStageManager {
 public:
-    static pxr::UsdStageRefPtr OpenStage(const std::string &file_path);
+    // Name and default of the setting bounding the stage cache
+    static constexpr const char *CACHE_LIMIT_SETTING = "usd_cache_memory_limit";
+    static constexpr const char *CACHE_LIMIT_DEFAULT = "2GB";
+
+    // Returns a composed stage for file_path, reusing a cached stage when the
+    // file (and every layer it uses) is unchanged. profile, if given, counts
+    // the cache hit or miss.
+    static pxr::UsdStageRefPtr OpenStage(ClientContext &context, const std::string &file_path,
+                                         const UsdStageLoadOptions &options = UsdStageLoadOptions(),
+                                         UsdScanProfile *profile = nullptr);
     static bool IsValidUsdFile(const std::string &file_path);
+    // Reads file_path as a single layer, without composing a stage. The layer
+    // is private to the caller: it always reflects the file's current
+    // contents and is never shared with (or reloaded under) cached stages.
+    static pxr::SdfLayerRefPtr OpenLayer(ClientContext &context, const std::string &file_path);
+
+    // Returns the data registered under name for stage, calling build on
+    // first use. Data of a stage that is not cached is built every time.
+    static std::shared_ptr<UsdStageDerivedData>
+    GetDerivedData(ClientContext &context, const pxr::UsdStageRefPtr &stage, const std::string &name,
+                   const std::function<std::shared_ptr<UsdStageDerivedData>()> &build);
+    template <class T>
+    static std::shared_ptr<T> GetDerivedData(ClientContext &context, const pxr::UsdStageRefPtr &stage,
+                                             const std::string &name,
+                                             const std::function<std::shared_ptr<UsdStageDerivedData>()> &build) {
+        return std::static_pointer_cast<T>(GetDerivedData(context, stage, name, build));
+    }
+
+    // Layers the stage was composed from, as stamped when it was opened (or
+    // now, if the stage is not cached). Layers without a file of their own,
+    // such as those inside packages, are left out.
+    static std::vector<UsdLayerStamp> GetLayerStamps(ClientContext &context, const pxr::UsdStageRefPtr &stage);
+
+    // Appends the changes recorded for stage after token since, and returns
+    // the token its record starts at: changes at or before it are unknown.
+    // Only cached stages record changes.
+    static idx_t GetChanges(const pxr::UsdStageRefPtr &stage, idx_t since, std::vector<UsdStageChange> &changes);
+
+    static UsdStageCacheStats GetCacheStats();
+    // Drops every cached stage; returns the number of entries and bytes released
+    static std::pair<idx_t, idx_t> ClearCache();
+};
+
+// Files read by a scan. The file_path argument of every usd_* scan is a
+// path, a glob pattern or a LIST of either.
+class UsdFileList {
+public:
+    // Id of the filename virtual column (the id DuckDB's file readers use)
+    static constexpr column_t FILENAME_COLUMN = VIRTUAL_COLUMN_START;
+
+    // Expands and validates the file_path argument of function_name; globs
+    // expand to their matches in sorted order
+    static vector<std::string> Bind(ClientContext &context, const std::string &function_name, const Value &input);
+    // Checks that file_path names a USD file (local, or remote through
+    // DuckDB's FileSystem); errors are prefixed with function_name
+    static void Validate(ClientContext &context, const std::string &function_name, const std::string &file_path);
+    // Modification time and size of a local or remote file; false if it
+    // cannot be stat'ed
+    static bool Stat(ClientContext &context, const std::string &path, int64_t &mtime, uint64_t &size);
+    // Registers the filename virtual column on a scan
+    static void RegisterFilenameColumn(TableFunction &func);
+    // Overloads of a scan taking one path or glob (VARCHAR) and a LIST of them
+    static TableFunctionSet GetFunctionSet(TableFunction scan);
+};
+
+// Output layout of a scan with projection pushdown: maps each table column to
+// its vector in the output chunk, if the column was projected
+class UsdColumnProjection {
+public:
+    UsdColumnProjection() = default;
+    UsdColumnProjection(const vector<column_t> &column_ids, idx_t column_count);
+
+    bool IsProjected(idx_t column) const {
+        return output_index_[column] != DConstants::INVALID_INDEX;
+    }
+    // Output vector of column, or nullptr if it was not projected
+    Vector *GetVector(DataChunk &output, idx_t column) const {
+        auto index = output_index_[column];
+        return index == DConstants::INVALID_INDEX ? nullptr : &output.data[index];
+    }
+    template <class T>
+    T *GetData(DataChunk &output, idx_t column) const {
+        auto vector = GetVector(output, column);
+        return vector ? FlatVector::GetData<T>(*vector) : nullptr;
+    }
+    // Fills the filename column with file_path and sets the other output
+    // columns that are not table columns (such as the row id requested for
+    // COUNT(*)) to NULL so they never expose uninitialized data
+    void FinalizeChunk(DataChunk &output, const std::string &file_path = std::string()) const;
+
+private:
+    vector<idx_t> output_index_;
+    vector<idx_t> virtual_outputs_;
+    idx_t filename_output_ = DConstants::INVALID_INDEX;
+};
+
+// Output of a low-cardinality token column (prim types, kinds) as a
+// dictionary vector: each distinct token is copied into the dictionary once
+// and rows select its entry, so downstream hashing and grouping work on a
+// handful of strings. Tokens are keyed by identity (TfToken compares by
+// pointer). One dictionary per thread, reused across chunks until it fills.
+class UsdTokenDictionary {
+public:
+    UsdTokenDictionary();
+
+    // Selects the entry of token for row of the current chunk; the empty
+    // token reads as empty_text
+    void Select(idx_t row, const pxr::TfToken &token, const std::string &empty_text = std::string());
+    // Makes result a dictionary vector over the count selected rows and
+    // starts the next chunk
+    void Finalize(Vector &result, idx_t count);
+    // Tokens selected since the previous call, for distinct counts (a token
+    // may repeat if the dictionary was replaced in between)
+    std::vector<pxr::TfToken> TakeSelectedTokens();
+
+private:
+    unique_ptr<Vector> entries_;
+    idx_t entry_count_ = 0;
+    std::unordered_map<pxr::TfToken, uint32_t, pxr::TfToken::HashFunctor> index_;
+    SelectionVector sel_;
+    // Generation in which each entry was last selected
+    std::vector<idx_t> entry_generation_;
+    idx_t generation_ = 1;
+    std::vector<pxr::TfToken> selected_;
+};
+
+// Rows of a VARCHAR vector may reference the strings of the stage's paths and
+// tokens (UsdStringRef) instead of copying them, once the vector keeps the
+// stage alive with UsdKeepStageAlive
+void UsdKeepStageAlive(Vector &vector, const pxr::UsdStageRefPtr &stage);
+
+inline string_t UsdStringRef(const std::string &value) {
+    return string_t(value.data(), UnsafeNumericCast<uint32_t>(value.size()));
+}
+
+// Global state of a scan over several files. Threads claim whole files, so
+// each thread composes and scans its own stage.
+struct UsdMultiFileGlobalState : public GlobalTableFunctionState {
+    idx_t file_count = 0;
+    std::atomic<idx_t> next_file {0};
+    UsdColumnProjection projection;
+    UsdScanTracker tracker;
+
+    explicit UsdMultiFileGlobalState(idx_t file_count) : file_count(file_count) {}
+
+    idx_t MaxThreads() const override {
+        return MaxValue<idx_t>(file_count, 1);
+    }
+};
+
+// Per-thread state of a multi-file scan: the file being scanned and its stage.
+// Chunks never span two files, so the file index is the chunk's batch index
+// (keeping the output in file order) and filename is constant per chunk.
+struct UsdMultiFileLocalState : public LocalTableFunctionState {
+    idx_t file_index = DConstants::INVALID_INDEX;
+    pxr::UsdStageRefPtr stage;
+    // Rows produced from the current file
+    idx_t file_rows = 0;
+    // Counters and phase times of this thread, flushed after every chunk
+    UsdScanProfile profile;
+
+    // Claims the next file and opens its stage; false when all files are taken
+    bool OpenNextFile(ClientContext &context, UsdMultiFileGlobalState &gstate, const vector<std::string> &files,
+                      const UsdStageLoadOptions &options);
+    // Reports the current file, read to its end, and the profile to the scan's
+    // tracker. Called when claiming the next file.
+    void CompleteFile(UsdMultiFileGlobalState &gstate);
+    // Counts the rows of a chunk read from the current file, fills its columns
+    // that are not table columns and flushes the profile
+    void FinalizeChunk(UsdMultiFileGlobalState &gstate, DataChunk &output, const vector<std::string> &files);
+
+    static OperatorPartitionData GetPartitionData(ClientContext &context, TableFunctionGetPartitionInput &input);
+};
+
+class LogicalGet;
+class Expression;
+
+// Table columns a scan exposes to filter pushdown (INVALID_INDEX if absent)
+struct UsdFilterColumns {
+    idx_t prim_path = DConstants::INVALID_INDEX;
+    idx_t prim_type = DConstants::INVALID_INDEX;
+    idx_t kind = DConstants::INVALID_INDEX;
+    idx_t property_name = DConstants::INVALID_INDEX;
+};
+
+// Which prims a scan visits, set with traversal :=
+enum class UsdTraversalMode : uint8_t {
+    // stage->Traverse(): active, loaded, defined, non-abstract prims;
+    // instances are visited but not expanded
+    DEFAULT,
+    // Every prim (UsdPrimAllPrimsPredicate), inactive, unloaded, undefined
+    // and abstract ones included
+    ALL,
+    // The default prims plus the instance proxies below every instance
+    INSTANCE_PROXIES,
+    // The default prims of the instancing prototypes, each prototype once
+    PROTOTYPES_ONLY
+};
+
+// Predicates extracted from a query's WHERE clause, and the traversal they
+// apply to. The predicates only let a scan skip work: DuckDB keeps and
+// re-evaluates the original filters on the output.
+struct UsdScanFilter {
+    // Matching prims have paths starting with path_prefix (empty = any)
+    std::string path_prefix;
+    // Set when the prefix is an exact prim path (prim_path = '...')
+    bool exact_path = false;
+    // Accepted prim type names and kinds (empty = any)
+    std::vector<pxr::TfToken> prim_types;
+    std::vector<pxr::TfToken> kinds;
+    // Accepted property or relationship names (empty = any)
+    std::vector<pxr::TfToken> property_names;
+    UsdTraversalMode traversal = UsdTraversalMode::DEFAULT;
+
+    // Reads the traversal named parameter of function_name
+    void BindTraversal(const std::string &function_name, const named_parameter_map_t &named_parameters);
+    static void RegisterParameters(TableFunction &func);
+    // Predicate selecting the prims (and children) the traversal visits
+    pxr::Usd_PrimFlagsPredicate TraversalPredicate() const;
+
+    // Collects the filters on this scan's columns; filters are left in place
+    void Pushdown(LogicalGet &get, const vector<unique_ptr<Expression>> &filters, const UsdFilterColumns &columns);
+
+    bool HasPathFilter() const {
+        return !path_prefix.empty();
+    }
+    // Whether no predicate was pushed down (the scan visits every prim)
+    bool IsEmpty() const {
+        return path_prefix.empty() && prim_types.empty() && kinds.empty() && property_names.empty();
+    }
+    // Deepest prim that is an ancestor of (or equal to) every matching prim
+    pxr::SdfPath TraversalRoot() const;
+    // Whether the prim at path or any of its descendants can match
+    bool MayContainMatches(const pxr::SdfPath &path) const;
+    // Checks path, type and kind without building any strings
+    bool Matches(const pxr::UsdPrim &prim) const;
+    // Properties of prim that can match, in GetProperties() order
+    std::vector<pxr::UsdProperty> GetProperties(const pxr::UsdPrim &prim) const;
+    std::vector<pxr::UsdRelationship> GetRelationships(const pxr::UsdPrim &prim) const;
+};
+
+// One entry of a partitioned traversal: a prim and, unless it is an ancestor
+// of deeper entries, all of its descendants
+struct UsdTraversalRoot {
+    pxr::SdfPath path;
+    bool descend;
+};
+
+// Preorder split of stage->Traverse() into independent work units.
+// Concatenating the units in order reproduces the serial traversal order.
+struct UsdTraversalPartition {
+    // Depth limit used when no explicit partition depth is requested
+    static constexpr idx_t MAX_AUTO_DEPTH = 4;
+
+    std::vector<UsdTraversalRoot> roots;
+    // Unit i covers roots [unit_offsets[i], unit_offsets[i + 1])
+    std::vector<idx_t> unit_offsets;
+
+    idx_t UnitCount() const {
+        return unit_offsets.empty() ? 0 : unit_offsets.size() - 1;
+    }
+
+    // Splits at partition_depth (1 = children of the pseudo-root); 0 deepens
+    // automatically until there are at least target_units subtrees. Only the
+    // subtree that can satisfy filter is partitioned.
+    static UsdTraversalPartition Build(const pxr::UsdStageRefPtr &stage, idx_t partition_depth, idx_t target_units,
+                                       const UsdScanFilter &filter);
 };
 
 class UsdPrimIterator {
 public:
     explicit UsdPrimIterator(pxr::UsdStageRefPtr stage);
+    // Iterates only the prims of the filter's traversal that can satisfy
+    // filter, starting at its traversal root (or at each prototype) and
+    // pruning subtrees that cannot contain matches. profile, if given, counts
+    // the prims visited and the subtrees pruned.
+    UsdPrimIterator(pxr::UsdStageRefPtr stage, const UsdScanFilter &filter, UsdScanProfile *profile = nullptr);
+    // Iterates root and, if descend is set, its descendants
+    UsdPrimIterator(const pxr::UsdPrim &root, bool descend, const UsdScanFilter *filter = nullptr,
+                    UsdScanProfile *profile = nullptr);
     
     bool HasNext() const;
     pxr::UsdPrim GetNext();
@@ -28,7 +375,15 @@ private:
     pxr::UsdPrimRange::iterator current_;
     pxr::UsdPrimRange::iterator end_;
     pxr::UsdPrimRange range_;
+    bool descend_ = true;
+    const UsdScanFilter *filter_ = nullptr;
+    // Further roots to traverse once range_ is exhausted
+    std::vector<pxr::UsdPrim> roots_;
+    idx_t next_root_ = 0;
+    UsdScanProfile *profile_ = nullptr;
+
+    // Moves current_ forward to the next prim accepted by filter_
+    void SkipToMatch();
 };
 
 } // namespace duckdb
-
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/insertion_order_preserving_map.hpp"
+#include "duckdb/main/client_context_state.hpp"
+#include <chrono>
+#include <mutex>
+#include <string>
+
+namespace duckdb {
+
+// Phases of a scan, timed separately: composing (or fetching from the cache)
+// stages, walking prims, reading values from the stage and writing rows
+enum class UsdScanPhase : uint8_t { NONE, OPEN, TRAVERSE, EXTRACT, EMIT };
+static constexpr idx_t USD_SCAN_PHASE_COUNT = 5;
+
+// Counters of one thread of a scan, added to the scan's totals by
+// UsdScanTracker::Flush. Counters are always kept; phases are only timed when
+// timing is set (the query is profiled, or usd_scan_timing is on), so that
+// unprofiled scans do not read the clock for every row.
+struct UsdScanProfile {
+    bool timing = false;
+    UsdScanPhase phase = UsdScanPhase::NONE;
+    std::chrono::steady_clock::time_point phase_start;
+    idx_t phase_nanos[USD_SCAN_PHASE_COUNT] = {};
+    // Prims the traversal stepped on, and subtrees it skipped whole because
+    // the pushed-down filters cannot match below them
+    idx_t prims_visited = 0;
+    idx_t prims_pruned = 0;
+    // Bytes of the VARCHAR values of emitted rows, copied or referenced
+    idx_t string_bytes = 0;
+    idx_t stage_cache_hits = 0;
+    idx_t stage_cache_misses = 0;
+
+    // Ends the running phase and starts next; NONE stops the clock
+    void Enter(UsdScanPhase next) {
+        if (!timing || next == phase) {
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (phase != UsdScanPhase::NONE) {
+            phase_nanos[static_cast<idx_t>(phase)] +=
+                NumericCast<idx_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - phase_start).count());
+        }
+        phase = next;
+        phase_start = now;
+    }
+    void CountStageOpen(bool cache_hit) {
+        if (cache_hit) {
+            stage_cache_hits++;
+        } else {
+            stage_cache_misses++;
+        }
+    }
+    // Adds the bytes of the VARCHAR columns of chunk, once it is complete
+    void CountStrings(DataChunk &chunk);
+};
+
+// Outcome of one finished scan, as reported by usd_last_scan_stats()
+struct UsdScanStats {
+    std::string function_name;
+    idx_t rows = 0;
+    idx_t prims_visited = 0;
+    idx_t prims_pruned = 0;
+    idx_t string_bytes = 0;
+    idx_t stage_cache_hits = 0;
+    idx_t stage_cache_misses = 0;
+    // From the start of the scan to its last chunk
+    idx_t wall_nanos = 0;
+    // Summed over threads; only valid when timed
+    bool timed = false;
+    idx_t phase_nanos[USD_SCAN_PHASE_COUNT] = {};
+
+    // Extra info of the scan operator in EXPLAIN ANALYZE
+    InsertionOrderPreservingMap<string> ToProfilerInfo() const;
+};
+
+// Scans finished by the queries of one connection. Scans of the running query
+// are collected apart, so that usd_last_scan_stats() reports the last query
+// that ran usd_* scans rather than itself.
+class UsdScanHistory : public ClientContextState {
+public:
+    static constexpr const char *NAME = "usd_scan_history";
+    // Name and default of the setting timing the phases of unprofiled queries
+    static constexpr const char *TIMING_SETTING = "usd_scan_timing";
+
+    static shared_ptr<UsdScanHistory> Get(ClientContext &context);
+    // Whether scans started by the running query time their phases
+    static bool TimingEnabled(ClientContext &context);
+
+    void QueryBegin(ClientContext &context) override;
+    void Add(UsdScanStats stats);
+    vector<UsdScanStats> LastQuery();
+
+private:
+    std::mutex lock_;
+    vector<UsdScanStats> running_;
+    vector<UsdScanStats> last_;
+};
+
+// usd_last_scan_stats(): counters and phase times of the usd_* scans of the
+// connection's last query that ran any
+class UsdLastScanStatsFunction {
+public:
+    static TableFunction GetFunction();
+};
+
+} // namespace duckdb
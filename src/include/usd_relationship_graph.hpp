@@ -0,0 +1,21 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+// usd_referrers(file_path, target_path): the relationships targeting a path,
+// answered from the cached relationship graph of the stage
+class UsdReferrersFunction {
+public:
+    static TableFunction GetFunction();
+};
+
+// usd_relationship_closure(file_path, start_path, rel_name, max_depth): the
+// paths reachable from start_path by following relationships, breadth first
+class UsdRelationshipClosureFunction {
+public:
+    static TableFunction GetFunction();
+};
+
+} // namespace duckdb
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include <pxr/usd/ar/resolverContext.h>
+#include <pxr/usd/ar/resolverContextBinder.h>
+#include <string>
+
+namespace duckdb {
+
+// Serves USD layers with a URI scheme (s3://, https://, hf://, ...) through
+// DuckDB's FileSystem. An ArResolver registered for those schemes opens each
+// layer as an ArAsset whose reads are ranged requests, so that the crate
+// reader of .usdc files fetches only the sections it needs instead of the
+// whole file. Remote schemes need the extension that implements them (httpfs
+// for s3:// and http://) to be loaded; credentials come from DuckDB secrets.
+class UsdRemoteFileSystem {
+public:
+    // Size of the blocks remote layers are fetched and cached in
+    static constexpr idx_t BLOCK_SIZE = 1 << 20;
+    // Bound of the process-wide cache of remote blocks
+    static constexpr idx_t BLOCK_CACHE_LIMIT = idx_t(256) << 20;
+
+    // Registers the resolver with OpenUSD's plugin system; called once per
+    // process before the first stage is opened
+    static void Register();
+
+    // Whether path has a URI scheme served through DuckDB's FileSystem
+    static bool IsRemotePath(const std::string &path);
+
+    static bool FileExists(ClientContext &context, const std::string &path);
+    // Last modification time and size of a remote file, as cache stamps
+    static bool Stat(ClientContext &context, const std::string &path, int64_t &mtime, uint64_t &size);
+
+    // Resolver context of a stage that context opens from path. Remote layers
+    // of the stage are read through the FileSystem of context's database, with
+    // its settings and secrets, on whichever thread OpenUSD opens them: it
+    // binds the stage's resolver context on the worker threads composing prims
+    // and loading payloads as well. The database is not kept alive by it.
+    static pxr::ArResolverContext CreateResolverContext(ClientContext &context, const std::string &path);
+
+    // Binds the resolver context of context's database on the current thread
+    // while in scope, for layers opened or reloaded outside the composition
+    // of a stage
+    class ScopedContext {
+    public:
+        explicit ScopedContext(ClientContext &context);
+
+    private:
+        pxr::ArResolverContextBinder binder;
+    };
+};
+
+} // namespace duckdb
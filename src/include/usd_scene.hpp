@@ -0,0 +1,14 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+// usd_scene(files): prim metadata, world transforms and property and
+// relationship counts in a single traversal
+class UsdSceneFunction {
+public:
+    static TableFunction GetFunction();
+};
+
+} // namespace duckdb
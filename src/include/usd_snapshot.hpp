@@ -0,0 +1,29 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/function/pragma_function.hpp"
+
+namespace duckdb {
+
+// usd_stage_layers(file_path): the layers each file's stage is composed from,
+// with the modification time and size they had when it was composed
+class UsdStageLayersFunction {
+public:
+    static TableFunction GetFunction();
+};
+
+// PRAGMA usd_snapshot(file_path, schema = 'scene'): scans files once into
+// native tables of schema
+class UsdSnapshotFunction {
+public:
+    static PragmaFunctionSet GetFunctions();
+};
+
+// PRAGMA usd_refresh(schema): rescans the files of a snapshot whose layers
+// changed since they were scanned
+class UsdRefreshFunction {
+public:
+    static PragmaFunction GetFunction();
+};
+
+} // namespace duckdb
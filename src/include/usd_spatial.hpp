@@ -0,0 +1,22 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+namespace duckdb {
+
+class UsdWithinRadiusFunction {
+public:
+    static TableFunction GetFunction();
+};
+
+class UsdWithinBoxFunction {
+public:
+    static TableFunction GetFunction();
+};
+
+class UsdNearestFunction {
+public:
+    static TableFunction GetFunction();
+};
+
+} // namespace duckdb
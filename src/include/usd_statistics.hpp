@@ -0,0 +1,120 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/storage/statistics/node_statistics.hpp"
+#include "usd_profile.hpp"
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace duckdb {
+
+// Bind-time row estimate of a scan, used for join ordering and progress
+struct UsdScanEstimate {
+    std::string function_name;
+    // Version key (path, mtime and size) of each file; empty when the file
+    // was not stat'ed
+    vector<std::string> file_keys;
+    // Whether complete scans of this call describe the whole file, i.e. no
+    // named parameter changes its rows
+    bool rememberable = false;
+    idx_t rows = 0;
+    // Set when rows was remembered from complete scans of every file
+    bool exact = false;
+    // Largest remembered distinct count per table column (0 = unknown)
+    vector<idx_t> distinct;
+};
+
+// Progress and outcome of a running scan, shared by its threads. Threads add
+// their profiles after every chunk; the totals are reported to the query
+// profiler and, once the scan is destroyed, to usd_last_scan_stats().
+class UsdScanTracker {
+public:
+    UsdScanTracker() = default;
+    ~UsdScanTracker();
+
+    // remember: whether completed files describe the whole file (no filters
+    // were pushed down) and may be remembered for later estimates
+    void Start(ClientContext &context, const UsdScanEstimate &estimate, bool remember);
+    // Profiles a function without a row estimate (such as a spatial query)
+    void StartProfile(ClientContext &context, const std::string &function_name);
+    void AddRows(idx_t count) {
+        rows_ += count;
+    }
+    // Records that file was scanned to its end, producing rows
+    void FileCompleted(idx_t file, idx_t rows, const vector<idx_t> &distinct = vector<idx_t>()) const;
+    // Percentage of the estimated rows produced so far
+    double Progress() const;
+
+    // Whether threads should time the phases of their profiles
+    bool Timing() const {
+        return timing_;
+    }
+    // Adds the counters of a thread's profile to the totals and resets them
+    void Flush(UsdScanProfile &profile);
+    UsdScanStats Snapshot() const;
+
+private:
+    const UsdScanEstimate *estimate_ = nullptr;
+    bool remember_ = false;
+    std::atomic<idx_t> rows_ {0};
+
+    std::string function_name_;
+    shared_ptr<UsdScanHistory> history_;
+    bool timing_ = false;
+    std::chrono::steady_clock::time_point start_;
+    std::atomic<int64_t> last_flush_nanos_ {0};
+    std::atomic<idx_t> phase_nanos_[USD_SCAN_PHASE_COUNT] = {};
+    std::atomic<idx_t> prims_visited_ {0};
+    std::atomic<idx_t> prims_pruned_ {0};
+    std::atomic<idx_t> string_bytes_ {0};
+    std::atomic<idx_t> stage_cache_hits_ {0};
+    std::atomic<idx_t> stage_cache_misses_ {0};
+};
+
+// Row counts of complete scans, remembered per function and file version, so
+// that a later scan of an unchanged file is planned with its exact size.
+// Files never scanned are estimated from their root layer: the spec count of
+// crate files (read from the file header) or the size of text layers.
+class UsdScanStatistics {
+public:
+    // Estimates the rows function_name produces over files; rows_per_spec
+    // converts root layer specs into rows of this function
+    static UsdScanEstimate Estimate(ClientContext &context, const std::string &function_name,
+                                    const vector<std::string> &files, double rows_per_spec, bool rememberable,
+                                    idx_t column_count);
+    static void Remember(const std::string &function_name, const std::string &file_key, idx_t rows,
+                         const vector<idx_t> &distinct);
+    // Forgets every remembered scan (usd_cache_clear)
+    static void Clear();
+
+    static unique_ptr<NodeStatistics> Cardinality(const UsdScanEstimate &estimate);
+
+    // Sets the cardinality, progress and profiler callbacks of a scan whose
+    // bind data has an estimate member and whose global state has a tracker
+    // member
+    template <class BIND_DATA, class GLOBAL_STATE>
+    static void Register(TableFunction &func) {
+        RegisterProfile<GLOBAL_STATE>(func);
+        func.cardinality = [](ClientContext &context, const FunctionData *bind_data) {
+            return Cardinality(bind_data->Cast<BIND_DATA>().estimate);
+        };
+        func.table_scan_progress = [](ClientContext &context, const FunctionData *bind_data,
+                                      const GlobalTableFunctionState *global_state) {
+            return global_state->Cast<GLOBAL_STATE>().tracker.Progress();
+        };
+    }
+    // Shows the totals of the tracker member of the global state in the
+    // EXPLAIN ANALYZE output of the scan operator
+    template <class GLOBAL_STATE>
+    static void RegisterProfile(TableFunction &func) {
+        func.dynamic_to_string = [](TableFunctionDynamicToStringInput &input) {
+            if (!input.global_state) {
+                return InsertionOrderPreservingMap<string>();
+            }
+            return input.global_state->Cast<GLOBAL_STATE>().tracker.Snapshot().ToProfilerInfo();
+        };
+    }
+};
+
+} // namespace duckdb
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include <pxr/base/vt/value.h>
+#include <pxr/usd/sdf/valueTypeName.h>
+
+namespace duckdb {
+
+// Typed columns an attribute value can be written to, as bits of a mask
+enum UsdValueColumn : uint8_t {
+    USD_VALUE_DOUBLE = 1 << 0,
+    USD_VALUE_INT = 1 << 1,
+    USD_VALUE_BOOL = 1 << 2,
+    USD_VALUE_TOKEN = 1 << 3,
+    USD_VALUE_VEC3 = 1 << 4,
+    USD_VALUE_ARRAY = 1 << 5
+};
+
+// Output vectors of the typed value columns (nullptr if not projected)
+struct UsdValueVectors {
+    Vector *value_double = nullptr;
+    Vector *value_int = nullptr;
+    Vector *value_bool = nullptr;
+    Vector *value_token = nullptr;
+    Vector *value_vec3 = nullptr;
+    Vector *value_array = nullptr;
+
+    bool Any() const {
+        return value_double || value_int || value_bool || value_token || value_vec3 || value_array;
+    }
+    // Sets row to NULL in every projected column whose bit is not in written
+    void SetNullExcept(idx_t row, uint8_t written) const;
+};
+
+// Writes a value into the typed columns it maps to; returns the columns written
+typedef uint8_t (*usd_value_writer_t)(const pxr::VtValue &value, const UsdValueVectors &out, idx_t row);
+
+// Type-dispatch table from SdfValueTypeName to a typed-column writer, so that
+// values reach DuckDB vectors without being formatted as text
+class UsdValueDispatch {
+public:
+    // Writer for values of type_name, or nullptr if no typed column applies
+    static usd_value_writer_t GetWriter(const pxr::SdfValueTypeName &type_name);
+
+    // Appends value_double .. value_array to a scan's schema
+    static void AddColumns(vector<string> &names, vector<LogicalType> &return_types);
+    static constexpr idx_t COLUMN_COUNT = 6;
+
+    // Text form of value as printed by USD (empty for an empty value)
+    static std::string FormatValue(const pxr::VtValue &value);
+};
+
+// Bulk copy of array attribute values (VtArray<T>) into DuckDB vectors. Each
+// element becomes one value of element_type: a number for scalar arrays and
+// a fixed-size ARRAY for vector arrays, copied with memcpy where the layouts
+// match.
+struct UsdArrayCopier {
+    // Value type the copier accepts (roles such as point3f and float3 share it)
+    pxr::TfType value_type;
+    LogicalType element_type;
+    // Number of elements of value, which must hold value_type
+    idx_t (*size)(const pxr::VtValue &value);
+    // Copies elements [offset, offset + count) of value into target, a flat
+    // vector of element_type, starting at row target_offset
+    void (*copy)(const pxr::VtValue &value, idx_t offset, idx_t count, Vector &target, idx_t target_offset);
+
+    // Copier for array values of type_name, or nullptr if it is not supported
+    static const UsdArrayCopier *Get(const pxr::SdfValueTypeName &type_name);
+};
+
+} // namespace duckdb
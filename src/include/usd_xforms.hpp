@@ -2,6 +2,10 @@
 
 #include "duckdb.hpp"
 
+#include <pxr/base/gf/matrix3d.h>
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/vec3d.h>
+
 namespace duckdb {
 
 class UsdXformsFunction {
@@ -9,5 +13,20 @@ public:
     static TableFunction GetFunction();
 };
 
-} // namespace duckdb
+// Rotation and per-axis scale of the upper 3x3 of a transform, read from
+// the lengths of its rows (USD transforms row vectors). Shear is not
+// represented; a mirroring transform gets a negative scale.
+struct UsdXformBasis {
+    pxr::GfVec3d scale;
+    pxr::GfMatrix3d rotation;
 
+    explicit UsdXformBasis(const pxr::GfMatrix4d &matrix);
+
+    bool HasScale() const;
+    bool HasRotation() const;
+};
+
+// Copies a row-major 4x4 matrix into row of a DOUBLE[16] vector
+void UsdWriteMatrix(Vector &vector, idx_t row, const pxr::GfMatrix4d &matrix);
+
+} // namespace duckdb
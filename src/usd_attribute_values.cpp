@@ -0,0 +1,311 @@
+#include "usd_attribute_values.hpp"
+#include "usd_helpers.hpp"
+#include "usd_values.hpp"
+#include "duckdb/common/exception.hpp"
+
+#include <pxr/usd/usd/attribute.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/sdf/schema.h>
+
+namespace duckdb {
+
+// Table columns, in schema order. With unnest := true the last two columns
+// are element_index and value instead of element_count and values.
+static constexpr idx_t COL_PRIM_PATH = 0;
+static constexpr idx_t COL_ELEMENT_COUNT = 1;
+static constexpr idx_t COL_VALUES = 2;
+static constexpr idx_t COL_ELEMENT_INDEX = 1;
+static constexpr idx_t COL_VALUE = 2;
+static constexpr idx_t COLUMN_COUNT = 3;
+// Rows per root layer spec, for estimates before the first complete scan
+static constexpr double ROWS_PER_SPEC = 0.75;
+
+// Bind data structure
+struct UsdAttributeValuesBindData : public TableFunctionData {
+    // Files to scan (a path, the matches of a glob, or a list)
+    vector<std::string> files;
+    // Population mask and payload loading requested with mask := / load :=
+    UsdStageLoadOptions load_options;
+    // Path predicates pushed down from the query
+    UsdScanFilter filter;
+    // Row estimate for the planner and the progress bar
+    UsdScanEstimate estimate;
+    pxr::TfToken attr_name;
+    pxr::SdfValueTypeName attr_type;
+    const UsdArrayCopier *copier = nullptr;
+    // One row per array element instead of one LIST per prim
+    bool unnest = false;
+
+    explicit UsdAttributeValuesBindData(vector<std::string> files_p) : files(std::move(files_p)) {}
+};
+
+// Per-thread cursor into the file currently being scanned
+struct UsdAttributeValuesLocalState : public UsdMultiFileLocalState {
+    std::unique_ptr<UsdPrimIterator> prim_iterator;
+
+    // Array value of the current prim and, when unnesting, the next element
+    pxr::UsdPrim current_prim;
+    pxr::VtValue current_value;
+    idx_t current_size = 0;
+    idx_t element_offset = 0;
+    bool has_current = false;
+
+    // Claims the next file and moves to its first value
+    bool NextFile(ClientContext &context, UsdMultiFileGlobalState &gstate,
+                  const UsdAttributeValuesBindData &bind_data) {
+        has_current = false;
+        current_value = pxr::VtValue();
+        prim_iterator.reset();
+        if (!OpenNextFile(context, gstate, bind_data.files, bind_data.load_options.WithFilter(bind_data.filter))) {
+            return false;
+        }
+        // Create prim iterator over the prims that can satisfy the filters
+        prim_iterator = std::make_unique<UsdPrimIterator>(stage, bind_data.filter, &profile);
+        NextValue(bind_data);
+        return true;
+    }
+
+    // Moves to the next prim of the file with a value of the requested attribute
+    bool NextValue(const UsdAttributeValuesBindData &bind_data) {
+        has_current = false;
+        while (prim_iterator->HasNext()) {
+            profile.Enter(UsdScanPhase::TRAVERSE);
+            auto prim = prim_iterator->GetNext();
+            profile.Enter(UsdScanPhase::EXTRACT);
+            auto attr = prim.GetAttribute(bind_data.attr_name);
+            if (!attr || attr.GetTypeName().GetType() != bind_data.copier->value_type) {
+                continue;
+            }
+            if (!attr.Get(&current_value)) {
+                continue;
+            }
+            current_prim = prim;
+            current_size = bind_data.copier->size(current_value);
+            element_offset = 0;
+            has_current = true;
+            return true;
+        }
+        return false;
+    }
+};
+
+// Type of the first attribute named attr_name on the stage
+static pxr::SdfValueTypeName FindAttributeType(const pxr::UsdStageRefPtr &stage, const pxr::TfToken &attr_name) {
+    for (const auto &prim : stage->Traverse()) {
+        auto attr = prim.GetAttribute(attr_name);
+        if (attr) {
+            return attr.GetTypeName();
+        }
+    }
+    return pxr::SdfValueTypeName();
+}
+
+// Bind function
+static unique_ptr<FunctionData> UsdAttributeValuesBind(ClientContext &context, TableFunctionBindInput &input,
+                                                       vector<LogicalType> &return_types, vector<string> &names) {
+    // Validate input
+    if (input.inputs.size() != 1) {
+        throw BinderException("usd_attribute_values requires exactly one argument: file_path");
+    }
+
+    // One path, a glob pattern or a list of either
+    auto files = UsdFileList::Bind(context, "usd_attribute_values", input.inputs[0]);
+
+    auto result = make_uniq<UsdAttributeValuesBindData>(std::move(files));
+    result->estimate = UsdScanStatistics::Estimate(context, "usd_attribute_values", result->files, ROWS_PER_SPEC,
+                                                   input.named_parameters.empty(), COLUMN_COUNT);
+    result->load_options.Bind("usd_attribute_values", input.named_parameters);
+    result->filter.BindTraversal("usd_attribute_values", input.named_parameters);
+    std::string attr_type;
+    for (auto &kv : input.named_parameters) {
+        if (kv.first == "attr_name") {
+            result->attr_name = pxr::TfToken(kv.second.ToString());
+        } else if (kv.first == "attr_type") {
+            attr_type = kv.second.ToString();
+        } else if (kv.first == "unnest") {
+            result->unnest = BooleanValue::Get(kv.second);
+        }
+    }
+    if (result->attr_name.IsEmpty()) {
+        throw BinderException("usd_attribute_values: attr_name is required, e.g. attr_name := 'points'");
+    }
+
+    // The output type depends on the attribute type: take it from attr_type,
+    // or from the first prim (of the first file) that has the attribute
+    if (!attr_type.empty()) {
+        result->attr_type = pxr::SdfSchema::GetInstance().FindType(attr_type);
+        if (result->attr_type == pxr::SdfValueTypeName()) {
+            throw BinderException("usd_attribute_values: unknown attr_type '" + attr_type + "'");
+        }
+    } else {
+        for (auto &file : result->files) {
+            auto stage = UsdStageManager::OpenStage(context, file, result->load_options);
+            result->attr_type = FindAttributeType(stage, result->attr_name);
+            if (result->attr_type != pxr::SdfValueTypeName()) {
+                break;
+            }
+        }
+        if (result->attr_type == pxr::SdfValueTypeName()) {
+            throw BinderException("usd_attribute_values: no prim has an attribute named '" +
+                                  result->attr_name.GetString() + "'");
+        }
+    }
+    result->copier = UsdArrayCopier::Get(result->attr_type);
+    if (!result->copier) {
+        throw BinderException("usd_attribute_values: attribute '" + result->attr_name.GetString() + "' has type '" +
+                              result->attr_type.GetAsToken().GetString() +
+                              "', which is not a supported numeric array type");
+    }
+
+    // Define output schema
+    names.emplace_back("prim_path");
+    return_types.emplace_back(LogicalTypeId::VARCHAR);
+    if (result->unnest) {
+        names.emplace_back("element_index");
+        return_types.emplace_back(LogicalTypeId::BIGINT);
+        names.emplace_back("value");
+        return_types.emplace_back(result->copier->element_type);
+    } else {
+        names.emplace_back("element_count");
+        return_types.emplace_back(LogicalTypeId::BIGINT);
+        names.emplace_back("values");
+        return_types.emplace_back(LogicalType::LIST(result->copier->element_type));
+    }
+
+    return std::move(result);
+}
+
+// Init function
+static unique_ptr<GlobalTableFunctionState> UsdAttributeValuesInit(ClientContext &context,
+                                                                   TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<UsdAttributeValuesBindData>();
+    auto state = make_uniq<UsdMultiFileGlobalState>(bind_data.files.size());
+    state->projection = UsdColumnProjection(input.column_ids, COLUMN_COUNT);
+    state->tracker.Start(context, bind_data.estimate, bind_data.filter.IsEmpty());
+    return std::move(state);
+}
+
+// Each thread opens (through the stage cache) the stages of the files it claims
+static unique_ptr<LocalTableFunctionState> UsdAttributeValuesInitLocal(ExecutionContext &context,
+                                                                       TableFunctionInitInput &input,
+                                                                       GlobalTableFunctionState *global_state) {
+    return make_uniq<UsdAttributeValuesLocalState>();
+}
+
+// One row per prim: the whole array is copied into the LIST child vector
+static void ExecuteLists(const UsdAttributeValuesBindData &bind_data, const UsdColumnProjection &projection,
+                         UsdAttributeValuesLocalState &state, DataChunk &output) {
+    auto prim_path_out = projection.GetVector(output, COL_PRIM_PATH);
+    auto prim_path_data = projection.GetData<string_t>(output, COL_PRIM_PATH);
+    auto element_count_data = projection.GetData<int64_t>(output, COL_ELEMENT_COUNT);
+    auto values_out = projection.GetVector(output, COL_VALUES);
+
+    idx_t count = 0;
+    while (count < STANDARD_VECTOR_SIZE && state.has_current) {
+        state.profile.Enter(UsdScanPhase::EMIT);
+        if (prim_path_data) {
+            prim_path_data[count] = StringVector::AddString(*prim_path_out, state.current_prim.GetPath().GetString());
+        }
+        if (element_count_data) {
+            element_count_data[count] = NumericCast<int64_t>(state.current_size);
+        }
+        if (values_out) {
+            auto offset = ListVector::GetListSize(*values_out);
+            ListVector::Reserve(*values_out, offset + state.current_size);
+            bind_data.copier->copy(state.current_value, 0, state.current_size, ListVector::GetEntry(*values_out),
+                                   offset);
+            FlatVector::GetData<list_entry_t>(*values_out)[count] = list_entry_t(offset, state.current_size);
+            ListVector::SetListSize(*values_out, offset + state.current_size);
+        }
+        count++;
+        state.NextValue(bind_data);
+    }
+
+    output.SetCardinality(count);
+}
+
+// One row per element: runs of elements are copied straight into the value vector
+static void ExecuteUnnested(const UsdAttributeValuesBindData &bind_data, const UsdColumnProjection &projection,
+                            UsdAttributeValuesLocalState &state, DataChunk &output) {
+    auto prim_path_out = projection.GetVector(output, COL_PRIM_PATH);
+    auto prim_path_data = projection.GetData<string_t>(output, COL_PRIM_PATH);
+    auto element_index_data = projection.GetData<int64_t>(output, COL_ELEMENT_INDEX);
+    auto value_out = projection.GetVector(output, COL_VALUE);
+
+    idx_t count = 0;
+    while (count < STANDARD_VECTOR_SIZE && state.has_current) {
+        state.profile.Enter(UsdScanPhase::EMIT);
+        auto run = MinValue<idx_t>(state.current_size - state.element_offset, STANDARD_VECTOR_SIZE - count);
+        if (prim_path_data && run > 0) {
+            // Every row of the run shares one copy of the path
+            auto path = StringVector::AddString(*prim_path_out, state.current_prim.GetPath().GetString());
+            for (idx_t i = 0; i < run; i++) {
+                prim_path_data[count + i] = path;
+            }
+        }
+        if (element_index_data) {
+            for (idx_t i = 0; i < run; i++) {
+                element_index_data[count + i] = NumericCast<int64_t>(state.element_offset + i);
+            }
+        }
+        if (value_out) {
+            bind_data.copier->copy(state.current_value, state.element_offset, run, *value_out, count);
+        }
+        count += run;
+        state.element_offset += run;
+        if (state.element_offset >= state.current_size) {
+            state.NextValue(bind_data);
+        }
+    }
+
+    output.SetCardinality(count);
+}
+
+// Execute function
+static void UsdAttributeValuesExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &bind_data = data_p.bind_data->Cast<UsdAttributeValuesBindData>();
+    auto &gstate = data_p.global_state->Cast<UsdMultiFileGlobalState>();
+    auto &state = data_p.local_state->Cast<UsdAttributeValuesLocalState>();
+
+    // Both modes stop at the end of the current file: a chunk never spans two.
+    // Files without values (or only empty arrays) yield no rows and are skipped.
+    do {
+        if (!state.has_current && !state.NextFile(context, gstate, bind_data)) {
+            output.SetCardinality(0);
+            return;
+        }
+        if (bind_data.unnest) {
+            ExecuteUnnested(bind_data, gstate.projection, state, output);
+        } else {
+            ExecuteLists(bind_data, gstate.projection, state, output);
+        }
+    } while (output.size() == 0);
+    state.FinalizeChunk(gstate, output, bind_data.files);
+}
+
+static void UsdAttributeValuesPushdownFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                             vector<unique_ptr<Expression>> &filters) {
+    auto &bind_data = bind_data_p->Cast<UsdAttributeValuesBindData>();
+    UsdFilterColumns columns;
+    columns.prim_path = COL_PRIM_PATH;
+    bind_data.filter.Pushdown(get, filters, columns);
+}
+
+// Get the table function
+TableFunction UsdAttributeValuesFunction::GetFunction() {
+    TableFunction func("usd_attribute_values", {LogicalTypeId::VARCHAR}, UsdAttributeValuesExecute,
+                       UsdAttributeValuesBind, UsdAttributeValuesInit, UsdAttributeValuesInitLocal);
+    func.get_partition_data = UsdMultiFileLocalState::GetPartitionData;
+    func.projection_pushdown = true;
+    UsdScanStatistics::Register<UsdAttributeValuesBindData, UsdMultiFileGlobalState>(func);
+    UsdFileList::RegisterFilenameColumn(func);
+    UsdStageLoadOptions::RegisterParameters(func);
+    UsdScanFilter::RegisterParameters(func);
+    func.pushdown_complex_filter = UsdAttributeValuesPushdownFilter;
+    func.named_parameters["attr_name"] = LogicalType::VARCHAR;
+    func.named_parameters["attr_type"] = LogicalType::VARCHAR;
+    func.named_parameters["unnest"] = LogicalType::BOOLEAN;
+    return func;
+}
+
+} // namespace duckdb
@@ -0,0 +1,232 @@
+#include "usd_bounds.hpp"
+#include "usd_helpers.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usdGeom/bboxCache.h>
+#include <pxr/usd/usdGeom/boundable.h>
+#include <pxr/usd/usdGeom/imageable.h>
+#include <pxr/usd/usdGeom/tokens.h>
+#include <pxr/base/gf/range3d.h>
+
+namespace duckdb {
+
+// Table columns, in schema order
+static constexpr idx_t COL_PRIM_PATH = 0;
+static constexpr idx_t COL_MIN_X = 1;
+static constexpr idx_t COL_MIN_Y = 2;
+static constexpr idx_t COL_MIN_Z = 3;
+static constexpr idx_t COL_MAX_X = 4;
+static constexpr idx_t COL_MAX_Y = 5;
+static constexpr idx_t COL_MAX_Z = 6;
+static constexpr idx_t COLUMN_COUNT = 7;
+// Rows per root layer spec, for estimates before the first complete scan
+static constexpr double ROWS_PER_SPEC = 0.25;
+
+// Bind data structure
+struct UsdBoundsBindData : public TableFunctionData {
+    // Files to scan (a path, the matches of a glob, or a list)
+    vector<std::string> files;
+    // Population mask and payload loading requested with mask := / load :=
+    UsdStageLoadOptions load_options;
+    // Path predicates pushed down from the query
+    UsdScanFilter filter;
+    // Row estimate for the planner and the progress bar
+    UsdScanEstimate estimate;
+    // Purposes whose geometry contributes to bounds (always includes default)
+    pxr::TfTokenVector purposes {pxr::UsdGeomTokens->default_};
+    // Use authored extentsHint of models instead of visiting their geometry
+    bool approximate = false;
+    // Also report the aggregate bounds of non-boundable prims (Xforms, models)
+    bool all_prims = false;
+    pxr::UsdTimeCode time = pxr::UsdTimeCode::Default();
+
+    explicit UsdBoundsBindData(vector<std::string> files_p) : files(std::move(files_p)) {}
+};
+
+// Per-thread cursor into the file currently being scanned
+struct UsdBoundsLocalState : public UsdMultiFileLocalState {
+    std::unique_ptr<UsdPrimIterator> prim_iterator;
+    std::unique_ptr<pxr::UsdGeomBBoxCache> bbox_cache;
+
+    // Claims the next file, starts iterating its prims and resolves its bounds
+    bool NextFile(ClientContext &context, UsdMultiFileGlobalState &gstate, const UsdBoundsBindData &bind_data) {
+        prim_iterator.reset();
+        if (!OpenNextFile(context, gstate, bind_data.files, bind_data.load_options.WithFilter(bind_data.filter))) {
+            return false;
+        }
+
+        // Create prim iterator over the prims that can satisfy the filters
+        prim_iterator = std::make_unique<UsdPrimIterator>(stage, bind_data.filter, &profile);
+
+        // One cache serves every prim of the file. Resolving the bound of the
+        // traversal root first lets the cache compute the whole subtree with
+        // its own parallel traversal; rows are then cache lookups and a
+        // transform.
+        profile.Enter(UsdScanPhase::EXTRACT);
+        bbox_cache = std::make_unique<pxr::UsdGeomBBoxCache>(bind_data.time, bind_data.purposes, bind_data.approximate);
+        auto root = stage->GetPrimAtPath(bind_data.filter.TraversalRoot());
+        if (root && root.IsPseudoRoot()) {
+            for (const auto &child : root.GetChildren()) {
+                bbox_cache->ComputeUntransformedBound(child);
+            }
+        } else if (root) {
+            bbox_cache->ComputeUntransformedBound(root);
+        }
+        return true;
+    }
+};
+
+// Bind function
+static unique_ptr<FunctionData> UsdBoundsBind(ClientContext &context, TableFunctionBindInput &input,
+                                              vector<LogicalType> &return_types, vector<string> &names) {
+    // Validate input
+    if (input.inputs.size() != 1) {
+        throw BinderException("usd_bounds requires exactly one argument: file_path");
+    }
+
+    // One path, a glob pattern or a list of either
+    auto files = UsdFileList::Bind(context, "usd_bounds", input.inputs[0]);
+
+    auto result = make_uniq<UsdBoundsBindData>(std::move(files));
+    result->estimate = UsdScanStatistics::Estimate(context, "usd_bounds", result->files, ROWS_PER_SPEC,
+                                                   input.named_parameters.empty(), COLUMN_COUNT);
+    result->load_options.Bind("usd_bounds", input.named_parameters);
+    result->filter.BindTraversal("usd_bounds", input.named_parameters);
+    for (auto &kv : input.named_parameters) {
+        if (kv.second.IsNull()) {
+            continue;
+        }
+        if (kv.first == "purpose") {
+            auto purpose = StringUtil::Lower(kv.second.ToString());
+            if (purpose == "render") {
+                result->purposes.push_back(pxr::UsdGeomTokens->render);
+            } else if (purpose == "proxy") {
+                result->purposes.push_back(pxr::UsdGeomTokens->proxy);
+            } else if (purpose == "guide") {
+                result->purposes.push_back(pxr::UsdGeomTokens->guide);
+            } else if (purpose != "default") {
+                throw BinderException("usd_bounds: purpose must be 'default', 'render', 'proxy' or 'guide', got '" +
+                                      kv.second.ToString() + "'");
+            }
+        } else if (kv.first == "approximate") {
+            result->approximate = BooleanValue::Get(kv.second);
+        } else if (kv.first == "all_prims") {
+            result->all_prims = BooleanValue::Get(kv.second);
+        } else if (kv.first == "time") {
+            result->time = pxr::UsdTimeCode(kv.second.GetValue<double>());
+        }
+    }
+
+    // Define output schema
+    names = {"prim_path", "min_x", "min_y", "min_z", "max_x", "max_y", "max_z"};
+    return_types = {LogicalTypeId::VARCHAR, LogicalTypeId::DOUBLE, LogicalTypeId::DOUBLE, LogicalTypeId::DOUBLE,
+                    LogicalTypeId::DOUBLE,  LogicalTypeId::DOUBLE, LogicalTypeId::DOUBLE};
+
+    return std::move(result);
+}
+
+// Init function
+static unique_ptr<GlobalTableFunctionState> UsdBoundsInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<UsdBoundsBindData>();
+    auto state = make_uniq<UsdMultiFileGlobalState>(bind_data.files.size());
+    state->projection = UsdColumnProjection(input.column_ids, COLUMN_COUNT);
+    state->tracker.Start(context, bind_data.estimate, bind_data.filter.IsEmpty());
+    return std::move(state);
+}
+
+// Each thread opens (through the stage cache) the stages of the files it claims
+static unique_ptr<LocalTableFunctionState> UsdBoundsInitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+                                                              GlobalTableFunctionState *global_state) {
+    return make_uniq<UsdBoundsLocalState>();
+}
+
+// Execute function
+static void UsdBoundsExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &bind_data = data_p.bind_data->Cast<UsdBoundsBindData>();
+    auto &gstate = data_p.global_state->Cast<UsdMultiFileGlobalState>();
+    auto &state = data_p.local_state->Cast<UsdBoundsLocalState>();
+    auto &projection = gstate.projection;
+
+    // Only projected columns are computed; unprojected ones get nullptr
+    auto prim_path_out = projection.GetVector(output, COL_PRIM_PATH);
+    auto prim_path_data = projection.GetData<string_t>(output, COL_PRIM_PATH);
+    double *bound_data[6];
+    for (idx_t i = 0; i < 6; i++) {
+        bound_data[i] = projection.GetData<double>(output, COL_MIN_X + i);
+    }
+
+    idx_t count = 0;
+    while (count < STANDARD_VECTOR_SIZE) {
+        // A chunk never spans two files
+        if (!state.prim_iterator || !state.prim_iterator->HasNext()) {
+            if (count > 0 || !state.NextFile(context, gstate, bind_data)) {
+                break;
+            }
+            continue;
+        }
+        state.profile.Enter(UsdScanPhase::TRAVERSE);
+        auto prim = state.prim_iterator->GetNext();
+        bool reported = bind_data.all_prims ? prim.IsA<pxr::UsdGeomImageable>() : prim.IsA<pxr::UsdGeomBoundable>();
+        if (!reported) {
+            continue;
+        }
+
+        // Prims without geometry of the requested purposes have no bound
+        state.profile.Enter(UsdScanPhase::EXTRACT);
+        auto range = state.bbox_cache->ComputeWorldBound(prim).ComputeAlignedRange();
+        if (range.IsEmpty()) {
+            continue;
+        }
+
+        state.profile.Enter(UsdScanPhase::EMIT);
+        if (prim_path_data) {
+            prim_path_data[count] = StringVector::AddString(*prim_path_out, prim.GetPath().GetString());
+        }
+        const auto &min = range.GetMin();
+        const auto &max = range.GetMax();
+        for (idx_t i = 0; i < 3; i++) {
+            if (bound_data[i]) {
+                bound_data[i][count] = min[i];
+            }
+            if (bound_data[i + 3]) {
+                bound_data[i + 3][count] = max[i];
+            }
+        }
+        count++;
+    }
+
+    output.SetCardinality(count);
+    if (count > 0) {
+        state.FinalizeChunk(gstate, output, bind_data.files);
+    }
+}
+
+static void UsdBoundsPushdownFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                    vector<unique_ptr<Expression>> &filters) {
+    auto &bind_data = bind_data_p->Cast<UsdBoundsBindData>();
+    UsdFilterColumns columns;
+    columns.prim_path = COL_PRIM_PATH;
+    bind_data.filter.Pushdown(get, filters, columns);
+}
+
+// Get the table function
+TableFunction UsdBoundsFunction::GetFunction() {
+    TableFunction func("usd_bounds", {LogicalTypeId::VARCHAR}, UsdBoundsExecute, UsdBoundsBind, UsdBoundsInit,
+                       UsdBoundsInitLocal);
+    func.get_partition_data = UsdMultiFileLocalState::GetPartitionData;
+    func.projection_pushdown = true;
+    UsdScanStatistics::Register<UsdBoundsBindData, UsdMultiFileGlobalState>(func);
+    UsdFileList::RegisterFilenameColumn(func);
+    UsdStageLoadOptions::RegisterParameters(func);
+    UsdScanFilter::RegisterParameters(func);
+    func.pushdown_complex_filter = UsdBoundsPushdownFilter;
+    func.named_parameters["purpose"] = LogicalType::VARCHAR;
+    func.named_parameters["approximate"] = LogicalType::BOOLEAN;
+    func.named_parameters["all_prims"] = LogicalType::BOOLEAN;
+    func.named_parameters["time"] = LogicalType::DOUBLE;
+    return func;
+}
+
+} // namespace duckdb
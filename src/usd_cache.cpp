@@ -0,0 +1,76 @@
+#include "usd_cache.hpp"
+#include "usd_helpers.hpp"
+#include "duckdb/function/table_function.hpp"
+
+namespace duckdb {
+
+// Both functions return a single row; the state only tracks whether it was emitted
+struct UsdCacheGlobalState : public GlobalTableFunctionState {
+    bool finished = false;
+};
+
+static unique_ptr<GlobalTableFunctionState> UsdCacheInit(ClientContext &context, TableFunctionInitInput &input) {
+    return make_uniq<UsdCacheGlobalState>();
+}
+
+static unique_ptr<FunctionData> UsdCacheStatsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                  vector<LogicalType> &return_types, vector<string> &names) {
+    names = {"entries", "resident_bytes", "memory_limit", "hits", "misses", "evictions", "invalidations", "reloads"};
+    return_types = {LogicalTypeId::BIGINT, LogicalTypeId::BIGINT, LogicalTypeId::BIGINT, LogicalTypeId::BIGINT,
+                    LogicalTypeId::BIGINT, LogicalTypeId::BIGINT, LogicalTypeId::BIGINT, LogicalTypeId::BIGINT};
+    return make_uniq<TableFunctionData>();
+}
+
+static void UsdCacheStatsExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &state = data_p.global_state->Cast<UsdCacheGlobalState>();
+    if (state.finished) {
+        return;
+    }
+
+    auto stats = UsdStageManager::GetCacheStats();
+    output.SetValue(0, 0, Value::BIGINT(NumericCast<int64_t>(stats.entries)));
+    output.SetValue(1, 0, Value::BIGINT(NumericCast<int64_t>(stats.resident_bytes)));
+    output.SetValue(2, 0, Value::BIGINT(NumericCast<int64_t>(stats.memory_limit)));
+    output.SetValue(3, 0, Value::BIGINT(NumericCast<int64_t>(stats.hits)));
+    output.SetValue(4, 0, Value::BIGINT(NumericCast<int64_t>(stats.misses)));
+    output.SetValue(5, 0, Value::BIGINT(NumericCast<int64_t>(stats.evictions)));
+    output.SetValue(6, 0, Value::BIGINT(NumericCast<int64_t>(stats.invalidations)));
+    output.SetValue(7, 0, Value::BIGINT(NumericCast<int64_t>(stats.reloads)));
+    output.SetCardinality(1);
+
+    state.finished = true;
+}
+
+static unique_ptr<FunctionData> UsdCacheClearBind(ClientContext &context, TableFunctionBindInput &input,
+                                                  vector<LogicalType> &return_types, vector<string> &names) {
+    names = {"evicted_entries", "released_bytes"};
+    return_types = {LogicalTypeId::BIGINT, LogicalTypeId::BIGINT};
+    return make_uniq<TableFunctionData>();
+}
+
+static void UsdCacheClearExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &state = data_p.global_state->Cast<UsdCacheGlobalState>();
+    if (state.finished) {
+        return;
+    }
+
+    auto released = UsdStageManager::ClearCache();
+    UsdScanStatistics::Clear();
+    output.SetValue(0, 0, Value::BIGINT(NumericCast<int64_t>(released.first)));
+    output.SetValue(1, 0, Value::BIGINT(NumericCast<int64_t>(released.second)));
+    output.SetCardinality(1);
+
+    state.finished = true;
+}
+
+TableFunction UsdCacheStatsFunction::GetFunction() {
+    TableFunction func("usd_cache_stats", {}, UsdCacheStatsExecute, UsdCacheStatsBind, UsdCacheInit);
+    return func;
+}
+
+TableFunction UsdCacheClearFunction::GetFunction() {
+    TableFunction func("usd_cache_clear", {}, UsdCacheClearExecute, UsdCacheClearBind, UsdCacheInit);
+    return func;
+}
+
+} // namespace duckdb
@@ -0,0 +1,79 @@
+#include "usd_changes.hpp"
+#include "usd_helpers.hpp"
+#include "duckdb/common/exception.hpp"
+
+namespace duckdb {
+
+struct UsdChangesBindData : public TableFunctionData {
+    std::string file_path;
+    idx_t since = 0;
+};
+
+struct UsdChangesGlobalState : public GlobalTableFunctionState {
+    std::vector<UsdStageChange> changes;
+    idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> UsdChangesBind(ClientContext &context, TableFunctionBindInput &input,
+                                               vector<LogicalType> &return_types, vector<string> &names) {
+    auto result = make_uniq<UsdChangesBindData>();
+    if (input.inputs[0].IsNull()) {
+        throw BinderException("usd_changes: file_path cannot be NULL");
+    }
+    result->file_path = input.inputs[0].ToString();
+    UsdFileList::Validate(context, "usd_changes", result->file_path);
+    for (auto &kv : input.named_parameters) {
+        if (kv.first == "since") {
+            auto since = kv.second.IsNull() ? 0 : kv.second.GetValue<int64_t>();
+            if (since < 0) {
+                throw BinderException("usd_changes: since must not be negative");
+            }
+            result->since = NumericCast<idx_t>(since);
+        }
+    }
+
+    names = {"token", "path", "change"};
+    return_types = {LogicalType::BIGINT, LogicalType::VARCHAR, LogicalType::VARCHAR};
+    return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> UsdChangesInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<UsdChangesBindData>();
+    auto result = make_uniq<UsdChangesGlobalState>();
+
+    // Opening the stage reloads the layers that changed on disk, recording
+    // the paths they recompose
+    auto stage = UsdStageManager::OpenStage(context, bind_data.file_path);
+    std::vector<UsdStageChange> changes;
+    auto start = UsdStageManager::GetChanges(stage, bind_data.since, changes);
+    if (bind_data.since < start) {
+        // The stage was (re)composed after since, or its older changes were
+        // dropped: everything may have changed
+        auto latest = changes.empty() ? start : MaxValue(start, changes.back().token);
+        result->changes.push_back(UsdStageChange {latest, pxr::SdfPath::AbsoluteRootPath(), true});
+    } else {
+        result->changes = std::move(changes);
+    }
+    return std::move(result);
+}
+
+static void UsdChangesExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &state = data_p.global_state->Cast<UsdChangesGlobalState>();
+    idx_t count = 0;
+    while (state.offset < state.changes.size() && count < STANDARD_VECTOR_SIZE) {
+        const auto &change = state.changes[state.offset++];
+        output.SetValue(0, count, Value::BIGINT(NumericCast<int64_t>(change.token)));
+        output.SetValue(1, count, Value(change.path.GetString()));
+        output.SetValue(2, count, Value(change.resynced ? "resynced" : "changed"));
+        count++;
+    }
+    output.SetCardinality(count);
+}
+
+TableFunction UsdChangesFunction::GetFunction() {
+    TableFunction func("usd_changes", {LogicalType::VARCHAR}, UsdChangesExecute, UsdChangesBind, UsdChangesInit);
+    func.named_parameters["since"] = LogicalType::BIGINT;
+    return func;
+}
+
+} // namespace duckdb
@@ -0,0 +1,575 @@
+#include "usd_crate.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/file_system.hpp"
+
+#include <cstring>
+
+namespace duckdb {
+
+// Crate file layout (see OpenUSD's pxr/usd/sdf/crateFile.cpp): an 88 byte
+// bootstrap header pointing at a table of contents of named sections
+static constexpr const char *CRATE_MAGIC = "PXR-USDC";
+static constexpr idx_t BOOTSTRAP_SIZE = 88;
+static constexpr idx_t SECTION_NAME_SIZE = 16;
+static constexpr idx_t SECTION_ENTRY_SIZE = SECTION_NAME_SIZE + 2 * sizeof(int64_t);
+// Structural sections are compressed since 0.4.0
+static constexpr uint8_t MIN_MINOR_VERSION = 4;
+
+// Value rep layout: flags in the top bits, the value type in bits 48-55
+static constexpr uint64_t VALUE_REP_INLINED_BIT = 1ULL << 62;
+static constexpr uint64_t VALUE_REP_ARRAY_BIT = 1ULL << 63;
+static constexpr uint64_t VALUE_REP_PAYLOAD_MASK = (1ULL << 48) - 1;
+static constexpr uint8_t CRATE_TYPE_TOKEN = 11;
+static constexpr uint8_t CRATE_TYPE_SPECIFIER = 42;
+
+static constexpr uint32_t NO_PARENT = ~uint32_t(0);
+// Terminates each field set
+static constexpr uint32_t FIELD_SET_END = ~uint32_t(0);
+
+static void ThrowCorrupt(const std::string &path, const std::string &reason) {
+    throw IOException("Invalid USD crate file " + path + ": " + reason);
+}
+
+// Bounds-checked sequential reads from a section
+struct UsdCrateCursor {
+    const std::string &path;
+    const char *data;
+    idx_t size;
+    idx_t position = 0;
+
+    UsdCrateCursor(const std::string &path, const std::vector<char> &buffer)
+        : path(path), data(buffer.data()), size(buffer.size()) {
+    }
+
+    const char *Take(idx_t count) {
+        if (count > size - position) {
+            ThrowCorrupt(path, "section ends unexpectedly");
+        }
+        auto result = data + position;
+        position += count;
+        return result;
+    }
+
+    template <class T>
+    T Read() {
+        T result;
+        memcpy(&result, Take(sizeof(T)), sizeof(T));
+        return result;
+    }
+};
+
+// Decodes one LZ4 block; returns the number of bytes written to target
+static idx_t DecompressLz4Block(const std::string &path, const uint8_t *source, idx_t source_size, uint8_t *target,
+                                idx_t target_capacity) {
+    idx_t in = 0;
+    idx_t out = 0;
+    auto read_length = [&](idx_t length) {
+        if (length != 15) {
+            return length;
+        }
+        uint8_t next;
+        do {
+            if (in >= source_size) {
+                ThrowCorrupt(path, "truncated LZ4 block");
+            }
+            next = source[in++];
+            length += next;
+        } while (next == 255);
+        return length;
+    };
+
+    while (in < source_size) {
+        auto token = source[in++];
+        auto literal_length = read_length(token >> 4);
+        if (literal_length > source_size - in || literal_length > target_capacity - out) {
+            ThrowCorrupt(path, "LZ4 literals out of bounds");
+        }
+        memcpy(target + out, source + in, literal_length);
+        in += literal_length;
+        out += literal_length;
+        if (in == source_size) {
+            // The last sequence has literals only
+            break;
+        }
+
+        if (source_size - in < 2) {
+            ThrowCorrupt(path, "truncated LZ4 block");
+        }
+        idx_t offset = idx_t(source[in]) | (idx_t(source[in + 1]) << 8);
+        in += 2;
+        auto match_length = read_length(token & 15) + 4;
+        if (offset == 0 || offset > out || match_length > target_capacity - out) {
+            ThrowCorrupt(path, "LZ4 match out of bounds");
+        }
+        // Matches may overlap their own output
+        for (idx_t i = 0; i < match_length; i++, out++) {
+            target[out] = target[out - offset];
+        }
+    }
+    return out;
+}
+
+// Decodes a TfFastCompression buffer: a chunk count (0 = a single LZ4 block)
+// followed by size-prefixed LZ4 blocks
+static idx_t Decompress(const std::string &path, const char *source, idx_t source_size, char *target,
+                        idx_t target_capacity) {
+    if (source_size == 0) {
+        ThrowCorrupt(path, "empty compressed buffer");
+    }
+    auto bytes = reinterpret_cast<const uint8_t *>(source);
+    auto output = reinterpret_cast<uint8_t *>(target);
+    auto chunk_count = bytes[0];
+    if (chunk_count == 0) {
+        return DecompressLz4Block(path, bytes + 1, source_size - 1, output, target_capacity);
+    }
+    idx_t in = 1;
+    idx_t out = 0;
+    for (idx_t chunk = 0; chunk < chunk_count; chunk++) {
+        int32_t chunk_size;
+        if (source_size - in < sizeof(chunk_size)) {
+            ThrowCorrupt(path, "truncated compressed buffer");
+        }
+        memcpy(&chunk_size, bytes + in, sizeof(chunk_size));
+        in += sizeof(chunk_size);
+        if (chunk_size < 0 || idx_t(chunk_size) > source_size - in) {
+            ThrowCorrupt(path, "compressed chunk out of bounds");
+        }
+        out += DecompressLz4Block(path, bytes + in, chunk_size, output + out, target_capacity - out);
+        in += chunk_size;
+    }
+    return out;
+}
+
+// Reads a compressed integer array (Usd_IntegerCompression): a common delta,
+// 2-bit codes per integer and the deltas that differ from the common one, in
+// the smallest of three widths, all compressed with TfFastCompression
+template <class INT, class SMALL, class MEDIUM, class LARGE>
+static void ReadCompressedInts(UsdCrateCursor &cursor, std::vector<INT> &result, idx_t count) {
+    auto compressed_size = cursor.Read<uint64_t>();
+    auto compressed = cursor.Take(compressed_size);
+    // Bounds the allocation for corrupt counts: LZ4 expands at most ~255x
+    // and each code byte holds four integers
+    if (count > compressed_size * 1024 + 64) {
+        ThrowCorrupt(cursor.path, "implausible integer count");
+    }
+    result.resize(count);
+    if (count == 0) {
+        return;
+    }
+
+    idx_t code_bytes = (count * 2 + 7) / 8;
+    std::vector<char> decoded(sizeof(LARGE) + code_bytes + count * sizeof(LARGE));
+    auto decoded_size = Decompress(cursor.path, compressed, compressed_size, decoded.data(), decoded.size());
+    if (decoded_size < sizeof(LARGE) + code_bytes) {
+        ThrowCorrupt(cursor.path, "truncated integer array");
+    }
+
+    LARGE common;
+    memcpy(&common, decoded.data(), sizeof(LARGE));
+    auto codes = reinterpret_cast<const uint8_t *>(decoded.data() + sizeof(LARGE));
+    idx_t values = sizeof(LARGE) + code_bytes;
+    auto read_delta = [&](idx_t width, LARGE &delta) {
+        if (decoded_size - values < width) {
+            ThrowCorrupt(cursor.path, "truncated integer array");
+        }
+        if (width == sizeof(SMALL)) {
+            SMALL value;
+            memcpy(&value, decoded.data() + values, width);
+            delta = value;
+        } else if (width == sizeof(MEDIUM)) {
+            MEDIUM value;
+            memcpy(&value, decoded.data() + values, width);
+            delta = value;
+        } else {
+            memcpy(&delta, decoded.data() + values, width);
+        }
+        values += width;
+    };
+
+    LARGE previous = 0;
+    for (idx_t i = 0; i < count; i++) {
+        auto code = (codes[i / 4] >> (2 * (i % 4))) & 3;
+        LARGE delta = common;
+        if (code == 1) {
+            read_delta(sizeof(SMALL), delta);
+        } else if (code == 2) {
+            read_delta(sizeof(MEDIUM), delta);
+        } else if (code == 3) {
+            read_delta(sizeof(LARGE), delta);
+        }
+        // Deltas wrap around like the unsigned arithmetic of the writer
+        previous = LARGE(uint64_t(previous) + uint64_t(delta));
+        result[i] = INT(previous);
+    }
+}
+
+template <class INT>
+static void ReadCompressedInts32(UsdCrateCursor &cursor, std::vector<INT> &result, idx_t count) {
+    ReadCompressedInts<INT, int8_t, int16_t, int32_t>(cursor, result, count);
+}
+
+// Reads a section of the file into memory
+static std::vector<char> ReadSection(FileHandle &handle, const std::string &path, idx_t file_size, int64_t start,
+                                     int64_t size) {
+    if (start < 0 || size < 0 || idx_t(start) > file_size || idx_t(size) > file_size - idx_t(start)) {
+        ThrowCorrupt(path, "section out of bounds");
+    }
+    std::vector<char> buffer(size);
+    if (size > 0) {
+        handle.Read(buffer.data(), size, start);
+    }
+    return buffer;
+}
+
+struct UsdCrateSection {
+    int64_t start = -1;
+    int64_t size = 0;
+
+    bool Exists() const {
+        return start >= 0;
+    }
+};
+
+// The sections listed in a crate file's table of contents
+struct UsdCrateToc {
+    UsdCrateSection tokens;
+    UsdCrateSection fields;
+    UsdCrateSection field_sets;
+    UsdCrateSection paths;
+    UsdCrateSection specs;
+};
+
+// Reads the bootstrap header and the table of contents. Returns false if the
+// file is not a crate file of a supported version.
+static bool ReadTableOfContents(FileHandle &handle, const std::string &path, idx_t file_size, UsdCrateToc &toc) {
+    if (file_size < BOOTSTRAP_SIZE) {
+        return false;
+    }
+    char bootstrap[BOOTSTRAP_SIZE];
+    handle.Read(bootstrap, BOOTSTRAP_SIZE, 0);
+    if (memcmp(bootstrap, CRATE_MAGIC, 8) != 0) {
+        return false;
+    }
+    auto major = uint8_t(bootstrap[8]);
+    auto minor = uint8_t(bootstrap[9]);
+    if (major != 0 || minor < MIN_MINOR_VERSION) {
+        return false;
+    }
+
+    int64_t toc_offset;
+    memcpy(&toc_offset, bootstrap + 16, sizeof(toc_offset));
+    if (toc_offset < 0 || idx_t(toc_offset) > file_size - sizeof(uint64_t)) {
+        ThrowCorrupt(path, "table of contents out of bounds");
+    }
+    uint64_t section_count;
+    handle.Read(&section_count, sizeof(section_count), toc_offset);
+    if (section_count > (file_size - toc_offset) / SECTION_ENTRY_SIZE) {
+        ThrowCorrupt(path, "table of contents out of bounds");
+    }
+    auto entries = ReadSection(handle, path, file_size, toc_offset + int64_t(sizeof(uint64_t)),
+                               int64_t(section_count * SECTION_ENTRY_SIZE));
+    for (idx_t i = 0; i < section_count; i++) {
+        auto entry = entries.data() + i * SECTION_ENTRY_SIZE;
+        std::string name(entry, strnlen(entry, SECTION_NAME_SIZE));
+        UsdCrateSection section;
+        memcpy(&section.start, entry + SECTION_NAME_SIZE, sizeof(int64_t));
+        memcpy(&section.size, entry + SECTION_NAME_SIZE + sizeof(int64_t), sizeof(int64_t));
+        if (name == "TOKENS") {
+            toc.tokens = section;
+        } else if (name == "FIELDS") {
+            toc.fields = section;
+        } else if (name == "FIELDSETS") {
+            toc.field_sets = section;
+        } else if (name == "PATHS") {
+            toc.paths = section;
+        } else if (name == "SPECS") {
+            toc.specs = section;
+        }
+    }
+    return true;
+}
+
+unique_ptr<UsdCrateReader> UsdCrateReader::TryOpen(ClientContext &context, const std::string &path,
+                                                   uint8_t sections) {
+    auto &fs = FileSystem::GetFileSystem(context);
+    auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ);
+    idx_t file_size = fs.GetFileSize(*handle);
+    UsdCrateToc toc;
+    if (!ReadTableOfContents(*handle, path, file_size, toc)) {
+        return nullptr;
+    }
+
+    auto result = unique_ptr<UsdCrateReader>(new UsdCrateReader());
+    result->path = path;
+    auto read = [&](const UsdCrateSection &section, const char *name) {
+        if (!section.Exists()) {
+            ThrowCorrupt(path, std::string("missing ") + name + " section");
+        }
+        return ReadSection(*handle, path, file_size, section.start, section.size);
+    };
+    if (sections & (CRATE_PATHS | CRATE_FIELDS)) {
+        result->ReadTokens(read(toc.tokens, "TOKENS"));
+    }
+    if (sections & CRATE_PATHS) {
+        result->ReadPaths(read(toc.paths, "PATHS"));
+    }
+    if (sections & CRATE_FIELDS) {
+        result->ReadFields(read(toc.fields, "FIELDS"));
+        result->ReadFieldSets(read(toc.field_sets, "FIELDSETS"));
+    }
+    result->ReadSpecs(read(toc.specs, "SPECS"), sections);
+    return result;
+}
+
+bool UsdCrateReader::TryReadSpecCount(ClientContext &context, const std::string &path, idx_t &count) {
+    auto &fs = FileSystem::GetFileSystem(context);
+    auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ);
+    idx_t file_size = fs.GetFileSize(*handle);
+    UsdCrateToc toc;
+    if (!ReadTableOfContents(*handle, path, file_size, toc) || !toc.specs.Exists()) {
+        return false;
+    }
+    // The SPECS section starts with the spec count
+    auto header = ReadSection(*handle, path, file_size, toc.specs.start, MinValue<int64_t>(toc.specs.size, 8));
+    if (header.size() < sizeof(uint64_t)) {
+        return false;
+    }
+    uint64_t spec_count;
+    memcpy(&spec_count, header.data(), sizeof(spec_count));
+    count = spec_count;
+    return true;
+}
+
+void UsdCrateReader::ReadTokens(const std::vector<char> &section) {
+    UsdCrateCursor cursor(path, section);
+    auto token_count = cursor.Read<uint64_t>();
+    auto uncompressed_size = cursor.Read<uint64_t>();
+    auto compressed_size = cursor.Read<uint64_t>();
+    auto compressed = cursor.Take(compressed_size);
+    if (uncompressed_size < token_count || uncompressed_size > compressed_size * 256 + 64) {
+        ThrowCorrupt(path, "implausible token data size");
+    }
+
+    // Tokens are stored as consecutive null-terminated strings
+    std::vector<char> characters(uncompressed_size);
+    auto size = Decompress(path, compressed, compressed_size, characters.data(), characters.size());
+    tokens.reserve(token_count);
+    idx_t start = 0;
+    for (idx_t i = 0; i < token_count; i++) {
+        auto end = start;
+        while (end < size && characters[end] != '\0') {
+            end++;
+        }
+        if (end == size) {
+            ThrowCorrupt(path, "truncated token data");
+        }
+        tokens.emplace_back(characters.data() + start, end - start);
+        start = end + 1;
+    }
+    specifier_token = FindToken("specifier");
+    type_name_token = FindToken("typeName");
+}
+
+uint32_t UsdCrateReader::FindToken(const char *token) const {
+    for (idx_t i = 0; i < tokens.size(); i++) {
+        if (tokens[i] == token) {
+            return uint32_t(i);
+        }
+    }
+    return NO_PARENT;
+}
+
+void UsdCrateReader::ReadPaths(const std::vector<char> &section) {
+    UsdCrateCursor cursor(path, section);
+    auto path_count = cursor.Read<uint64_t>();
+    auto encoded_count = cursor.Read<uint64_t>();
+    if (path_count > encoded_count) {
+        ThrowCorrupt(path, "implausible path count");
+    }
+    std::vector<uint32_t> path_indexes;
+    std::vector<int32_t> element_tokens;
+    std::vector<int32_t> jumps;
+    ReadCompressedInts32(cursor, path_indexes, encoded_count);
+    ReadCompressedInts32(cursor, element_tokens, encoded_count);
+    ReadCompressedInts32(cursor, jumps, encoded_count);
+
+    // The paths are a preorder walk of the path tree. Each entry's jump says
+    // whether a child follows it (-1), a sibling follows it (0), both (the
+    // sibling is jump entries ahead) or neither (-2).
+    paths.assign(path_count, PathNode {NO_PARENT, 0});
+    std::vector<std::pair<idx_t, uint32_t>> pending;
+    if (encoded_count > 0) {
+        pending.emplace_back(0, NO_PARENT);
+    }
+    bool root_seen = false;
+    while (!pending.empty()) {
+        auto index = pending.back().first;
+        auto parent = pending.back().second;
+        pending.pop_back();
+        while (true) {
+            if (index >= encoded_count || path_indexes[index] >= path_count) {
+                ThrowCorrupt(path, "path index out of bounds");
+            }
+            auto current = index++;
+            auto path_index = path_indexes[current];
+            if (parent == NO_PARENT) {
+                // The first entry is the pseudo-root
+                if (root_seen) {
+                    ThrowCorrupt(path, "malformed path tree");
+                }
+                root_seen = true;
+            } else {
+                auto element = element_tokens[current];
+                auto token = element < 0 ? -int64_t(element) : int64_t(element);
+                if (idx_t(token) >= tokens.size()) {
+                    ThrowCorrupt(path, "path token out of bounds");
+                }
+                paths[path_index] = PathNode {parent, element};
+            }
+
+            auto jump = jumps[current];
+            bool has_child = jump > 0 || jump == -1;
+            bool has_sibling = jump >= 0;
+            if (has_child && has_sibling) {
+                pending.emplace_back(current + idx_t(jump), parent);
+            }
+            if (has_child) {
+                parent = path_index;
+            } else if (!has_sibling) {
+                break;
+            }
+        }
+    }
+}
+
+void UsdCrateReader::ReadFields(const std::vector<char> &section) {
+    UsdCrateCursor cursor(path, section);
+    auto field_count = cursor.Read<uint64_t>();
+    ReadCompressedInts32(cursor, field_tokens, field_count);
+    for (auto token : field_tokens) {
+        if (token >= tokens.size()) {
+            ThrowCorrupt(path, "field token out of bounds");
+        }
+    }
+    auto reps_size = cursor.Read<uint64_t>();
+    auto reps = cursor.Take(reps_size);
+    if (field_count > reps_size * 32 + 8) {
+        ThrowCorrupt(path, "implausible field count");
+    }
+    field_reps.resize(field_count);
+    auto size = Decompress(path, reps, reps_size, reinterpret_cast<char *>(field_reps.data()),
+                           field_count * sizeof(uint64_t));
+    if (size != field_count * sizeof(uint64_t)) {
+        ThrowCorrupt(path, "truncated field values");
+    }
+}
+
+void UsdCrateReader::ReadFieldSets(const std::vector<char> &section) {
+    UsdCrateCursor cursor(path, section);
+    auto count = cursor.Read<uint64_t>();
+    ReadCompressedInts32(cursor, field_sets, count);
+    for (auto field : field_sets) {
+        if (field != FIELD_SET_END && field >= field_tokens.size()) {
+            ThrowCorrupt(path, "field index out of bounds");
+        }
+    }
+}
+
+void UsdCrateReader::ReadSpecs(const std::vector<char> &section, uint8_t sections) {
+    UsdCrateCursor cursor(path, section);
+    auto spec_count = cursor.Read<uint64_t>();
+    ReadCompressedInts32(cursor, spec_paths, spec_count);
+    ReadCompressedInts32(cursor, spec_field_sets, spec_count);
+    ReadCompressedInts32(cursor, spec_types, spec_count);
+    for (idx_t i = 0; i < spec_count; i++) {
+        if ((sections & CRATE_PATHS) && spec_paths[i] >= paths.size()) {
+            ThrowCorrupt(path, "spec path out of bounds");
+        }
+        if ((sections & CRATE_FIELDS) && spec_field_sets[i] >= field_sets.size()) {
+            ThrowCorrupt(path, "spec field set out of bounds");
+        }
+    }
+}
+
+std::string UsdCrateReader::PathString(uint32_t node) const {
+    // Element nodes from the leaf up to (excluding) the pseudo-root
+    std::vector<uint32_t> chain;
+    for (auto current = node; paths[current].parent != NO_PARENT; current = paths[current].parent) {
+        chain.push_back(current);
+        if (chain.size() > paths.size()) {
+            ThrowCorrupt(path, "cyclic path tree");
+        }
+    }
+    std::string result = "/";
+    for (auto entry = chain.rbegin(); entry != chain.rend(); entry++) {
+        auto element = paths[*entry].element;
+        if (element < 0) {
+            result += "." + tokens[-int64_t(element)];
+            continue;
+        }
+        const auto &name = tokens[element];
+        // Variant selections ({set=variant}) and targets ([/path]) attach
+        // directly, as do prims below a variant selection
+        bool attach = name.empty() || name[0] == '{' || name[0] == '[' || result.back() == '/' ||
+                      result.back() == '}';
+        result += attach ? name : "/" + name;
+    }
+    return result;
+}
+
+std::string UsdCrateReader::GetSpecPath(idx_t spec) const {
+    return PathString(spec_paths[spec]);
+}
+
+bool UsdCrateReader::GetParentPath(idx_t spec, std::string &result) const {
+    auto parent = paths[spec_paths[spec]].parent;
+    if (parent == NO_PARENT) {
+        return false;
+    }
+    result = PathString(parent);
+    return true;
+}
+
+bool UsdCrateReader::FindInlinedField(idx_t spec, uint32_t field_token, uint8_t value_type, uint64_t &payload) const {
+    if (field_token == NO_PARENT) {
+        // No spec of the file has this field
+        return false;
+    }
+    for (auto index = spec_field_sets[spec]; index < field_sets.size(); index++) {
+        auto field = field_sets[index];
+        if (field == FIELD_SET_END) {
+            break;
+        }
+        if (field_tokens[field] != field_token) {
+            continue;
+        }
+        auto rep = field_reps[field];
+        if (!(rep & VALUE_REP_INLINED_BIT) || (rep & VALUE_REP_ARRAY_BIT) || uint8_t(rep >> 48) != value_type) {
+            return false;
+        }
+        payload = rep & VALUE_REP_PAYLOAD_MASK;
+        return true;
+    }
+    return false;
+}
+
+bool UsdCrateReader::GetSpecifier(idx_t spec, pxr::SdfSpecifier &result) const {
+    uint64_t payload;
+    if (!FindInlinedField(spec, specifier_token, CRATE_TYPE_SPECIFIER, payload) ||
+        payload >= pxr::SdfNumSpecifiers) {
+        return false;
+    }
+    result = static_cast<pxr::SdfSpecifier>(payload);
+    return true;
+}
+
+bool UsdCrateReader::GetTypeName(idx_t spec, std::string &result) const {
+    uint64_t payload;
+    if (!FindInlinedField(spec, type_name_token, CRATE_TYPE_TOKEN, payload) || payload >= tokens.size()) {
+        return false;
+    }
+    result = tokens[payload];
+    return !result.empty();
+}
+
+} // namespace duckdb
@@ -3,9 +3,23 @@
 #include "usd_properties.hpp"
 #include "usd_relationships.hpp"
 #include "usd_xforms.hpp"
+#include "usd_scene.hpp"
+#include "usd_attribute_values.hpp"
+#include "usd_time_samples.hpp"
+#include "usd_bounds.hpp"
+#include "usd_spatial.hpp"
+#include "usd_relationship_graph.hpp"
+#include "usd_layer_specs.hpp"
+#include "usd_cache.hpp"
+#include "usd_snapshot.hpp"
+#include "usd_changes.hpp"
+#include "usd_resolver.hpp"
+#include "usd_profile.hpp"
+#include "usd_helpers.hpp"
 #include "duckdb.hpp"
 #include "duckdb/common/exception.hpp"
 #include "duckdb/function/table_function.hpp"
+#include "duckdb/main/config.hpp"
 
 namespace duckdb {
 
@@ -55,25 +69,77 @@ static void UsdTestFunction(ClientContext &context, TableFunctionInput &data_p,
 }
 
 static void LoadInternal(ExtensionLoader &loader) {
+    // Serve s3://, https://, ... layers through DuckDB's FileSystem
+    UsdRemoteFileSystem::Register();
+
     // Register usd_test() table function
     TableFunction usd_test_func("usd_test", {}, UsdTestFunction, UsdTestBind, UsdTestInit);
     loader.RegisterFunction(usd_test_func);
 
-    // Register usd_prims() table function
-    auto usd_prims_func = UsdPrimsFunction::GetFunction();
+    // Register usd_prims() table function (scans take a path, a glob or a LIST)
+    auto usd_prims_func = UsdFileList::GetFunctionSet(UsdPrimsFunction::GetFunction());
     loader.RegisterFunction(usd_prims_func);
 
     // Register usd_properties() table function
-    auto usd_properties_func = UsdPropertiesFunction::GetFunction();
+    auto usd_properties_func = UsdFileList::GetFunctionSet(UsdPropertiesFunction::GetFunction());
     loader.RegisterFunction(usd_properties_func);
 
     // Register usd_relationships() table function
-    auto usd_relationships_func = UsdRelationshipsFunction::GetFunction();
+    auto usd_relationships_func = UsdFileList::GetFunctionSet(UsdRelationshipsFunction::GetFunction());
     loader.RegisterFunction(usd_relationships_func);
 
     // Register usd_xforms() table function
-    auto usd_xforms_func = UsdXformsFunction::GetFunction();
+    auto usd_xforms_func = UsdFileList::GetFunctionSet(UsdXformsFunction::GetFunction());
     loader.RegisterFunction(usd_xforms_func);
+
+    // Register usd_scene() (usd_prims, usd_xforms and counts in one traversal)
+    loader.RegisterFunction(UsdFileList::GetFunctionSet(UsdSceneFunction::GetFunction()));
+
+    // Register usd_attribute_values() table function
+    loader.RegisterFunction(UsdFileList::GetFunctionSet(UsdAttributeValuesFunction::GetFunction()));
+
+    // Register usd_time_samples() table function
+    loader.RegisterFunction(UsdFileList::GetFunctionSet(UsdTimeSamplesFunction::GetFunction()));
+
+    // Register usd_bounds() table function
+    loader.RegisterFunction(UsdFileList::GetFunctionSet(UsdBoundsFunction::GetFunction()));
+
+    // Register usd_layer_specs() table function (raw layers, no composition)
+    loader.RegisterFunction(UsdFileList::GetFunctionSet(UsdLayerSpecsFunction::GetFunction()));
+
+    // Register spatial queries over the cached per-stage spatial index
+    loader.RegisterFunction(UsdWithinRadiusFunction::GetFunction());
+    loader.RegisterFunction(UsdWithinBoxFunction::GetFunction());
+    loader.RegisterFunction(UsdNearestFunction::GetFunction());
+
+    // Register reverse lookups and closures over the cached relationship graph
+    loader.RegisterFunction(UsdReferrersFunction::GetFunction());
+    loader.RegisterFunction(UsdRelationshipClosureFunction::GetFunction());
+
+    // Register stage cache introspection and control functions
+    loader.RegisterFunction(UsdCacheStatsFunction::GetFunction());
+    loader.RegisterFunction(UsdCacheClearFunction::GetFunction());
+
+    // Register usd_last_scan_stats() (counters and phase times of the last usd_* scans)
+    loader.RegisterFunction(UsdLastScanStatsFunction::GetFunction());
+
+    // Register usd_changes() (paths recomposed by reloads of cached stages)
+    loader.RegisterFunction(UsdChangesFunction::GetFunction());
+
+    // Register snapshots of scans into native tables and their refresh
+    loader.RegisterFunction(UsdStageLayersFunction::GetFunction());
+    loader.RegisterFunction(UsdSnapshotFunction::GetFunctions());
+    loader.RegisterFunction(UsdRefreshFunction::GetFunction());
+
+    // Memory bound of the process-wide stage cache ('0' disables caching)
+    auto &config = DBConfig::GetConfig(loader.GetDatabaseInstance());
+    config.AddExtensionOption(UsdStageManager::CACHE_LIMIT_SETTING,
+                              "Maximum estimated size of composed USD stages kept in the stage cache",
+                              LogicalType::VARCHAR, Value(UsdStageManager::CACHE_LIMIT_DEFAULT));
+    // Phase timing of scans outside EXPLAIN ANALYZE and PRAGMA enable_profiling
+    config.AddExtensionOption(UsdScanHistory::TIMING_SETTING,
+                              "Time the open, traverse, extract and emit phases of every usd_* scan",
+                              LogicalType::BOOLEAN, Value::BOOLEAN(false));
 }
 
 void UsdExtension::Load(ExtensionLoader &loader) {
@@ -1,38 +1,764 @@
 #include "usd_helpers.hpp"
+#include "usd_resolver.hpp"
 #include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/main/config.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/expression/bound_operator_expression.hpp"
 #include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usd/modelAPI.h>
+#include <pxr/usd/usd/stagePopulationMask.h>
+#include <pxr/usd/usd/notice.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/ar/packageUtils.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/tf/notice.h>
+#include <pxr/base/tf/weakBase.h>
+#include <algorithm>
 #include <filesystem>
+#include <list>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace duckdb {
 
-pxr::UsdStageRefPtr UsdStageManager::OpenStage(const std::string &file_path) {
-    // Validate file exists
-    if (!std::filesystem::exists(file_path)) {
+// Changes are numbered across all stages; 0 precedes every change
+static std::atomic<idx_t> next_change_token {1};
+// Changes kept per stage; older ones are dropped and reported as a resync of
+// the whole stage
+static constexpr idx_t MAX_LOGGED_CHANGES = 65536;
+
+// Paths a cached stage recomposed after layer reloads, recorded from its
+// UsdNotice::ObjectsChanged notices
+class UsdChangeLog : public pxr::TfWeakBase {
+public:
+    explicit UsdChangeLog(const pxr::UsdStageRefPtr &stage) : start_token_(next_change_token++) {
+        key_ = pxr::TfNotice::Register(pxr::TfCreateWeakPtr(this), &UsdChangeLog::OnObjectsChanged,
+                                       pxr::UsdStagePtr(stage));
+    }
+    ~UsdChangeLog() {
+        pxr::TfNotice::Revoke(key_);
+    }
+
+    void OnObjectsChanged(const pxr::UsdNotice::ObjectsChanged &notice, const pxr::UsdStageWeakPtr &sender) {
+        std::lock_guard<std::mutex> guard(lock_);
+        idx_t token = next_change_token++;
+        for (const auto &path : notice.GetResyncedPaths()) {
+            changes_.push_back(UsdStageChange {token, path, true});
+        }
+        for (const auto &path : notice.GetChangedInfoOnlyPaths()) {
+            changes_.push_back(UsdStageChange {token, path, false});
+        }
+        if (changes_.size() > MAX_LOGGED_CHANGES) {
+            // Keep the newer half, cut at a notice boundary
+            auto cut = changes_.begin() + (changes_.size() - MAX_LOGGED_CHANGES / 2);
+            start_token_ = (cut - 1)->token;
+            while (cut != changes_.end() && cut->token == start_token_) {
+                ++cut;
+            }
+            changes_.erase(changes_.begin(), cut);
+        }
+    }
+
+    idx_t GetChanges(idx_t since, std::vector<UsdStageChange> &result) const {
+        std::lock_guard<std::mutex> guard(lock_);
+        for (const auto &change : changes_) {
+            if (change.token > since) {
+                result.push_back(change);
+            }
+        }
+        return start_token_;
+    }
+
+private:
+    mutable std::mutex lock_;
+    pxr::TfNotice::Key key_;
+    // Every change after this token is logged
+    idx_t start_token_;
+    std::vector<UsdStageChange> changes_;
+};
+
+struct UsdCachedStage {
+    std::string key;
+    pxr::UsdStageRefPtr stage;
+    // Database whose FileSystem reads the stage's remote layers
+    weak_ptr<DatabaseInstance> owner;
+    std::vector<UsdLayerStamp> layers;
+    // Layer sizes plus the estimated size of the derived data
+    idx_t resident_bytes = 0;
+    std::unordered_map<std::string, std::shared_ptr<UsdStageDerivedData>> derived;
+    std::shared_ptr<UsdChangeLog> changes;
+};
+
+// A stage opened by the extension that may still be in use, with the layers
+// it was composed from. Their stamps are those of the contents it loaded,
+// which the layer registry shares with every stage opening the same layers.
+struct UsdLiveStage {
+    pxr::UsdStagePtr stage;
+    const pxr::UsdStage *id;
+    std::vector<UsdLayerStamp> layers;
+};
+
+// Process-wide LRU cache of composed stages. Stages are shared between
+// queries: UsdStage reads are thread-safe, and the only mutation, reloading
+// changed layers, happens while no query holds a stage using those layers.
+struct UsdStageCache {
+    std::mutex lock;
+    // Most recently used entry first
+    std::list<UsdCachedStage> lru;
+    std::unordered_map<std::string, std::list<UsdCachedStage>::iterator> index;
+    UsdStageCacheStats stats;
+    // Every stage opened and not yet destroyed, cached or not
+    std::vector<UsdLiveStage> live;
+    // Held shared while stages are composed (which may open layers that are
+    // being reloaded) and exclusively while layers are reloaded
+    std::shared_timed_mutex layer_edit_lock;
+
+    static UsdStageCache &Get() {
+        static UsdStageCache cache;
+        return cache;
+    }
+};
+
+bool UsdFileList::Stat(ClientContext &context, const std::string &path, int64_t &mtime, uint64_t &size) {
+    if (UsdRemoteFileSystem::IsRemotePath(path)) {
+        return UsdRemoteFileSystem::Stat(context, path, mtime, size);
+    }
+    std::error_code ec;
+    auto write_time = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return false;
+    }
+    auto file_size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    mtime = static_cast<int64_t>(write_time.time_since_epoch().count());
+    size = static_cast<uint64_t>(file_size);
+    return true;
+}
+
+static bool UsesLayer(const std::vector<UsdLayerStamp> &layers, const std::string &path) {
+    for (const auto &stamp : layers) {
+        if (stamp.path == path) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Stamp of the contents of the layer at path, if a live stage loaded it
+static const UsdLayerStamp *FindLoadedLayer(const UsdStageCache &cache, const std::string &path) {
+    for (const auto &live : cache.live) {
+        if (!live.stage) {
+            continue;
+        }
+        for (const auto &stamp : live.layers) {
+            if (stamp.path == path) {
+                return &stamp;
+            }
+        }
+    }
+    return nullptr;
+}
+
+// Records every layer the stage depends on, so that edits to sublayers,
+// references and payloads invalidate the entry as well as edits to the root.
+// A layer live stages had loaded already was not read again (the registry
+// shares it), so it keeps their stamp: that of the contents the stage reads.
+// Returns the layers whose contents are older than their files that way.
+static std::vector<std::string> StampStageLayers(ClientContext &context, const pxr::UsdStageRefPtr &stage,
+                                                 UsdCachedStage &entry) {
+    std::unordered_set<std::string> seen;
+    std::vector<UsdLayerStamp> stamps;
+    for (const auto &layer : stage->GetUsedLayers()) {
+        if (!layer || layer->IsAnonymous()) {
+            continue;
+        }
+        const auto &real_path = layer->GetRealPath();
+        if (real_path.empty() || !seen.insert(real_path).second) {
+            continue;
+        }
+        UsdLayerStamp stamp;
+        stamp.path = real_path;
+        // Layers inside packages (.usdz) have no file of their own
+        if (!UsdFileList::Stat(context, real_path, stamp.mtime, stamp.size)) {
+            // The registry shares layers other databases loaded: a remote
+            // layer is only served to a caller whose credentials can read it
+            auto file = pxr::ArSplitPackageRelativePathOuter(real_path).first;
+            if (UsdRemoteFileSystem::IsRemotePath(file) && !UsdRemoteFileSystem::FileExists(context, file)) {
+                throw IOException("Cannot read remote USD layer: " + file);
+            }
+            continue;
+        }
+        stamps.push_back(std::move(stamp));
+    }
+
+    std::vector<std::string> outdated;
+    auto &cache = UsdStageCache::Get();
+    std::lock_guard<std::mutex> guard(cache.lock);
+    for (auto &stamp : stamps) {
+        auto loaded = FindLoadedLayer(cache, stamp.path);
+        if (loaded && (loaded->mtime != stamp.mtime || loaded->size != stamp.size)) {
+            outdated.push_back(stamp.path);
+            stamp = *loaded;
+        }
+        // Composed stages are roughly proportional to the layers they read
+        entry.resident_bytes += stamp.size;
+        entry.layers.push_back(std::move(stamp));
+    }
+    return outdated;
+}
+
+// Paths of the layers that were modified or removed since they were stamped
+static std::vector<std::string> GetChangedLayers(ClientContext &context, const std::vector<UsdLayerStamp> &layers) {
+    std::vector<std::string> changed;
+    for (const auto &stamp : layers) {
+        int64_t mtime;
+        uint64_t size;
+        if (!UsdFileList::Stat(context, stamp.path, mtime, size) || mtime != stamp.mtime || size != stamp.size) {
+            changed.push_back(stamp.path);
+        }
+    }
+    return changed;
+}
+
+// Records the layers of entry's stage as live, replacing those recorded
+// before it was re-stamped
+static void RegisterLiveStage(UsdStageCache &cache, const UsdCachedStage &entry) {
+    cache.live.erase(std::remove_if(cache.live.begin(), cache.live.end(),
+                                    [](const UsdLiveStage &live) { return !live.stage; }),
+                     cache.live.end());
+    for (auto &live : cache.live) {
+        if (live.id == entry.stage.operator->()) {
+            live.layers = entry.layers;
+            return;
+        }
+    }
+    cache.live.push_back(UsdLiveStage {pxr::UsdStagePtr(entry.stage), entry.stage.operator->(), entry.layers});
+}
+
+// Forgets the contents live stages loaded for layers that were reloaded
+static void ForgetLoadedLayers(UsdStageCache &cache, const std::vector<std::string> &paths) {
+    for (auto &live : cache.live) {
+        live.layers.erase(std::remove_if(live.layers.begin(), live.layers.end(),
+                                         [&](const UsdLayerStamp &stamp) {
+                                             return std::find(paths.begin(), paths.end(), stamp.path) != paths.end();
+                                         }),
+                          live.layers.end());
+    }
+}
+
+// Whether a query holds a live stage (other than skip) using the layer at path.
+// Cached stages are held beyond the cache's own reference; uncached stages
+// live only as long as the query that opened them.
+static bool IsLayerHeld(UsdStageCache &cache, const std::string &path, const pxr::UsdStage *skip) {
+    for (const auto &live : cache.live) {
+        if (!live.stage || live.id == skip || !UsesLayer(live.layers, path)) {
+            continue;
+        }
+        auto cached = std::find_if(cache.lru.begin(), cache.lru.end(), [&](const UsdCachedStage &entry) {
+            return entry.stage.operator->() == live.id;
+        });
+        if (cached == cache.lru.end() || cached->stage->GetCurrentCount() > 1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static idx_t GetCacheLimit(ClientContext &context) {
+    Value limit_value;
+    if (!context.TryGetCurrentSetting(UsdStageManager::CACHE_LIMIT_SETTING, limit_value) || limit_value.IsNull()) {
+        return DBConfig::ParseMemoryLimit(UsdStageManager::CACHE_LIMIT_DEFAULT);
+    }
+    auto limit_str = limit_value.ToString();
+    if (limit_str == "0") {
+        return 0;
+    }
+    return DBConfig::ParseMemoryLimit(limit_str);
+}
+
+// Evicts least recently used entries until the cache fits in limit. Evicted
+// stages are handed back so they can be destroyed outside the cache lock.
+static void EvictToLimit(UsdStageCache &cache, idx_t limit, vector<pxr::UsdStageRefPtr> &evicted) {
+    while (!cache.lru.empty() && cache.stats.resident_bytes > limit) {
+        auto &victim = cache.lru.back();
+        cache.stats.resident_bytes -= victim.resident_bytes;
+        cache.stats.evictions++;
+        evicted.push_back(std::move(victim.stage));
+        cache.index.erase(victim.key);
+        cache.lru.pop_back();
+    }
+}
+
+// Reloads the changed layers in place, so that USD recomposes only the
+// prims they affect on every stage using them and reports those to the
+// stages' change logs. The layer registry shares one copy of a layer between
+// all stages opening it, so reloading that copy is also what lets a stage
+// composed later read the edit. A layer is reloaded once no query holds a
+// stage using it (reloading would change the stage under the query); until
+// then its stages stay stale, serving the contents they were composed from.
+// Cached stages using a reloaded layer are re-stamped and stay cached; those
+// using a layer that cannot be reloaded (removed, or saved half-written) are
+// dropped into evicted, to be recomposed. self, if given, is a stage the
+// caller composed and has not handed out yet.
+static void RefreshLayers(ClientContext &context, UsdStageCache &cache, const std::vector<std::string> &changed,
+                          UsdCachedStage *self, vector<pxr::UsdStageRefPtr> &evicted) {
+    // Excludes composition, which could open the layers mid-reload
+    std::unique_lock<std::shared_timed_mutex> edit(cache.layer_edit_lock);
+    const pxr::UsdStage *self_id = self ? self->stage.operator->() : nullptr;
+    std::vector<std::string> refresh;
+    std::vector<UsdCachedStage> users;
+    {
+        std::lock_guard<std::mutex> guard(cache.lock);
+        for (const auto &path : changed) {
+            if (!IsLayerHeld(cache, path, self_id)) {
+                refresh.push_back(path);
+            }
+        }
+        if (refresh.empty()) {
+            return;
+        }
+        // Taken out of the cache, so that no lookup hands them out mid-reload
+        for (auto entry = cache.lru.begin(); entry != cache.lru.end();) {
+            bool uses = std::any_of(refresh.begin(), refresh.end(),
+                                    [&](const std::string &path) { return UsesLayer(entry->layers, path); });
+            if (!uses) {
+                ++entry;
+                continue;
+            }
+            cache.stats.resident_bytes -= entry->resident_bytes;
+            cache.index.erase(entry->key);
+            users.push_back(std::move(*entry));
+            entry = cache.lru.erase(entry);
+        }
+    }
+
+    // The registry's copies, found through the stages using them
+    std::vector<pxr::SdfLayerHandle> layers;
+    auto collect = [&](const pxr::UsdStageRefPtr &stage) {
+        for (const auto &layer : stage->GetUsedLayers()) {
+            if (layer && std::find(refresh.begin(), refresh.end(), layer->GetRealPath()) != refresh.end() &&
+                std::find(layers.begin(), layers.end(), layer) == layers.end()) {
+                layers.push_back(layer);
+            }
+        }
+    };
+    for (const auto &user : users) {
+        collect(user.stage);
+    }
+    if (self) {
+        collect(self->stage);
+    }
+    std::vector<std::string> failed;
+    {
+        UsdRemoteFileSystem::ScopedContext remote_context(context);
+        for (auto &layer : layers) {
+            if (!layer->Reload(true)) {
+                failed.push_back(layer->GetRealPath());
+            }
+        }
+    }
+    std::vector<std::string> reloaded;
+    for (const auto &path : refresh) {
+        if (std::find(failed.begin(), failed.end(), path) == failed.end()) {
+            reloaded.push_back(path);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> guard(cache.lock);
+        ForgetLoadedLayers(cache, reloaded);
+    }
+
+    // Re-stamp (reloads may add or drop sublayers and references); derived
+    // data was built from the old contents
+    auto uses_failed = [&](const UsdCachedStage &entry) {
+        return std::any_of(failed.begin(), failed.end(),
+                           [&](const std::string &path) { return UsesLayer(entry.layers, path); });
+    };
+    for (auto &user : users) {
+        if (uses_failed(user)) {
+            continue;
+        }
+        user.layers.clear();
+        user.resident_bytes = 0;
+        user.derived.clear();
+        StampStageLayers(context, user.stage, user);
+    }
+    if (self && !uses_failed(*self)) {
+        self->layers.clear();
+        self->resident_bytes = 0;
+        StampStageLayers(context, self->stage, *self);
+    }
+    auto limit = GetCacheLimit(context);
+    std::lock_guard<std::mutex> guard(cache.lock);
+    if (self) {
+        RegisterLiveStage(cache, *self);
+    }
+    // Back in their LRU order
+    for (auto user = users.rbegin(); user != users.rend(); ++user) {
+        if (uses_failed(*user) || cache.index.find(user->key) != cache.index.end()) {
+            // Recomposed on next use, or already reopened by another query
+            cache.stats.invalidations++;
+            evicted.push_back(std::move(user->stage));
+            continue;
+        }
+        RegisterLiveStage(cache, *user);
+        cache.stats.reloads++;
+        cache.stats.resident_bytes += user->resident_bytes;
+        cache.lru.push_front(std::move(*user));
+        cache.index[cache.lru.front().key] = cache.lru.begin();
+    }
+    EvictToLimit(cache, limit, evicted);
+}
+
+void UsdStageLoadOptions::Bind(const std::string &function_name, const named_parameter_map_t &named_parameters) {
+    for (auto &kv : named_parameters) {
+        if (kv.first == "mask") {
+            if (kv.second.IsNull()) {
+                continue;
+            }
+            for (auto &entry : ListValue::GetChildren(kv.second)) {
+                auto path_str = entry.ToString();
+                pxr::SdfPath path = pxr::SdfPath::IsValidPathString(path_str) ? pxr::SdfPath(path_str)
+                                                                               : pxr::SdfPath();
+                if (path.IsEmpty() || !path.IsAbsolutePath() || !(path.IsPrimPath() || path.IsAbsoluteRootPath())) {
+                    throw BinderException(function_name + ": mask entries must be absolute prim paths: " + path_str);
+                }
+                population_mask.push_back(path);
+            }
+        } else if (kv.first == "load") {
+            auto load = StringUtil::Lower(kv.second.ToString());
+            if (load == "all") {
+                load_payloads = true;
+            } else if (load == "none") {
+                load_payloads = false;
+            } else {
+                throw BinderException(function_name + ": load must be 'all' or 'none', got '" + kv.second.ToString() +
+                                      "'");
+            }
+        }
+    }
+}
+
+UsdStageLoadOptions UsdStageLoadOptions::WithFilter(const UsdScanFilter &filter) const {
+    auto result = *this;
+    if (!result.population_mask.empty() || !filter.HasPathFilter()) {
+        return result;
+    }
+    auto root = filter.TraversalRoot();
+    if (!root.IsAbsoluteRootPath()) {
+        result.population_mask.push_back(root);
+        result.mask_is_hint = true;
+    }
+    return result;
+}
+
+std::string UsdStageLoadOptions::CacheKeySuffix() const {
+    std::string suffix;
+    if (!load_payloads) {
+        suffix += "|load=none";
+    }
+    if (!population_mask.empty()) {
+        // The mask normalizes away paths covered by another entry
+        for (const auto &path : pxr::UsdStagePopulationMask(population_mask.begin(), population_mask.end()).GetPaths()) {
+            suffix += "|mask=" + path.GetString();
+        }
+    }
+    return suffix;
+}
+
+void UsdStageLoadOptions::RegisterParameters(TableFunction &func) {
+    func.named_parameters["mask"] = LogicalType::LIST(LogicalType::VARCHAR);
+    func.named_parameters["load"] = LogicalType::VARCHAR;
+}
+
+// Returns the cached stage for key. The changed layers of a stale stage are
+// reloaded in place (see RefreshLayers); a stage whose layers could not be
+// reloaded is dropped, to be recomposed. The layers are stat'ed (and
+// reloaded) outside the cache lock: for remote layers a stat is a request,
+// and queries on other stages must not wait for it.
+static pxr::UsdStageRefPtr LookupStage(ClientContext &context, UsdStageCache &cache, const std::string &key,
+                                       vector<pxr::UsdStageRefPtr> &evicted) {
+    std::vector<UsdLayerStamp> layers;
+    {
+        std::lock_guard<std::mutex> guard(cache.lock);
+        auto entry = cache.index.find(key);
+        if (entry == cache.index.end()) {
+            return pxr::UsdStageRefPtr();
+        }
+        auto &cached = *entry->second;
+        bool remote = std::any_of(cached.layers.begin(), cached.layers.end(), [](const UsdLayerStamp &stamp) {
+            return UsdRemoteFileSystem::IsRemotePath(stamp.path);
+        });
+        if (remote && cached.owner.lock().get() != context.db.get()) {
+            // Remote layers are read with the secrets of the database that
+            // opened the stage (or of a closed one at the same address)
+            cache.stats.resident_bytes -= cached.resident_bytes;
+            cache.stats.invalidations++;
+            evicted.push_back(std::move(cached.stage));
+            cache.lru.erase(entry->second);
+            cache.index.erase(entry);
+            return pxr::UsdStageRefPtr();
+        }
+        layers = cached.layers;
+    }
+    auto changed = GetChangedLayers(context, layers);
+    if (!changed.empty()) {
+        RefreshLayers(context, cache, changed, nullptr, evicted);
+    }
+
+    std::lock_guard<std::mutex> guard(cache.lock);
+    auto entry = cache.index.find(key);
+    if (entry == cache.index.end()) {
+        // Dropped, or evicted meanwhile
+        return pxr::UsdStageRefPtr();
+    }
+    cache.lru.splice(cache.lru.begin(), cache.lru, entry->second);
+    return entry->second->stage;
+}
+
+pxr::UsdStageRefPtr UsdStageManager::OpenStage(ClientContext &context, const std::string &file_path,
+                                               const UsdStageLoadOptions &options, UsdScanProfile *profile) {
+    // Remote files are checked when their layers are opened
+    bool remote = UsdRemoteFileSystem::IsRemotePath(file_path);
+    if (!remote && !std::filesystem::exists(file_path)) {
         throw IOException("USD file not found: " + file_path);
     }
-    
-    // Open the USD stage
-    auto stage = pxr::UsdStage::Open(file_path);
-    if (!stage) {
-        throw IOException("Failed to open USD stage: " + file_path);
+
+    std::string file_key = file_path;
+    if (remote) {
+        // Each database reads remote files with its own secrets
+        file_key += "|db=" + std::to_string(reinterpret_cast<uintptr_t>(context.db.get()));
+    } else {
+        std::error_code ec;
+        auto absolute_path = std::filesystem::absolute(file_path, ec);
+        if (!ec) {
+            file_key = absolute_path.lexically_normal().string();
+        }
+    }
+    std::string key = file_key + options.CacheKeySuffix();
+    auto limit = GetCacheLimit(context);
+
+    auto &cache = UsdStageCache::Get();
+    vector<pxr::UsdStageRefPtr> evicted;
+    pxr::UsdStageRefPtr cached;
+    if (options.mask_is_hint) {
+        // An unmasked stage is a superset of the masked one
+        UsdStageLoadOptions unmasked = options;
+        unmasked.population_mask.clear();
+        cached = LookupStage(context, cache, file_key + unmasked.CacheKeySuffix(), evicted);
+    }
+    if (!cached) {
+        cached = LookupStage(context, cache, key, evicted);
+    }
+    {
+        std::lock_guard<std::mutex> guard(cache.lock);
+        cache.stats.memory_limit = limit;
+        if (cached) {
+            cache.stats.hits++;
+        } else {
+            cache.stats.misses++;
+        }
+    }
+    if (profile) {
+        profile->CountStageOpen(bool(cached));
+    }
+    if (cached) {
+        return cached;
+    }
+    // Release dropped stages before reopening so their layers are re-read
+    evicted.clear();
+
+    // Open the USD stage outside the lock; composition can take seconds
+    auto load_set = options.load_payloads ? pxr::UsdStage::LoadAll : pxr::UsdStage::LoadNone;
+    pxr::UsdStageRefPtr stage;
+    UsdCachedStage fresh;
+    std::vector<std::string> outdated;
+    {
+        std::shared_lock<std::shared_timed_mutex> compose(cache.layer_edit_lock);
+        auto resolver_context = UsdRemoteFileSystem::CreateResolverContext(context, file_path);
+        if (options.population_mask.empty()) {
+            stage = pxr::UsdStage::Open(file_path, resolver_context, load_set);
+        } else {
+            pxr::UsdStagePopulationMask mask(options.population_mask.begin(), options.population_mask.end());
+            stage = pxr::UsdStage::OpenMasked(file_path, resolver_context, mask, load_set);
+        }
+        if (!stage) {
+            throw IOException("Failed to open USD stage: " + file_path);
+        }
+        fresh.key = key;
+        fresh.stage = stage;
+        fresh.owner = context.db;
+        outdated = StampStageLayers(context, stage, fresh);
+        // Registered before layers can be reloaded again, so that no reload
+        // changes the stage once the caller starts reading it
+        std::lock_guard<std::mutex> guard(cache.lock);
+        RegisterLiveStage(cache, fresh);
+    }
+    if (!outdated.empty()) {
+        // Composed from layers other stages loaded before they were edited
+        RefreshLayers(context, cache, outdated, &fresh, evicted);
+    }
+    if (fresh.resident_bytes > limit) {
+        // Too large to cache (or caching disabled); serve it uncached
+        return stage;
+    }
+    fresh.changes = std::make_shared<UsdChangeLog>(stage);
+
+    {
+        std::lock_guard<std::mutex> guard(cache.lock);
+        auto entry = cache.index.find(key);
+        if (entry != cache.index.end()) {
+            // Another query opened the same file concurrently; share its stage
+            return entry->second->stage;
+        }
+        cache.stats.resident_bytes += fresh.resident_bytes;
+        cache.lru.push_front(std::move(fresh));
+        cache.index[key] = cache.lru.begin();
+        EvictToLimit(cache, limit, evicted);
     }
-    
     return stage;
 }
 
+pxr::SdfLayerRefPtr UsdStageManager::OpenLayer(ClientContext &context, const std::string &file_path) {
+    if (!UsdRemoteFileSystem::IsRemotePath(file_path) && !std::filesystem::exists(file_path)) {
+        throw IOException("USD file not found: " + file_path);
+    }
+    UsdRemoteFileSystem::ScopedContext remote_context(context);
+    auto layer = pxr::SdfLayer::OpenAsAnonymous(file_path);
+    if (!layer) {
+        throw IOException("Failed to open USD layer: " + file_path);
+    }
+    return layer;
+}
+
+static UsdCachedStage *FindCachedStage(UsdStageCache &cache, const pxr::UsdStageRefPtr &stage) {
+    for (auto &entry : cache.lru) {
+        if (entry.stage == stage) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<UsdStageDerivedData>
+UsdStageManager::GetDerivedData(ClientContext &context, const pxr::UsdStageRefPtr &stage, const std::string &name,
+                                const std::function<std::shared_ptr<UsdStageDerivedData>()> &build) {
+    auto &cache = UsdStageCache::Get();
+    {
+        std::lock_guard<std::mutex> guard(cache.lock);
+        auto entry = FindCachedStage(cache, stage);
+        if (entry) {
+            auto data = entry->derived.find(name);
+            if (data != entry->derived.end()) {
+                return data->second;
+            }
+        }
+    }
+
+    // Build outside the lock; queries on other stages must not wait for it
+    auto data = build();
+    auto limit = GetCacheLimit(context);
+    vector<pxr::UsdStageRefPtr> evicted;
+    {
+        std::lock_guard<std::mutex> guard(cache.lock);
+        auto entry = FindCachedStage(cache, stage);
+        if (!entry) {
+            // The stage is not cached (or was evicted meanwhile)
+            return data;
+        }
+        auto existing = entry->derived.find(name);
+        if (existing != entry->derived.end()) {
+            // Built concurrently by another query; share that copy
+            return existing->second;
+        }
+        auto size = data->EstimatedSize();
+        entry->derived[name] = data;
+        entry->resident_bytes += size;
+        cache.stats.resident_bytes += size;
+        EvictToLimit(cache, limit, evicted);
+    }
+    return data;
+}
+
+std::vector<UsdLayerStamp> UsdStageManager::GetLayerStamps(ClientContext &context, const pxr::UsdStageRefPtr &stage) {
+    auto &cache = UsdStageCache::Get();
+    {
+        std::lock_guard<std::mutex> guard(cache.lock);
+        auto entry = FindCachedStage(cache, stage);
+        if (entry) {
+            return entry->layers;
+        }
+    }
+    UsdCachedStage uncached;
+    StampStageLayers(context, stage, uncached);
+    return uncached.layers;
+}
+
+idx_t UsdStageManager::GetChanges(const pxr::UsdStageRefPtr &stage, idx_t since, std::vector<UsdStageChange> &changes) {
+    std::shared_ptr<UsdChangeLog> log;
+    {
+        auto &cache = UsdStageCache::Get();
+        std::lock_guard<std::mutex> guard(cache.lock);
+        auto entry = FindCachedStage(cache, stage);
+        if (entry) {
+            log = entry->changes;
+        }
+    }
+    if (!log) {
+        // Nothing is recorded for an uncached stage: it starts now
+        return next_change_token++;
+    }
+    return log->GetChanges(since, changes);
+}
+
+UsdStageCacheStats UsdStageManager::GetCacheStats() {
+    auto &cache = UsdStageCache::Get();
+    std::lock_guard<std::mutex> guard(cache.lock);
+    auto stats = cache.stats;
+    stats.entries = cache.lru.size();
+    return stats;
+}
+
+std::pair<idx_t, idx_t> UsdStageManager::ClearCache() {
+    auto &cache = UsdStageCache::Get();
+    std::list<UsdCachedStage> released;
+    std::pair<idx_t, idx_t> result;
+    {
+        std::lock_guard<std::mutex> guard(cache.lock);
+        result = std::make_pair(idx_t(cache.lru.size()), cache.stats.resident_bytes);
+        released.swap(cache.lru);
+        cache.index.clear();
+        cache.stats.resident_bytes = 0;
+    }
+    return result;
+}
+
 bool UsdStageManager::IsValidUsdFile(const std::string &file_path) {
     // Check for empty or whitespace-only paths
     if (file_path.empty() || file_path.find_first_not_of(" \t\n\r") == std::string::npos) {
         return false;
     }
 
-    if (!std::filesystem::exists(file_path)) {
-        return false;
-    }
+    // Remote files are only checked for their extension here
+    if (!UsdRemoteFileSystem::IsRemotePath(file_path)) {
+        if (!std::filesystem::exists(file_path)) {
+            return false;
+        }
 
-    // Check if it's a directory
-    if (std::filesystem::is_directory(file_path)) {
-        return false;
+        // Check if it's a directory
+        if (std::filesystem::is_directory(file_path)) {
+            return false;
+        }
     }
 
     // Check file extension
@@ -43,12 +769,673 @@ bool UsdStageManager::IsValidUsdFile(const std::string &file_path) {
     return (ext == ".usd" || ext == ".usda" || ext == ".usdc" || ext == ".usdz");
 }
 
+void UsdFileList::Validate(ClientContext &context, const std::string &function_name, const std::string &file_path) {
+    // Check for empty path
+    if (file_path.empty() || file_path.find_first_not_of(" \t\n\r") == std::string::npos) {
+        throw BinderException(function_name + ": file_path cannot be empty");
+    }
+
+    if (UsdRemoteFileSystem::IsRemotePath(file_path)) {
+        // Object stores have no directories to rule out
+        if (!UsdRemoteFileSystem::FileExists(context, file_path)) {
+            throw BinderException(function_name + ": USD file not found: " + file_path);
+        }
+    } else {
+        // Check if file exists
+        if (!std::filesystem::exists(file_path)) {
+            throw BinderException(function_name + ": USD file not found: " + file_path);
+        }
+
+        // Check if it's a directory
+        if (std::filesystem::is_directory(file_path)) {
+            throw BinderException(function_name + ": path is a directory, not a file: " + file_path);
+        }
+    }
+
+    // Validate file extension
+    if (!UsdStageManager::IsValidUsdFile(file_path)) {
+        throw BinderException(function_name + ": file must have a USD extension (.usd, .usda, .usdc, .usdz): " +
+                              file_path);
+    }
+}
+
+vector<std::string> UsdFileList::Bind(ClientContext &context, const std::string &function_name, const Value &input) {
+    vector<std::string> patterns;
+    if (input.type().id() == LogicalTypeId::LIST) {
+        auto child_type = ListType::GetChildType(input.type()).id();
+        if (input.IsNull() || (child_type != LogicalTypeId::VARCHAR && child_type != LogicalTypeId::SQLNULL)) {
+            throw BinderException(function_name + ": file_path must be a VARCHAR or a list of VARCHAR");
+        }
+        for (auto &child : ListValue::GetChildren(input)) {
+            if (child.IsNull()) {
+                throw BinderException(function_name + ": file list cannot contain NULL");
+            }
+            patterns.push_back(StringValue::Get(child));
+        }
+        if (patterns.empty()) {
+            throw BinderException(function_name + ": file list cannot be empty");
+        }
+    } else if (input.type().id() == LogicalTypeId::VARCHAR || input.IsNull()) {
+        patterns.push_back(input.ToString());
+    } else {
+        throw BinderException(function_name + ": file_path must be a VARCHAR or a list of VARCHAR");
+    }
+
+    auto &fs = FileSystem::GetFileSystem(context);
+    vector<std::string> files;
+    for (auto &pattern : patterns) {
+        if (!FileSystem::HasGlob(pattern)) {
+            Validate(context, function_name, pattern);
+            files.push_back(pattern);
+            continue;
+        }
+        vector<std::string> matches;
+        for (auto &match : fs.GlobFiles(pattern, context, FileGlobOptions::ALLOW_EMPTY)) {
+            matches.push_back(match.path);
+        }
+        if (matches.empty()) {
+            throw BinderException(function_name + ": no files match pattern: " + pattern);
+        }
+        std::sort(matches.begin(), matches.end());
+        for (auto &match : matches) {
+            Validate(context, function_name, match);
+            files.push_back(std::move(match));
+        }
+    }
+    return files;
+}
+
+static virtual_column_map_t UsdGetVirtualColumns(ClientContext &context, optional_ptr<FunctionData> bind_data) {
+    virtual_column_map_t result;
+    result.insert(make_pair(UsdFileList::FILENAME_COLUMN, TableColumn("filename", LogicalType::VARCHAR)));
+    result.insert(make_pair(COLUMN_IDENTIFIER_ROW_ID, TableColumn("rowid", LogicalType::ROW_TYPE)));
+    return result;
+}
+
+void UsdFileList::RegisterFilenameColumn(TableFunction &func) {
+    func.get_virtual_columns = UsdGetVirtualColumns;
+}
+
+TableFunctionSet UsdFileList::GetFunctionSet(TableFunction scan) {
+    TableFunctionSet set(scan.name);
+    set.AddFunction(scan);
+    scan.arguments[0] = LogicalType::LIST(LogicalType::VARCHAR);
+    set.AddFunction(scan);
+    return set;
+}
+
+bool UsdMultiFileLocalState::OpenNextFile(ClientContext &context, UsdMultiFileGlobalState &gstate,
+                                          const vector<std::string> &files, const UsdStageLoadOptions &options) {
+    CompleteFile(gstate);
+    auto file = gstate.next_file++;
+    if (file >= gstate.file_count) {
+        stage = nullptr;
+        return false;
+    }
+    file_index = file;
+    profile.timing = gstate.tracker.Timing();
+    profile.Enter(UsdScanPhase::OPEN);
+    stage = UsdStageManager::OpenStage(context, files[file], options, &profile);
+    // Scans start walking the stage's prims next
+    profile.Enter(UsdScanPhase::TRAVERSE);
+    return true;
+}
+
+void UsdMultiFileLocalState::CompleteFile(UsdMultiFileGlobalState &gstate) {
+    if (file_index != DConstants::INVALID_INDEX) {
+        gstate.tracker.FileCompleted(file_index, file_rows);
+    }
+    file_rows = 0;
+    // Prims skipped after the last chunk of the file
+    gstate.tracker.Flush(profile);
+}
+
+void UsdMultiFileLocalState::FinalizeChunk(UsdMultiFileGlobalState &gstate, DataChunk &output,
+                                           const vector<std::string> &files) {
+    file_rows += output.size();
+    gstate.tracker.AddRows(output.size());
+    gstate.projection.FinalizeChunk(output, files[file_index]);
+    profile.Enter(UsdScanPhase::NONE);
+    profile.CountStrings(output);
+    gstate.tracker.Flush(profile);
+}
+
+OperatorPartitionData UsdMultiFileLocalState::GetPartitionData(ClientContext &context,
+                                                               TableFunctionGetPartitionInput &input) {
+    if (input.partition_info.RequiresPartitionColumns()) {
+        throw InternalException("USD scans do not support partition columns");
+    }
+    auto &lstate = input.local_state->Cast<UsdMultiFileLocalState>();
+    return OperatorPartitionData(lstate.file_index);
+}
+
+UsdColumnProjection::UsdColumnProjection(const vector<column_t> &column_ids, idx_t column_count)
+    : output_index_(column_count, DConstants::INVALID_INDEX) {
+    for (idx_t i = 0; i < column_ids.size(); i++) {
+        if (column_ids[i] < column_count) {
+            output_index_[column_ids[i]] = i;
+        } else if (column_ids[i] == UsdFileList::FILENAME_COLUMN) {
+            filename_output_ = i;
+        } else {
+            virtual_outputs_.push_back(i);
+        }
+    }
+}
+
+void UsdColumnProjection::FinalizeChunk(DataChunk &output, const std::string &file_path) const {
+    if (filename_output_ != DConstants::INVALID_INDEX) {
+        // Chunks never span files: one constant per chunk
+        auto &filename = output.data[filename_output_];
+        filename.SetVectorType(VectorType::CONSTANT_VECTOR);
+        ConstantVector::GetData<string_t>(filename)[0] = StringVector::AddString(filename, file_path);
+    }
+    for (auto index : virtual_outputs_) {
+        output.data[index].SetVectorType(VectorType::CONSTANT_VECTOR);
+        ConstantVector::SetNull(output.data[index], true);
+    }
+}
+
+// Entries a dictionary holds before a new one is started. A chunk adds at
+// most STANDARD_VECTOR_SIZE entries, so one that starts below
+// DICTIONARY_CAPACITY - STANDARD_VECTOR_SIZE entries always fits.
+static constexpr idx_t DICTIONARY_CAPACITY = 4 * STANDARD_VECTOR_SIZE;
+
+UsdTokenDictionary::UsdTokenDictionary() : sel_(STANDARD_VECTOR_SIZE) {}
+
+void UsdTokenDictionary::Select(idx_t row, const pxr::TfToken &token, const std::string &empty_text) {
+    if (!entries_ || (row == 0 && entry_count_ > DICTIONARY_CAPACITY - STANDARD_VECTOR_SIZE)) {
+        // Chunks already emitted keep referencing the previous dictionary
+        entries_ = make_uniq<Vector>(LogicalType::VARCHAR, DICTIONARY_CAPACITY);
+        entry_count_ = 0;
+        index_.clear();
+        entry_generation_.assign(DICTIONARY_CAPACITY, 0);
+    }
+    auto entry = index_.find(token);
+    if (entry == index_.end()) {
+        const auto &text = token.IsEmpty() ? empty_text : token.GetString();
+        FlatVector::GetData<string_t>(*entries_)[entry_count_] = StringVector::AddString(*entries_, text);
+        entry = index_.emplace(token, UnsafeNumericCast<uint32_t>(entry_count_++)).first;
+    }
+    if (entry_generation_[entry->second] != generation_) {
+        entry_generation_[entry->second] = generation_;
+        selected_.push_back(token);
+    }
+    sel_.set_index(row, entry->second);
+}
+
+std::vector<pxr::TfToken> UsdTokenDictionary::TakeSelectedTokens() {
+    generation_++;
+    std::vector<pxr::TfToken> result;
+    std::swap(result, selected_);
+    return result;
+}
+
+void UsdTokenDictionary::Finalize(Vector &result, idx_t count) {
+    if (count == 0) {
+        return;
+    }
+    result.Dictionary(*entries_, entry_count_, sel_, count);
+    // The emitted vector shares the selection buffer: the next chunk gets its own
+    sel_.Initialize(STANDARD_VECTOR_SIZE);
+}
+
+// Holds a reference to a stage for as long as a vector's strings point into it
+struct UsdStageStringBuffer : public VectorBuffer {
+    explicit UsdStageStringBuffer(pxr::UsdStageRefPtr stage_p)
+        : VectorBuffer(VectorBufferType::OPAQUE_BUFFER), stage(std::move(stage_p)) {}
+
+    pxr::UsdStageRefPtr stage;
+};
+
+void UsdKeepStageAlive(Vector &vector, const pxr::UsdStageRefPtr &stage) {
+    StringVector::AddBuffer(vector, make_buffer<UsdStageStringBuffer>(stage));
+}
+
+// Resolves expr to a table column of the scan bound to get
+static bool GetScanColumn(LogicalGet &get, const Expression &expr, idx_t &column) {
+    if (expr.GetExpressionClass() != ExpressionClass::BOUND_COLUMN_REF) {
+        return false;
+    }
+    auto &colref = expr.Cast<BoundColumnRefExpression>();
+    if (colref.binding.table_index != get.table_index) {
+        return false;
+    }
+    auto &column_ids = get.GetColumnIds();
+    if (colref.binding.column_index >= column_ids.size()) {
+        return false;
+    }
+    column = column_ids[colref.binding.column_index].GetPrimaryIndex();
+    return true;
+}
+
+static bool GetStringConstant(const Expression &expr, std::string &result) {
+    if (expr.GetExpressionClass() != ExpressionClass::BOUND_CONSTANT) {
+        return false;
+    }
+    auto &value = expr.Cast<BoundConstantExpression>().value;
+    if (value.IsNull() || value.type().id() != LogicalTypeId::VARCHAR) {
+        return false;
+    }
+    result = StringValue::Get(value);
+    return true;
+}
+
+// Literal prefix of a LIKE pattern, up to the first wildcard or escape
+static std::string LikePatternPrefix(const std::string &pattern) {
+    auto end = pattern.find_first_of("%_\\");
+    return end == std::string::npos ? pattern : pattern.substr(0, end);
+}
+
+// Conjuncts on the same column all have to hold, so the longer prefix wins
+static void AddPathPrefix(UsdScanFilter &filter, const std::string &prefix, bool exact) {
+    if (prefix.empty() || prefix[0] != '/') {
+        return;
+    }
+    if (filter.exact_path) {
+        return;
+    }
+    if (exact || prefix.size() > filter.path_prefix.size()) {
+        filter.path_prefix = prefix;
+        filter.exact_path = exact;
+    }
+}
+
+// prim_type and kind filters compare against the values usd_prims emits
+static pxr::TfToken ColumnValueToToken(idx_t column, const UsdFilterColumns &columns, const std::string &value) {
+    if (column == columns.prim_type && value == "<undefined>") {
+        return pxr::TfToken();
+    }
+    return pxr::TfToken(value);
+}
+
+// Adds the accepted values of an equality or IN filter on a token column.
+// Repeated conjuncts on the same column intersect.
+static void AddTokenValues(std::vector<pxr::TfToken> &accepted, std::vector<pxr::TfToken> values) {
+    if (!accepted.empty()) {
+        std::vector<pxr::TfToken> intersection;
+        for (auto &value : values) {
+            if (std::find(accepted.begin(), accepted.end(), value) != accepted.end()) {
+                intersection.push_back(value);
+            }
+        }
+        values = std::move(intersection);
+        if (values.empty()) {
+            // Contradictory filters; keep a token no prim or property can have
+            values.emplace_back("<none>");
+        }
+    }
+    accepted = std::move(values);
+}
+
+void UsdScanFilter::Pushdown(LogicalGet &get, const vector<unique_ptr<Expression>> &filters,
+                             const UsdFilterColumns &columns) {
+    for (auto &filter : filters) {
+        idx_t column;
+        std::string constant;
+        std::vector<std::string> values;
+        bool is_prefix = false;
+
+        switch (filter->GetExpressionClass()) {
+        case ExpressionClass::BOUND_COMPARISON: {
+            // column = 'constant' (either side)
+            auto &comparison = filter->Cast<BoundComparisonExpression>();
+            if (comparison.GetExpressionType() != ExpressionType::COMPARE_EQUAL) {
+                continue;
+            }
+            if (GetScanColumn(get, *comparison.left, column) && GetStringConstant(*comparison.right, constant)) {
+                values.push_back(constant);
+            } else if (GetScanColumn(get, *comparison.right, column) && GetStringConstant(*comparison.left, constant)) {
+                values.push_back(constant);
+            }
+            break;
+        }
+        case ExpressionClass::BOUND_OPERATOR: {
+            // column IN ('a', 'b', ...)
+            auto &op = filter->Cast<BoundOperatorExpression>();
+            if (op.GetExpressionType() != ExpressionType::COMPARE_IN || op.children.size() < 2 ||
+                !GetScanColumn(get, *op.children[0], column)) {
+                continue;
+            }
+            for (idx_t i = 1; i < op.children.size(); i++) {
+                if (!GetStringConstant(*op.children[i], constant)) {
+                    values.clear();
+                    break;
+                }
+                values.push_back(constant);
+            }
+            break;
+        }
+        case ExpressionClass::BOUND_FUNCTION: {
+            // prefix(column, 'p'), starts_with(column, 'p') and column LIKE 'p%'
+            auto &function = filter->Cast<BoundFunctionExpression>();
+            auto &name = function.function.name;
+            if (function.children.size() != 2 || !GetScanColumn(get, *function.children[0], column) ||
+                !GetStringConstant(*function.children[1], constant)) {
+                continue;
+            }
+            if (name == "prefix" || name == "starts_with") {
+                values.push_back(constant);
+            } else if (name == "~~" || name == "like") {
+                values.push_back(LikePatternPrefix(constant));
+            } else {
+                continue;
+            }
+            is_prefix = true;
+            break;
+        }
+        default:
+            continue;
+        }
+        if (values.empty()) {
+            continue;
+        }
+
+        if (column == columns.prim_path) {
+            // A single value is a path constraint; IN lists are left to DuckDB
+            if (values.size() == 1) {
+                AddPathPrefix(*this, values[0], !is_prefix);
+            }
+        } else if (is_prefix) {
+            // Prefix matches on token columns are not used for pruning
+            continue;
+        } else if (column == columns.prim_type || column == columns.kind || column == columns.property_name) {
+            std::vector<pxr::TfToken> tokens;
+            for (auto &value : values) {
+                tokens.push_back(ColumnValueToToken(column, columns, value));
+            }
+            auto &accepted =
+                column == columns.prim_type ? prim_types : column == columns.kind ? kinds : property_names;
+            AddTokenValues(accepted, std::move(tokens));
+        }
+    }
+}
+
+pxr::SdfPath UsdScanFilter::TraversalRoot() const {
+    if (path_prefix.empty()) {
+        return pxr::SdfPath::AbsoluteRootPath();
+    }
+    std::string root;
+    if (exact_path) {
+        root = path_prefix;
+    } else if (path_prefix.back() == '/') {
+        // '/World/Rack42/' only matches descendants of /World/Rack42
+        root = path_prefix.substr(0, path_prefix.size() - 1);
+    } else {
+        // '/World/Rack4' also matches siblings such as /World/Rack40
+        root = path_prefix.substr(0, path_prefix.rfind('/'));
+    }
+    if (root.empty() || !pxr::SdfPath::IsValidPathString(root)) {
+        return pxr::SdfPath::AbsoluteRootPath();
+    }
+    pxr::SdfPath path(root);
+    return path.IsPrimPath() ? path : pxr::SdfPath::AbsoluteRootPath();
+}
+
+bool UsdScanFilter::MayContainMatches(const pxr::SdfPath &path) const {
+    if (path_prefix.empty()) {
+        return true;
+    }
+    const auto &path_str = path.GetString();
+    if (exact_path ? path_str == path_prefix : pxr::TfStringStartsWith(path_str, path_prefix)) {
+        // For prefix filters every descendant of a matching prim matches too
+        return true;
+    }
+    // Otherwise descendants can only match if the prefix continues below path
+    if (!pxr::TfStringStartsWith(path_prefix, path_str)) {
+        return false;
+    }
+    return path.IsAbsoluteRootPath() || path_prefix[path_str.size()] == '/';
+}
+
+bool UsdScanFilter::Matches(const pxr::UsdPrim &prim) const {
+    if (!path_prefix.empty()) {
+        const auto &path_str = prim.GetPath().GetString();
+        if (exact_path ? path_str != path_prefix : !pxr::TfStringStartsWith(path_str, path_prefix)) {
+            return false;
+        }
+    }
+    if (!prim_types.empty() &&
+        std::find(prim_types.begin(), prim_types.end(), prim.GetTypeName()) == prim_types.end()) {
+        return false;
+    }
+    if (!kinds.empty()) {
+        pxr::TfToken kind;
+        pxr::UsdModelAPI(prim).GetKind(&kind);
+        if (std::find(kinds.begin(), kinds.end(), kind) == kinds.end()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Sorts names the way UsdPrim::GetProperties() orders properties
+static std::vector<pxr::TfToken> SortedNames(std::vector<pxr::TfToken> names) {
+    std::sort(names.begin(), names.end(), [](const pxr::TfToken &a, const pxr::TfToken &b) {
+        return pxr::TfDictionaryLessThan()(a.GetString(), b.GetString());
+    });
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    return names;
+}
+
+std::vector<pxr::UsdProperty> UsdScanFilter::GetProperties(const pxr::UsdPrim &prim) const {
+    if (property_names.empty()) {
+        return prim.GetProperties();
+    }
+    std::vector<pxr::UsdProperty> result;
+    for (const auto &name : SortedNames(property_names)) {
+        auto prop = prim.GetProperty(name);
+        if (prop) {
+            result.push_back(prop);
+        }
+    }
+    return result;
+}
+
+std::vector<pxr::UsdRelationship> UsdScanFilter::GetRelationships(const pxr::UsdPrim &prim) const {
+    if (property_names.empty()) {
+        return prim.GetRelationships();
+    }
+    std::vector<pxr::UsdRelationship> result;
+    for (const auto &name : SortedNames(property_names)) {
+        auto rel = prim.GetRelationship(name);
+        if (rel) {
+            result.push_back(rel);
+        }
+    }
+    return result;
+}
+
+void UsdScanFilter::BindTraversal(const std::string &function_name, const named_parameter_map_t &named_parameters) {
+    auto entry = named_parameters.find("traversal");
+    if (entry == named_parameters.end() || entry->second.IsNull()) {
+        return;
+    }
+    auto mode = StringUtil::Lower(entry->second.ToString());
+    if (mode == "default") {
+        traversal = UsdTraversalMode::DEFAULT;
+    } else if (mode == "all") {
+        traversal = UsdTraversalMode::ALL;
+    } else if (mode == "instance_proxies") {
+        traversal = UsdTraversalMode::INSTANCE_PROXIES;
+    } else if (mode == "prototypes_only") {
+        traversal = UsdTraversalMode::PROTOTYPES_ONLY;
+    } else {
+        throw BinderException(function_name +
+                              ": traversal must be 'default', 'all', 'instance_proxies' or 'prototypes_only', got '" +
+                              entry->second.ToString() + "'");
+    }
+}
+
+void UsdScanFilter::RegisterParameters(TableFunction &func) {
+    func.named_parameters["traversal"] = LogicalType::VARCHAR;
+}
+
+pxr::Usd_PrimFlagsPredicate UsdScanFilter::TraversalPredicate() const {
+    switch (traversal) {
+    case UsdTraversalMode::ALL:
+        return pxr::UsdPrimAllPrimsPredicate;
+    case UsdTraversalMode::INSTANCE_PROXIES:
+        return pxr::UsdTraverseInstanceProxies(pxr::UsdPrimDefaultPredicate);
+    default:
+        return pxr::UsdPrimDefaultPredicate;
+    }
+}
+
+static void CollectTraversalRoots(const pxr::UsdPrim &prim, idx_t depth, idx_t max_depth, const UsdScanFilter &filter,
+                                  std::vector<UsdTraversalRoot> &roots, idx_t &subtrees) {
+    if (!filter.MayContainMatches(prim.GetPath())) {
+        return;
+    }
+    if (depth == max_depth) {
+        roots.push_back({prim.GetPath(), true});
+        subtrees++;
+        return;
+    }
+    roots.push_back({prim.GetPath(), false});
+    for (const auto &child : prim.GetFilteredChildren(filter.TraversalPredicate())) {
+        CollectTraversalRoots(child, depth + 1, max_depth, filter, roots, subtrees);
+    }
+}
+
+// Resolves the root prim of a filtered traversal. Returns an invalid prim when
+// the root does not exist or is excluded by the traversal predicate, in which
+// case nothing under it can be visited.
+static pxr::UsdPrim GetFilteredRoot(const pxr::UsdStageRefPtr &stage, const UsdScanFilter &filter) {
+    auto root = stage->GetPrimAtPath(filter.TraversalRoot());
+    if (!root || root.IsPseudoRoot() || filter.TraversalPredicate()(root)) {
+        return root;
+    }
+    return pxr::UsdPrim();
+}
+
+// Top-level prims of a traversal: the prototypes, or the children of the
+// filtered root (or the root itself)
+static std::vector<pxr::UsdPrim> GetTraversalTops(const pxr::UsdStageRefPtr &stage, const UsdScanFilter &filter) {
+    std::vector<pxr::UsdPrim> result;
+    if (filter.traversal == UsdTraversalMode::PROTOTYPES_ONLY) {
+        for (const auto &prototype : stage->GetPrototypes()) {
+            if (filter.MayContainMatches(prototype.GetPath())) {
+                result.push_back(prototype);
+            }
+        }
+        return result;
+    }
+    auto root = GetFilteredRoot(stage, filter);
+    if (root && root.IsPseudoRoot()) {
+        for (const auto &child : root.GetFilteredChildren(filter.TraversalPredicate())) {
+            result.push_back(child);
+        }
+    } else if (root) {
+        result.push_back(root);
+    }
+    return result;
+}
+
+UsdTraversalPartition UsdTraversalPartition::Build(const pxr::UsdStageRefPtr &stage, idx_t partition_depth,
+                                                   idx_t target_units, const UsdScanFilter &filter) {
+    UsdTraversalPartition result;
+    auto top_level = GetTraversalTops(stage, filter);
+
+    idx_t min_depth = partition_depth > 0 ? partition_depth : 1;
+    idx_t max_depth = partition_depth > 0 ? partition_depth : MAX_AUTO_DEPTH;
+    for (idx_t depth = min_depth; depth <= max_depth; depth++) {
+        idx_t subtrees = 0;
+        result.roots.clear();
+        for (const auto &prim : top_level) {
+            CollectTraversalRoots(prim, 1, depth, filter, result.roots, subtrees);
+        }
+        // Stop once every thread can get work, or when the hierarchy is
+        // shallower than depth and splitting further cannot help
+        if (subtrees >= target_units || subtrees == 0) {
+            break;
+        }
+    }
+
+    // Group consecutive roots so that tiny subtrees do not become one-row chunks
+    idx_t unit_count = MinValue<idx_t>(MaxValue<idx_t>(target_units, 1), result.roots.size());
+    idx_t unit_size = unit_count == 0 ? 0 : (result.roots.size() + unit_count - 1) / unit_count;
+    for (idx_t offset = 0; offset < result.roots.size(); offset += unit_size) {
+        result.unit_offsets.push_back(offset);
+    }
+    result.unit_offsets.push_back(result.roots.size());
+    return result;
+}
+
 UsdPrimIterator::UsdPrimIterator(pxr::UsdStageRefPtr stage) 
     : stage_(stage), range_(stage->Traverse()) {
     current_ = range_.begin();
     end_ = range_.end();
 }
 
+UsdPrimIterator::UsdPrimIterator(pxr::UsdStageRefPtr stage, const UsdScanFilter &filter, UsdScanProfile *profile)
+    : stage_(stage), filter_(&filter), profile_(profile) {
+    if (filter.traversal == UsdTraversalMode::PROTOTYPES_ONLY) {
+        // Each prototype in turn
+        roots_ = GetTraversalTops(stage, filter);
+    } else {
+        auto root = GetFilteredRoot(stage, filter);
+        if (root && !root.IsPseudoRoot()) {
+            range_ = pxr::UsdPrimRange(root, filter.TraversalPredicate());
+        } else if (root) {
+            range_ = stage->Traverse(filter.TraversalPredicate());
+        }
+    }
+    // A default-constructed range is empty
+    current_ = range_.begin();
+    end_ = range_.end();
+    SkipToMatch();
+}
+
+// The caller keeps the stage of root alive for the lifetime of the iterator
+UsdPrimIterator::UsdPrimIterator(const pxr::UsdPrim &root, bool descend, const UsdScanFilter *filter,
+                                 UsdScanProfile *profile)
+    : descend_(descend), filter_(filter), profile_(profile) {
+    range_ = filter ? pxr::UsdPrimRange(root, filter->TraversalPredicate()) : pxr::UsdPrimRange(root);
+    current_ = range_.begin();
+    end_ = range_.end();
+    SkipToMatch();
+}
+
+void UsdPrimIterator::SkipToMatch() {
+    while (true) {
+        if (current_ == end_) {
+            if (next_root_ >= roots_.size()) {
+                return;
+            }
+            range_ = pxr::UsdPrimRange(roots_[next_root_++], filter_->TraversalPredicate());
+            current_ = range_.begin();
+            end_ = range_.end();
+            continue;
+        }
+        if (!filter_) {
+            return;
+        }
+        auto prim = *current_;
+        if (descend_ && !filter_->MayContainMatches(prim.GetPath())) {
+            // Neither this prim nor anything below it can match
+            if (profile_) {
+                profile_->prims_visited++;
+                profile_->prims_pruned++;
+            }
+            current_.PruneChildren();
+            ++current_;
+            continue;
+        }
+        if (filter_->Matches(prim)) {
+            return;
+        }
+        if (profile_) {
+            // Matches are counted when returned by GetNext
+            profile_->prims_visited++;
+        }
+        if (!descend_) {
+            current_ = end_;
+            return;
+        }
+        ++current_;
+    }
+}
+
 bool UsdPrimIterator::HasNext() const {
     return current_ != end_;
 }
@@ -59,12 +1446,26 @@ pxr::UsdPrim UsdPrimIterator::GetNext() {
     }
     
     auto prim = *current_;
-    ++current_;
+    if (profile_) {
+        profile_->prims_visited++;
+    }
+    if (descend_) {
+        ++current_;
+        SkipToMatch();
+    } else {
+        current_ = end_;
+    }
     return prim;
 }
 
 void UsdPrimIterator::Reset() {
+    if (!roots_.empty()) {
+        range_ = pxr::UsdPrimRange();
+        next_root_ = 0;
+    }
     current_ = range_.begin();
+    end_ = range_.end();
+    SkipToMatch();
 }
 
 } // namespace duckdb
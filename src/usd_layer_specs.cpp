@@ -0,0 +1,332 @@
+#include "usd_layer_specs.hpp"
+#include "usd_crate.hpp"
+#include "usd_helpers.hpp"
+#include "usd_values.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/sdf/schema.h>
+#include <pxr/usd/sdf/types.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <algorithm>
+
+namespace duckdb {
+
+// Table columns, in schema order
+static constexpr idx_t COL_SPEC_PATH = 0;
+static constexpr idx_t COL_SPEC_TYPE = 1;
+static constexpr idx_t COL_PARENT_PATH = 2;
+static constexpr idx_t COL_SPECIFIER = 3;
+static constexpr idx_t COL_TYPE_NAME = 4;
+static constexpr idx_t COL_FIELDS = 5;
+static constexpr idx_t COLUMN_COUNT = 6;
+// Rows per root layer spec, for estimates before the first complete scan
+static constexpr double ROWS_PER_SPEC = 1.0;
+
+// Bind data structure
+struct UsdLayerSpecsBindData : public TableFunctionData {
+    // Files to scan (a path, the matches of a glob, or a list)
+    vector<std::string> files;
+    // Path predicates pushed down from the query
+    UsdScanFilter filter;
+    // Row estimate for the planner and the progress bar
+    UsdScanEstimate estimate;
+
+    explicit UsdLayerSpecsBindData(vector<std::string> files_p) : files(std::move(files_p)) {}
+};
+
+// Crate files whose fields are not needed are read by UsdCrateReader
+static bool MayBeCrateFile(const std::string &file_path) {
+    auto lower = StringUtil::Lower(file_path);
+    return StringUtil::EndsWith(lower, ".usdc") || StringUtil::EndsWith(lower, ".usd");
+}
+
+// Per-thread cursor into the layer currently being scanned. Only the layer is
+// read: no stage, PcpCache or composed prim is ever built. Unless the fields
+// column is projected, crate files are not even decoded into an SdfLayer:
+// their specs are streamed from the structural sections of the file.
+struct UsdLayerSpecsLocalState : public UsdMultiFileLocalState {
+    unique_ptr<UsdCrateReader> crate;
+    pxr::SdfLayerRefPtr layer;
+    // Spec paths of layer, sorted so that parents precede their children
+    std::vector<pxr::SdfPath> specs;
+    idx_t spec_count = 0;
+    idx_t spec_index = 0;
+
+    // Claims the next file and lists its specs
+    bool NextFile(ClientContext &context, UsdMultiFileGlobalState &gstate, const UsdLayerSpecsBindData &bind_data) {
+        crate.reset();
+        layer = nullptr;
+        specs.clear();
+        spec_count = 0;
+        spec_index = 0;
+        CompleteFile(gstate);
+        auto file = gstate.next_file++;
+        if (file >= gstate.file_count) {
+            return false;
+        }
+        file_index = file;
+        const auto &file_path = bind_data.files[file];
+        const auto &projection = gstate.projection;
+        // Reading the layer is this scan's open phase
+        profile.timing = gstate.tracker.Timing();
+        profile.Enter(UsdScanPhase::OPEN);
+
+        if (!projection.IsProjected(COL_FIELDS) && MayBeCrateFile(file_path)) {
+            // Decode only the sections the projected columns need
+            uint8_t sections = 0;
+            if (projection.IsProjected(COL_SPEC_PATH) || projection.IsProjected(COL_PARENT_PATH)) {
+                sections |= UsdCrateReader::CRATE_PATHS;
+            }
+            if (projection.IsProjected(COL_SPECIFIER) || projection.IsProjected(COL_TYPE_NAME)) {
+                sections |= UsdCrateReader::CRATE_FIELDS;
+            }
+            crate = UsdCrateReader::TryOpen(context, file_path, sections);
+            if (crate) {
+                spec_count = crate->SpecCount();
+                profile.prims_visited += spec_count;
+                return true;
+            }
+        }
+
+        layer = UsdStageManager::OpenLayer(context, file_path);
+        // Only the subtree that can satisfy the path filters is visited
+        profile.Enter(UsdScanPhase::TRAVERSE);
+        auto root = bind_data.filter.TraversalRoot();
+        if (layer->HasSpec(root)) {
+            layer->Traverse(root, [this](const pxr::SdfPath &path) { specs.push_back(path); });
+        }
+        std::sort(specs.begin(), specs.end());
+        spec_count = specs.size();
+        profile.prims_visited += spec_count;
+        return true;
+    }
+};
+
+static const char *SpecTypeName(pxr::SdfSpecType spec_type) {
+    switch (spec_type) {
+    case pxr::SdfSpecTypePseudoRoot:
+        return "pseudoRoot";
+    case pxr::SdfSpecTypePrim:
+        return "prim";
+    case pxr::SdfSpecTypeAttribute:
+        return "attribute";
+    case pxr::SdfSpecTypeRelationship:
+        return "relationship";
+    case pxr::SdfSpecTypeConnection:
+        return "connection";
+    case pxr::SdfSpecTypeRelationshipTarget:
+        return "relationshipTarget";
+    case pxr::SdfSpecTypeVariantSet:
+        return "variantSet";
+    case pxr::SdfSpecTypeVariant:
+        return "variant";
+    case pxr::SdfSpecTypeMapper:
+        return "mapper";
+    case pxr::SdfSpecTypeMapperArg:
+        return "mapperArg";
+    case pxr::SdfSpecTypeExpression:
+        return "expression";
+    default:
+        return "unknown";
+    }
+}
+
+static const char *SpecifierName(pxr::SdfSpecifier specifier) {
+    switch (specifier) {
+    case pxr::SdfSpecifierDef:
+        return "def";
+    case pxr::SdfSpecifierOver:
+        return "over";
+    case pxr::SdfSpecifierClass:
+        return "class";
+    default:
+        return "unknown";
+    }
+}
+
+// Child lists (primChildren, properties, variantChildren, ...) restate the
+// spec tree that the rows already enumerate
+static bool IsChildrenField(const pxr::TfToken &field) {
+    return pxr::TfStringEndsWith(field.GetString(), "Children");
+}
+
+// Bind function
+static unique_ptr<FunctionData> UsdLayerSpecsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                  vector<LogicalType> &return_types, vector<string> &names) {
+    // Validate input
+    if (input.inputs.size() != 1) {
+        throw BinderException("usd_layer_specs requires exactly one argument: file_path");
+    }
+
+    // One path, a glob pattern or a list of either
+    auto files = UsdFileList::Bind(context, "usd_layer_specs", input.inputs[0]);
+
+    // Define output schema
+    names = {"spec_path", "spec_type", "parent_path", "specifier", "type_name", "fields"};
+    return_types = {LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR,
+                    LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR,
+                    LogicalType::MAP(LogicalType::VARCHAR, LogicalType::VARCHAR)};
+
+    auto result = make_uniq<UsdLayerSpecsBindData>(std::move(files));
+    result->estimate = UsdScanStatistics::Estimate(context, "usd_layer_specs", result->files, ROWS_PER_SPEC,
+                                                   input.named_parameters.empty(), COLUMN_COUNT);
+    return std::move(result);
+}
+
+// Init function
+static unique_ptr<GlobalTableFunctionState> UsdLayerSpecsInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<UsdLayerSpecsBindData>();
+    auto state = make_uniq<UsdMultiFileGlobalState>(bind_data.files.size());
+    state->projection = UsdColumnProjection(input.column_ids, COLUMN_COUNT);
+    state->tracker.Start(context, bind_data.estimate, bind_data.filter.IsEmpty());
+    return std::move(state);
+}
+
+// Each thread reads the layers of the files it claims
+static unique_ptr<LocalTableFunctionState> UsdLayerSpecsInitLocal(ExecutionContext &context,
+                                                                  TableFunctionInitInput &input,
+                                                                  GlobalTableFunctionState *global_state) {
+    return make_uniq<UsdLayerSpecsLocalState>();
+}
+
+static void SetStringOrNull(Vector &vector, idx_t row, bool valid, const std::string &value) {
+    if (valid) {
+        FlatVector::GetData<string_t>(vector)[row] = StringVector::AddString(vector, value);
+    } else {
+        FlatVector::SetNull(vector, row, true);
+    }
+}
+
+// Writes the authored fields of the spec at path as row of the fields map
+static void WriteFields(const pxr::SdfLayerRefPtr &layer, const pxr::SdfPath &path, Vector &fields_out, idx_t row) {
+    auto fields = layer->ListFields(path);
+    auto offset = ListVector::GetListSize(fields_out);
+    ListVector::Reserve(fields_out, offset + fields.size());
+    auto &keys = MapVector::GetKeys(fields_out);
+    auto &values = MapVector::GetValues(fields_out);
+    auto key_data = FlatVector::GetData<string_t>(keys);
+    auto value_data = FlatVector::GetData<string_t>(values);
+
+    idx_t length = 0;
+    for (const auto &field : fields) {
+        if (IsChildrenField(field)) {
+            continue;
+        }
+        key_data[offset + length] = StringVector::AddString(keys, field.GetString());
+        value_data[offset + length] =
+            StringVector::AddString(values, UsdValueDispatch::FormatValue(layer->GetField(path, field)));
+        length++;
+    }
+    FlatVector::GetData<list_entry_t>(fields_out)[row] = list_entry_t(offset, length);
+    ListVector::SetListSize(fields_out, offset + length);
+}
+
+// Execute function
+static void UsdLayerSpecsExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &bind_data = data_p.bind_data->Cast<UsdLayerSpecsBindData>();
+    auto &gstate = data_p.global_state->Cast<UsdMultiFileGlobalState>();
+    auto &state = data_p.local_state->Cast<UsdLayerSpecsLocalState>();
+    auto &projection = gstate.projection;
+
+    // Only projected columns are computed; unprojected ones get nullptr
+    auto spec_path_out = projection.GetVector(output, COL_SPEC_PATH);
+    auto spec_type_out = projection.GetVector(output, COL_SPEC_TYPE);
+    auto parent_path_out = projection.GetVector(output, COL_PARENT_PATH);
+    auto specifier_out = projection.GetVector(output, COL_SPECIFIER);
+    auto type_name_out = projection.GetVector(output, COL_TYPE_NAME);
+    auto fields_out = projection.GetVector(output, COL_FIELDS);
+
+    idx_t count = 0;
+    std::string text;
+    while (count < STANDARD_VECTOR_SIZE) {
+        // A chunk never spans two files
+        if (state.spec_index >= state.spec_count) {
+            if (count > 0 || !state.NextFile(context, gstate, bind_data)) {
+                break;
+            }
+            continue;
+        }
+        state.profile.Enter(UsdScanPhase::EMIT);
+        auto spec = state.spec_index++;
+        const auto &crate = state.crate;
+        const auto &layer = state.layer;
+        auto spec_type = crate ? crate->GetSpecType(spec) : layer->GetSpecType(state.specs[spec]);
+
+        if (spec_path_out) {
+            text = crate ? crate->GetSpecPath(spec) : state.specs[spec].GetString();
+            FlatVector::GetData<string_t>(*spec_path_out)[count] = StringVector::AddString(*spec_path_out, text);
+        }
+        if (spec_type_out) {
+            FlatVector::GetData<string_t>(*spec_type_out)[count] =
+                StringVector::AddString(*spec_type_out, SpecTypeName(spec_type));
+        }
+        if (parent_path_out) {
+            bool has_parent;
+            if (crate) {
+                has_parent = crate->GetParentPath(spec, text);
+            } else {
+                has_parent = !state.specs[spec].IsAbsoluteRootPath();
+                if (has_parent) {
+                    text = state.specs[spec].GetParentPath().GetString();
+                }
+            }
+            SetStringOrNull(*parent_path_out, count, has_parent, text);
+        }
+        if (specifier_out) {
+            pxr::SdfSpecifier specifier;
+            bool has_specifier = false;
+            if (spec_type == pxr::SdfSpecTypePrim) {
+                has_specifier = crate ? crate->GetSpecifier(spec, specifier)
+                                      : layer->HasField(state.specs[spec], pxr::SdfFieldKeys->Specifier, &specifier);
+            }
+            SetStringOrNull(*specifier_out, count, has_specifier, has_specifier ? SpecifierName(specifier) : "");
+        }
+        if (type_name_out) {
+            // Schema type of prims, value type of attributes
+            bool has_type_name;
+            if (crate) {
+                has_type_name = crate->GetTypeName(spec, text);
+            } else {
+                pxr::TfToken type_name;
+                has_type_name = layer->HasField(state.specs[spec], pxr::SdfFieldKeys->TypeName, &type_name) &&
+                                !type_name.IsEmpty();
+                text = type_name.GetString();
+            }
+            SetStringOrNull(*type_name_out, count, has_type_name, text);
+        }
+        if (fields_out) {
+            state.profile.Enter(UsdScanPhase::EXTRACT);
+            WriteFields(layer, state.specs[spec], *fields_out, count);
+        }
+        count++;
+    }
+
+    output.SetCardinality(count);
+    if (count > 0) {
+        state.FinalizeChunk(gstate, output, bind_data.files);
+    }
+}
+
+static void UsdLayerSpecsPushdownFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                        vector<unique_ptr<Expression>> &filters) {
+    auto &bind_data = bind_data_p->Cast<UsdLayerSpecsBindData>();
+    UsdFilterColumns columns;
+    columns.prim_path = COL_SPEC_PATH;
+    bind_data.filter.Pushdown(get, filters, columns);
+}
+
+// Get the table function
+TableFunction UsdLayerSpecsFunction::GetFunction() {
+    TableFunction func("usd_layer_specs", {LogicalTypeId::VARCHAR}, UsdLayerSpecsExecute, UsdLayerSpecsBind,
+                       UsdLayerSpecsInit, UsdLayerSpecsInitLocal);
+    func.get_partition_data = UsdMultiFileLocalState::GetPartitionData;
+    func.projection_pushdown = true;
+    UsdScanStatistics::Register<UsdLayerSpecsBindData, UsdMultiFileGlobalState>(func);
+    UsdFileList::RegisterFilenameColumn(func);
+    func.pushdown_complex_filter = UsdLayerSpecsPushdownFilter;
+    return func;
+}
+
+} // namespace duckdb
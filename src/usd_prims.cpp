@@ -2,59 +2,359 @@
 #include "usd_helpers.hpp"
 #include "duckdb/common/exception.hpp"
 #include "duckdb/common/string_util.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+#include "duckdb/storage/statistics/base_statistics.hpp"
 #include <pxr/usd/usd/stage.h>
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usd/modelAPI.h>
 #include <pxr/base/tf/token.h>
-#include <filesystem>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace duckdb {
 
-struct UsdPrimsBindData : public TableFunctionData {
-    std::string file_path;
+// Table columns, in schema order
+static constexpr idx_t COL_PRIM_PATH = 0;
+static constexpr idx_t COL_PARENT_PATH = 1;
+static constexpr idx_t COL_NAME = 2;
+static constexpr idx_t COL_PRIM_TYPE = 3;
+static constexpr idx_t COL_KIND = 4;
+static constexpr idx_t COL_ACTIVE = 5;
+static constexpr idx_t COL_INSTANCEABLE = 6;
+static constexpr idx_t COL_DEPTH = 7;
+static constexpr idx_t COL_SIBLING_INDEX = 8;
+static constexpr idx_t COL_PREORDER_ID = 9;
+static constexpr idx_t COL_POSTORDER_ID = 10;
+static constexpr idx_t COL_SUBTREE_SIZE = 11;
+static constexpr idx_t COL_IS_INSTANCE = 12;
+static constexpr idx_t COL_PROTOTYPE_PATH = 13;
+static constexpr idx_t COL_INSTANCE_COUNT = 14;
+static constexpr idx_t COLUMN_COUNT = 15;
+// Rows per root layer spec, for estimates before the first complete scan
+static constexpr double ROWS_PER_SPEC = 0.25;
+
+static const std::string UNDEFINED_TYPE = "<undefined>";
+
+using UsdTokenSet = std::unordered_set<pxr::TfToken, pxr::TfToken::HashFunctor>;
+
+// Position of every prim of a stage in a traversal mode, numbered in a
+// single pre- and post-order traversal and cached with the stage. Numbers
+// cover the whole stage, so they are the same whichever units, filters or
+// files a scan reads, and a prim d is a descendant of a exactly when
+// a.preorder_id < d.preorder_id < a.preorder_id + a.subtree_size. With
+// traversal := 'prototypes_only' the prototypes are numbered one after the
+// other as the children of the pseudo-root.
+class UsdPrimHierarchy : public UsdStageDerivedData {
+public:
+    struct Entry {
+        // 1 for the children of the pseudo-root
+        idx_t depth;
+        // Position among the traversed children of the parent
+        idx_t sibling_index;
+        idx_t preorder_id;
+        idx_t postorder_id;
+        // Prims in the subtree, the prim included
+        idx_t subtree_size;
+    };
+
+    static constexpr const char *DERIVED_DATA_NAME = "prim_hierarchy";
+
+    UsdPrimHierarchy(const pxr::UsdStageRefPtr &stage, const UsdScanFilter &filter) {
+        std::vector<pxr::UsdPrim> roots;
+        if (filter.traversal == UsdTraversalMode::PROTOTYPES_ONLY) {
+            roots = stage->GetPrototypes();
+        } else {
+            roots.push_back(stage->GetPseudoRoot());
+        }
+        // Open ancestors (by preorder id) and the children each has so far
+        std::vector<idx_t> open;
+        std::vector<idx_t> child_counts {0};
+        idx_t postorder = 0;
+        for (const auto &root : roots) {
+            Number(pxr::UsdPrimRange::PreAndPostVisit(root, filter.TraversalPredicate()), open, child_counts,
+                   postorder);
+        }
+    }
+
+    // Shared hierarchy of stage in the traversal of filter, built on first use
+    static std::shared_ptr<UsdPrimHierarchy> Get(ClientContext &context, const pxr::UsdStageRefPtr &stage,
+                                                 const UsdScanFilter &filter) {
+        auto name = std::string(DERIVED_DATA_NAME) + ":" + std::to_string(static_cast<int>(filter.traversal));
+        return UsdStageManager::GetDerivedData<UsdPrimHierarchy>(
+            context, stage, name, [&]() { return std::make_shared<UsdPrimHierarchy>(stage, filter); });
+    }
+
+    idx_t EstimatedSize() const override {
+        // Entries, plus roughly one hash node per path
+        return entries.size() * (sizeof(Entry) + 4 * sizeof(void *));
+    }
+
+    // Entry of the prim at path; nullptr for prims the traversal skips, such
+    // as instance proxies by default
+    const Entry *Find(const pxr::SdfPath &path) const {
+        auto entry = index_of.find(path);
+        return entry == index_of.end() ? nullptr : &entries[entry->second];
+    }
+
+private:
+    std::vector<Entry> entries;
+    std::unordered_map<pxr::SdfPath, idx_t, pxr::SdfPath::Hash> index_of;
+
+    void Number(const pxr::UsdPrimRange &range, std::vector<idx_t> &open, std::vector<idx_t> &child_counts,
+                idx_t &postorder) {
+        for (auto it = range.begin(); it != range.end(); ++it) {
+            if (it->IsPseudoRoot()) {
+                continue;
+            }
+            if (!it.IsPostVisit()) {
+                Entry entry;
+                entry.depth = open.size() + 1;
+                entry.sibling_index = child_counts.back()++;
+                entry.preorder_id = entries.size();
+                entry.postorder_id = 0;
+                entry.subtree_size = 1;
+                index_of.emplace(it->GetPath(), entries.size());
+                open.push_back(entries.size());
+                child_counts.push_back(0);
+                entries.push_back(entry);
+            } else {
+                auto &entry = entries[open.back()];
+                entry.postorder_id = postorder++;
+                entry.subtree_size = entries.size() - entry.preorder_id;
+                open.pop_back();
+                child_counts.pop_back();
+            }
+        }
+    }
+};
+
+// Root of the prototype prim shares: its own prototype for an instance, the
+// prototype of the enclosing instance for an instance proxy, and the
+// enclosing prototype for a prim inside one. Invalid for other prims.
+static pxr::UsdPrim GetPrototypeRoot(const pxr::UsdPrim &prim) {
+    if (prim.IsInstance()) {
+        return prim.GetPrototype();
+    }
+    auto current = prim.IsInstanceProxy() ? prim.GetPrimInPrototype() : prim;
+    if (!current.IsInPrototype()) {
+        return pxr::UsdPrim();
+    }
+    while (current && !current.IsPrototype()) {
+        current = current.GetParent();
+    }
+    return current;
+}
+
+// Whether the scan projects a column numbered by UsdPrimHierarchy
+static bool ProjectsHierarchy(const UsdColumnProjection &projection) {
+    for (auto col : {COL_DEPTH, COL_SIBLING_INDEX, COL_PREORDER_ID, COL_POSTORDER_ID, COL_SUBTREE_SIZE}) {
+        if (projection.IsProjected(col)) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    explicit UsdPrimsBindData(std::string path) : file_path(std::move(path)) {}
+struct UsdPrimsBindData : public TableFunctionData {
+    // Files to scan (a path, the matches of a glob, or a list)
+    vector<std::string> files;
+    // Population mask and payload loading requested with mask := / load :=
+    UsdStageLoadOptions load_options;
+    // Depth at which the traversal is split into work units (0 = automatic)
+    idx_t partition_depth = 0;
+    // Path, type and kind predicates pushed down from the query
+    UsdScanFilter filter;
+    // Row estimate and remembered distinct counts for the planner
+    UsdScanEstimate estimate;
+
+    explicit UsdPrimsBindData(vector<std::string> files_p) : files(std::move(files_p)) {}
 };
 
+// Work queue shared by all scanning threads. A single file is split into
+// subtree units of its stage; with several files every file is one unit and
+// each thread composes the stages of the files it claims.
 struct UsdPrimsGlobalState : public GlobalTableFunctionState {
+    // Stage and partition of a single-file scan
     pxr::UsdStageRefPtr stage;
-    std::unique_ptr<UsdPrimIterator> iterator;
+    UsdTraversalPartition partition;
+    idx_t file_count = 0;
+    std::atomic<idx_t> next_unit {0};
+    UsdColumnProjection projection;
+    UsdScanTracker tracker;
+    // Set when hierarchy columns are projected: stages are then composed
+    // whole (no mask derived from filters), so that numbers do not depend on
+    // the filters
+    bool hierarchy = false;
+    std::shared_ptr<UsdPrimHierarchy> single_file_hierarchy;
+    // Outcome of the completed units of a single-file scan, reported once
+    // every unit is complete
+    std::mutex completed_lock;
+    idx_t completed_units = 0;
+    idx_t completed_rows = 0;
+    UsdTokenSet completed_types;
+    UsdTokenSet completed_kinds;
 
     UsdPrimsGlobalState() = default;
-};
 
-static unique_ptr<FunctionData> UsdPrimsBind(ClientContext &context, TableFunctionBindInput &input,
-                                              vector<LogicalType> &return_types, vector<string> &names) {
-    // Expect one parameter: file path
-    if (input.inputs.size() != 1) {
-        throw BinderException("usd_prims requires exactly one argument: file_path");
+    bool IsMultiFile() const {
+        return file_count > 1;
     }
-    
-    if (input.inputs[0].type() != LogicalTypeId::VARCHAR) {
-        throw BinderException("usd_prims file_path must be a string");
+    idx_t UnitCount() const {
+        return IsMultiFile() ? file_count : partition.UnitCount();
     }
-    
-    auto file_path = input.inputs[0].ToString();
+    idx_t MaxThreads() const override {
+        return MaxValue<idx_t>(UnitCount(), 1);
+    }
+
+    // Records a unit scanned to its end with the prim types and kinds it
+    // produced (when those columns are projected)
+    void UnitCompleted(idx_t unit, idx_t rows, const std::vector<pxr::TfToken> &types,
+                       const std::vector<pxr::TfToken> &kinds) {
+        if (IsMultiFile()) {
+            ReportFile(unit, rows, UsdTokenSet(types.begin(), types.end()).size(),
+                       UsdTokenSet(kinds.begin(), kinds.end()).size());
+            return;
+        }
+        std::lock_guard<std::mutex> guard(completed_lock);
+        completed_rows += rows;
+        completed_types.insert(types.begin(), types.end());
+        completed_kinds.insert(kinds.begin(), kinds.end());
+        if (++completed_units == UnitCount()) {
+            ReportFile(0, completed_rows, completed_types.size(), completed_kinds.size());
+        }
+    }
+
+private:
+    void ReportFile(idx_t file, idx_t rows, idx_t type_count, idx_t kind_count) const {
+        // Paths are unique within a file
+        vector<idx_t> distinct(COLUMN_COUNT, 0);
+        distinct[COL_PRIM_PATH] = rows;
+        if (projection.IsProjected(COL_PRIM_TYPE)) {
+            distinct[COL_PRIM_TYPE] = type_count;
+        }
+        if (projection.IsProjected(COL_KIND)) {
+            distinct[COL_KIND] = kind_count;
+        }
+        tracker.FileCompleted(file, rows, distinct);
+    }
+};
+
+static UsdStageLoadOptions LoadOptions(const UsdPrimsGlobalState &gstate, const UsdPrimsBindData &bind_data) {
+    return gstate.hierarchy ? bind_data.load_options : bind_data.load_options.WithFilter(bind_data.filter);
+}
 
-    // Check for empty path
-    if (file_path.empty() || file_path.find_first_not_of(" \t\n\r") == std::string::npos) {
-        throw BinderException("usd_prims: file_path cannot be empty");
+// Per-thread cursor into the unit currently being scanned
+struct UsdPrimsLocalState : public LocalTableFunctionState {
+    idx_t unit_index = DConstants::INVALID_INDEX;
+    idx_t file_index = 0;
+    pxr::UsdStageRefPtr stage;
+    idx_t root_index = 0;
+    idx_t root_end = 0;
+    std::unique_ptr<UsdPrimIterator> iterator;
+    // Hierarchy numbers of stage, if projected
+    std::shared_ptr<UsdPrimHierarchy> hierarchy;
+    // Instances per prototype of stage, counted once per prototype
+    std::unordered_map<pxr::SdfPath, idx_t, pxr::SdfPath::Hash> instance_counts;
+    // Whether unit_index was claimed and not yet reported complete
+    bool in_unit = false;
+    idx_t unit_rows = 0;
+    // Dictionaries of the low-cardinality prim_type and kind columns
+    UsdTokenDictionary prim_types;
+    UsdTokenDictionary kinds;
+    // Counters and phase times of this thread, flushed after every chunk
+    UsdScanProfile profile;
+
+    // Advances to the next prim of the current unit; false when it is exhausted
+    bool NextPrim(UsdPrimsGlobalState &gstate, const UsdPrimsBindData &bind_data, pxr::UsdPrim &prim) {
+        profile.Enter(UsdScanPhase::TRAVERSE);
+        while (!iterator || !iterator->HasNext()) {
+            if (root_index >= root_end) {
+                return false;
+            }
+            auto &root = gstate.partition.roots[root_index++];
+            iterator = make_uniq<UsdPrimIterator>(stage->GetPrimAtPath(root.path), root.descend, &bind_data.filter,
+                                                  &profile);
+        }
+        prim = iterator->GetNext();
+        return true;
     }
 
-    // Check if file exists
-    if (!std::filesystem::exists(file_path)) {
-        throw BinderException("usd_prims: USD file not found: " + file_path);
+    // Claims the next unit from the shared queue
+    bool NextUnit(ClientContext &context, UsdPrimsGlobalState &gstate, const UsdPrimsBindData &bind_data) {
+        iterator.reset();
+        if (in_unit) {
+            // The previous unit was read to its end
+            gstate.UnitCompleted(unit_index, unit_rows, prim_types.TakeSelectedTokens(), kinds.TakeSelectedTokens());
+            in_unit = false;
+        }
+        unit_rows = 0;
+        // Prims skipped after the last chunk of the unit
+        gstate.tracker.Flush(profile);
+        auto unit = gstate.next_unit++;
+        if (unit >= gstate.UnitCount()) {
+            stage = nullptr;
+            return false;
+        }
+        unit_index = unit;
+        in_unit = true;
+        profile.timing = gstate.tracker.Timing();
+        if (gstate.IsMultiFile()) {
+            // The whole file, through the stage cache
+            file_index = unit;
+            profile.Enter(UsdScanPhase::OPEN);
+            stage = UsdStageManager::OpenStage(context, bind_data.files[unit], LoadOptions(gstate, bind_data),
+                                               &profile);
+            if (gstate.hierarchy) {
+                profile.Enter(UsdScanPhase::EXTRACT);
+                hierarchy = UsdPrimHierarchy::Get(context, stage, bind_data.filter);
+            }
+            instance_counts.clear();
+            profile.Enter(UsdScanPhase::TRAVERSE);
+            iterator = make_uniq<UsdPrimIterator>(stage, bind_data.filter, &profile);
+            root_index = root_end = 0;
+        } else {
+            if (stage != gstate.stage) {
+                instance_counts.clear();
+            }
+            stage = gstate.stage;
+            hierarchy = gstate.single_file_hierarchy;
+            root_index = gstate.partition.unit_offsets[unit];
+            root_end = gstate.partition.unit_offsets[unit + 1];
+        }
+        return true;
     }
+};
 
-    // Check if it's a directory
-    if (std::filesystem::is_directory(file_path)) {
-        throw BinderException("usd_prims: path is a directory, not a file: " + file_path);
+static unique_ptr<FunctionData> UsdPrimsBind(ClientContext &context, TableFunctionBindInput &input,
+                                              vector<LogicalType> &return_types, vector<string> &names) {
+    // Expect one parameter: file path
+    if (input.inputs.size() != 1) {
+        throw BinderException("usd_prims requires exactly one argument: file_path");
     }
 
-    // Validate USD file extension
-    if (!UsdStageManager::IsValidUsdFile(file_path)) {
-        throw BinderException("usd_prims: file must have a USD extension (.usd, .usda, .usdc, .usdz): " + file_path);
+    // One path, a glob pattern or a list of either
+    auto files = UsdFileList::Bind(context, "usd_prims", input.inputs[0]);
+
+    auto result = make_uniq<UsdPrimsBindData>(std::move(files));
+    for (auto &kv : input.named_parameters) {
+        if (kv.first == "partition_depth") {
+            auto depth = kv.second.GetValue<int64_t>();
+            if (depth < 0) {
+                throw BinderException("usd_prims: partition_depth must be non-negative");
+            }
+            result->partition_depth = NumericCast<idx_t>(depth);
+        }
     }
+    result->load_options.Bind("usd_prims", input.named_parameters);
+    result->filter.BindTraversal("usd_prims", input.named_parameters);
+    // partition_depth does not change the rows, a mask, load := 'none' or
+    // another traversal does
+    bool rememberable = result->load_options.population_mask.empty() && result->load_options.load_payloads &&
+                        result->filter.traversal == UsdTraversalMode::DEFAULT;
+    result->estimate = UsdScanStatistics::Estimate(context, "usd_prims", result->files, ROWS_PER_SPEC, rememberable,
+                                                   COLUMN_COUNT);
     
     // Define output schema - all columns from Phase 2
     names.emplace_back("prim_path");
@@ -78,80 +378,275 @@ static unique_ptr<FunctionData> UsdPrimsBind(ClientContext &context, TableFuncti
     names.emplace_back("instanceable");
     return_types.emplace_back(LogicalTypeId::BOOLEAN);
 
-    return make_uniq<UsdPrimsBindData>(file_path);
+    // Hierarchy numbers
+    for (auto name : {"depth", "sibling_index", "preorder_id", "postorder_id", "subtree_size"}) {
+        names.emplace_back(name);
+        return_types.emplace_back(LogicalTypeId::BIGINT);
+    }
+
+    // Instancing
+    names.emplace_back("is_instance");
+    return_types.emplace_back(LogicalTypeId::BOOLEAN);
+
+    names.emplace_back("prototype_path");
+    return_types.emplace_back(LogicalTypeId::VARCHAR);
+
+    names.emplace_back("instance_count");
+    return_types.emplace_back(LogicalTypeId::BIGINT);
+
+    return std::move(result);
 }
 
 static unique_ptr<GlobalTableFunctionState> UsdPrimsInit(ClientContext &context, TableFunctionInitInput &input) {
     auto &bind_data = input.bind_data->Cast<UsdPrimsBindData>();
     auto result = make_uniq<UsdPrimsGlobalState>();
+    result->projection = UsdColumnProjection(input.column_ids, COLUMN_COUNT);
+    result->file_count = bind_data.files.size();
+    result->tracker.Start(context, bind_data.estimate, bind_data.filter.IsEmpty());
+    result->hierarchy = ProjectsHierarchy(result->projection);
+    if (result->IsMultiFile()) {
+        // Files are the work units; their stages are opened by the threads
+        return std::move(result);
+    }
 
-    // Open USD stage
-    result->stage = UsdStageManager::OpenStage(bind_data.file_path);
+    // Open USD stage (shared through the stage cache)
+    UsdScanProfile profile;
+    profile.timing = result->tracker.Timing();
+    profile.Enter(UsdScanPhase::OPEN);
+    result->stage =
+        UsdStageManager::OpenStage(context, bind_data.files[0], LoadOptions(*result, bind_data), &profile);
+    if (result->hierarchy) {
+        profile.Enter(UsdScanPhase::EXTRACT);
+        result->single_file_hierarchy = UsdPrimHierarchy::Get(context, result->stage, bind_data.filter);
+    }
 
-    // Create prim iterator
-    result->iterator = make_uniq<UsdPrimIterator>(result->stage);
+    // Split the traversal into enough subtree units to keep every thread busy;
+    // only the subtree that can satisfy the pushed-down filters is visited
+    profile.Enter(UsdScanPhase::TRAVERSE);
+    auto target_units = NumericCast<idx_t>(TaskScheduler::GetScheduler(context).NumberOfThreads()) * 4;
+    result->partition =
+        UsdTraversalPartition::Build(result->stage, bind_data.partition_depth, target_units, bind_data.filter);
+    result->tracker.Flush(profile);
 
     return std::move(result);
 }
 
+static unique_ptr<LocalTableFunctionState> UsdPrimsInitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+                                                             GlobalTableFunctionState *global_state) {
+    return make_uniq<UsdPrimsLocalState>();
+}
+
 static void UsdPrimsExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
-    auto &state = data_p.global_state->Cast<UsdPrimsGlobalState>();
+    auto &bind_data = data_p.bind_data->Cast<UsdPrimsBindData>();
+    auto &gstate = data_p.global_state->Cast<UsdPrimsGlobalState>();
+    auto &lstate = data_p.local_state->Cast<UsdPrimsLocalState>();
+    auto &projection = gstate.projection;
 
+    // Only projected columns are computed; unprojected ones get nullptr
     idx_t count = 0;
-    auto prim_path_vector = FlatVector::GetData<string_t>(output.data[0]);
-    auto parent_path_vector = FlatVector::GetData<string_t>(output.data[1]);
-    auto name_vector = FlatVector::GetData<string_t>(output.data[2]);
-    auto prim_type_vector = FlatVector::GetData<string_t>(output.data[3]);
-    auto kind_vector = FlatVector::GetData<string_t>(output.data[4]);
-    auto active_vector = FlatVector::GetData<bool>(output.data[5]);
-    auto instanceable_vector = FlatVector::GetData<bool>(output.data[6]);
-
-    // Stream prims in batches
-    while (state.iterator->HasNext() && count < STANDARD_VECTOR_SIZE) {
-        auto prim = state.iterator->GetNext();
+    auto prim_path_out = projection.GetVector(output, COL_PRIM_PATH);
+    auto parent_path_out = projection.GetVector(output, COL_PARENT_PATH);
+    auto name_out = projection.GetVector(output, COL_NAME);
+    auto prim_type_out = projection.GetVector(output, COL_PRIM_TYPE);
+    auto kind_out = projection.GetVector(output, COL_KIND);
+    auto prim_path_vector = projection.GetData<string_t>(output, COL_PRIM_PATH);
+    auto parent_path_vector = projection.GetData<string_t>(output, COL_PARENT_PATH);
+    auto name_vector = projection.GetData<string_t>(output, COL_NAME);
+    auto active_vector = projection.GetData<bool>(output, COL_ACTIVE);
+    auto instanceable_vector = projection.GetData<bool>(output, COL_INSTANCEABLE);
+    Vector *hierarchy_out[] = {projection.GetVector(output, COL_DEPTH), projection.GetVector(output, COL_SIBLING_INDEX),
+                               projection.GetVector(output, COL_PREORDER_ID),
+                               projection.GetVector(output, COL_POSTORDER_ID),
+                               projection.GetVector(output, COL_SUBTREE_SIZE)};
+    auto is_instance_vector = projection.GetData<bool>(output, COL_IS_INSTANCE);
+    auto prototype_path_out = projection.GetVector(output, COL_PROTOTYPE_PATH);
+    auto instance_count_out = projection.GetVector(output, COL_INSTANCE_COUNT);
+
+    // Stream prims in batches; a chunk never spans two units so that its
+    // batch index identifies its position in the serial traversal order
+    pxr::UsdPrim prim;
+    while (count < STANDARD_VECTOR_SIZE) {
+        if (!lstate.NextPrim(gstate, bind_data, prim)) {
+            if (count > 0 || !lstate.NextUnit(context, gstate, bind_data)) {
+                break;
+            }
+            continue;
+        }
+
+        // Paths and names reference the strings of the stage's SdfPaths and
+        // tokens, which the stage keeps alive. Instance proxy paths are only
+        // held by the prim handle, so those are copied.
+        bool copy_strings = prim.IsInstanceProxy();
+        lstate.profile.Enter(UsdScanPhase::EMIT);
 
         // Get prim path
-        std::string path = prim.GetPath().GetString();
-        prim_path_vector[count] = StringVector::AddString(output.data[0], path);
+        if (prim_path_vector) {
+            const auto &path = prim.GetPath().GetString();
+            prim_path_vector[count] =
+                copy_strings ? StringVector::AddString(*prim_path_out, path) : UsdStringRef(path);
+        }
 
         // Get parent path
-        auto parent = prim.GetParent();
-        std::string parent_path = parent ? parent.GetPath().GetString() : "";
-        parent_path_vector[count] = StringVector::AddString(output.data[1], parent_path);
+        if (parent_path_vector) {
+            auto parent = prim.GetParent();
+            if (!parent) {
+                parent_path_vector[count] = string_t("", 0);
+            } else if (copy_strings || parent.IsInstanceProxy()) {
+                parent_path_vector[count] = StringVector::AddString(*parent_path_out, parent.GetPath().GetString());
+            } else {
+                parent_path_vector[count] = UsdStringRef(parent.GetPath().GetString());
+            }
+        }
 
         // Get prim name
-        std::string name = prim.GetName().GetString();
-        name_vector[count] = StringVector::AddString(output.data[2], name);
+        if (name_vector) {
+            const auto &name = prim.GetName().GetString();
+            name_vector[count] = copy_strings ? StringVector::AddString(*name_out, name) : UsdStringRef(name);
+        }
 
         // Get prim type
-        std::string type_name = prim.GetTypeName().GetString();
-        if (type_name.empty()) {
-            type_name = "<undefined>";
+        if (prim_type_out) {
+            lstate.prim_types.Select(count, prim.GetTypeName(), UNDEFINED_TYPE);
         }
-        prim_type_vector[count] = StringVector::AddString(output.data[3], type_name);
+
+        // Metadata and instancing are read from the stage
+        lstate.profile.Enter(UsdScanPhase::EXTRACT);
 
         // Get kind metadata
-        pxr::TfToken kind_token;
-        std::string kind_str;
-        if (pxr::UsdModelAPI(prim).GetKind(&kind_token)) {
-            kind_str = kind_token.GetString();
+        if (kind_out) {
+            pxr::TfToken kind_token;
+            pxr::UsdModelAPI(prim).GetKind(&kind_token);
+            lstate.kinds.Select(count, kind_token);
         }
-        kind_vector[count] = StringVector::AddString(output.data[4], kind_str);
 
         // Get active status
-        active_vector[count] = prim.IsActive();
+        if (active_vector) {
+            active_vector[count] = prim.IsActive();
+        }
 
         // Get instanceable status
-        instanceable_vector[count] = prim.IsInstanceable();
+        if (instanceable_vector) {
+            instanceable_vector[count] = prim.IsInstanceable();
+        }
+
+        // Get instancing status
+        if (is_instance_vector) {
+            is_instance_vector[count] = prim.IsInstance();
+        }
+
+        // Get the shared prototype and how many instances share it; counting
+        // asks the stage's instance index, no instance is traversed
+        if (prototype_path_out || instance_count_out) {
+            auto prototype = GetPrototypeRoot(prim);
+            if (!prototype) {
+                for (auto vector : {prototype_path_out, instance_count_out}) {
+                    if (vector) {
+                        FlatVector::SetNull(*vector, count, true);
+                    }
+                }
+            } else {
+                if (prototype_path_out) {
+                    // Copied: prototypes are renamed whenever the stage
+                    // recreates them
+                    FlatVector::GetData<string_t>(*prototype_path_out)[count] =
+                        StringVector::AddString(*prototype_path_out, prototype.GetPath().GetString());
+                }
+                if (instance_count_out) {
+                    auto entry = lstate.instance_counts.find(prototype.GetPath());
+                    if (entry == lstate.instance_counts.end()) {
+                        entry = lstate.instance_counts.emplace(prototype.GetPath(), prototype.GetInstances().size())
+                                    .first;
+                    }
+                    FlatVector::GetData<int64_t>(*instance_count_out)[count] = NumericCast<int64_t>(entry->second);
+                }
+            }
+        }
+
+        // Get hierarchy numbers (NULL for prims outside the traversal)
+        if (lstate.hierarchy) {
+            auto entry = lstate.hierarchy->Find(prim.GetPath());
+            for (idx_t i = 0; i < 5; i++) {
+                if (!hierarchy_out[i]) {
+                    continue;
+                }
+                if (!entry) {
+                    FlatVector::SetNull(*hierarchy_out[i], count, true);
+                    continue;
+                }
+                const idx_t values[] = {entry->depth, entry->sibling_index, entry->preorder_id, entry->postorder_id,
+                                        entry->subtree_size};
+                FlatVector::GetData<int64_t>(*hierarchy_out[i])[count] = NumericCast<int64_t>(values[i]);
+            }
+        }
 
         count++;
     }
 
     output.SetCardinality(count);
+    if (count > 0) {
+        lstate.unit_rows += count;
+        gstate.tracker.AddRows(count);
+        for (auto vector : {prim_path_out, parent_path_out, name_out}) {
+            if (vector) {
+                UsdKeepStageAlive(*vector, lstate.stage);
+            }
+        }
+        if (prim_type_out) {
+            lstate.prim_types.Finalize(*prim_type_out, count);
+        }
+        if (kind_out) {
+            lstate.kinds.Finalize(*kind_out, count);
+        }
+        projection.FinalizeChunk(output, bind_data.files[lstate.file_index]);
+        lstate.profile.Enter(UsdScanPhase::NONE);
+        lstate.profile.CountStrings(output);
+        gstate.tracker.Flush(lstate.profile);
+    }
+}
+
+static void UsdPrimsPushdownFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                   vector<unique_ptr<Expression>> &filters) {
+    auto &bind_data = bind_data_p->Cast<UsdPrimsBindData>();
+    UsdFilterColumns columns;
+    columns.prim_path = COL_PRIM_PATH;
+    columns.prim_type = COL_PRIM_TYPE;
+    columns.kind = COL_KIND;
+    bind_data.filter.Pushdown(get, filters, columns);
+}
+
+// Distinct counts remembered from earlier complete scans of the same files
+static unique_ptr<BaseStatistics> UsdPrimsStatistics(ClientContext &context, const FunctionData *bind_data_p,
+                                                     column_t column_index) {
+    auto &bind_data = bind_data_p->Cast<UsdPrimsBindData>();
+    if (column_index >= COLUMN_COUNT || bind_data.estimate.distinct[column_index] == 0) {
+        return nullptr;
+    }
+    // Only VARCHAR columns have distinct counts
+    auto stats = BaseStatistics::CreateUnknown(LogicalType::VARCHAR);
+    stats.SetDistinctCount(bind_data.estimate.distinct[column_index]);
+    return stats.ToUnique();
+}
+
+static OperatorPartitionData UsdPrimsGetPartitionData(ClientContext &context, TableFunctionGetPartitionInput &input) {
+    if (input.partition_info.RequiresPartitionColumns()) {
+        throw InternalException("usd_prims: partition columns are not supported");
+    }
+    auto &lstate = input.local_state->Cast<UsdPrimsLocalState>();
+    return OperatorPartitionData(lstate.unit_index);
 }
 
 TableFunction UsdPrimsFunction::GetFunction() {
-    TableFunction func("usd_prims", {LogicalTypeId::VARCHAR}, UsdPrimsExecute, UsdPrimsBind, UsdPrimsInit);
+    TableFunction func("usd_prims", {LogicalTypeId::VARCHAR}, UsdPrimsExecute, UsdPrimsBind, UsdPrimsInit,
+                       UsdPrimsInitLocal);
+    func.get_partition_data = UsdPrimsGetPartitionData;
+    func.projection_pushdown = true;
+    UsdScanStatistics::Register<UsdPrimsBindData, UsdPrimsGlobalState>(func);
+    func.statistics = UsdPrimsStatistics;
+    UsdFileList::RegisterFilenameColumn(func);
+    UsdStageLoadOptions::RegisterParameters(func);
+    UsdScanFilter::RegisterParameters(func);
+    func.pushdown_complex_filter = UsdPrimsPushdownFilter;
+    func.named_parameters["partition_depth"] = LogicalType::INTEGER;
     return func;
 }
 
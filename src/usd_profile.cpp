@@ -0,0 +1,144 @@
+#include "usd_profile.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/function/table_function.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/query_profiler.hpp"
+
+namespace duckdb {
+
+static const char *const PHASE_NAMES[USD_SCAN_PHASE_COUNT] = {"", "Open", "Traverse", "Extract", "Emit"};
+
+static double Milliseconds(idx_t nanos) {
+    return double(nanos) / 1e6;
+}
+
+void UsdScanProfile::CountStrings(DataChunk &chunk) {
+    auto count = chunk.size();
+    for (auto &vector : chunk.data) {
+        if (vector.GetType().InternalType() != PhysicalType::VARCHAR) {
+            continue;
+        }
+        // prim_type and kind are dictionaries, filename is constant
+        UnifiedVectorFormat format;
+        vector.ToUnifiedFormat(count, format);
+        auto strings = UnifiedVectorFormat::GetData<string_t>(format);
+        for (idx_t row = 0; row < count; row++) {
+            auto index = format.sel->get_index(row);
+            if (format.validity.RowIsValid(index)) {
+                string_bytes += strings[index].GetSize();
+            }
+        }
+    }
+}
+
+InsertionOrderPreservingMap<string> UsdScanStats::ToProfilerInfo() const {
+    InsertionOrderPreservingMap<string> result;
+    result["Prims Visited"] = std::to_string(prims_visited);
+    result["Prims Pruned"] = std::to_string(prims_pruned);
+    result["String Bytes"] = std::to_string(string_bytes);
+    result["Stage Cache"] =
+        std::to_string(stage_cache_hits) + " hits, " + std::to_string(stage_cache_misses) + " misses";
+    if (timed) {
+        // Summed over the scan's threads
+        for (idx_t phase = 1; phase < USD_SCAN_PHASE_COUNT; phase++) {
+            result[PHASE_NAMES[phase]] = StringUtil::Format("%.3fms", Milliseconds(phase_nanos[phase]));
+        }
+    }
+    return result;
+}
+
+shared_ptr<UsdScanHistory> UsdScanHistory::Get(ClientContext &context) {
+    return context.registered_state->GetOrCreate<UsdScanHistory>(NAME);
+}
+
+bool UsdScanHistory::TimingEnabled(ClientContext &context) {
+    // EXPLAIN ANALYZE and PRAGMA enable_profiling
+    if (QueryProfiler::Get(context).IsEnabled()) {
+        return true;
+    }
+    Value timing;
+    return context.TryGetCurrentSetting(TIMING_SETTING, timing) && !timing.IsNull() && BooleanValue::Get(timing);
+}
+
+void UsdScanHistory::QueryBegin(ClientContext &context) {
+    // Scans of the previous query are destroyed (and added) before this
+    std::lock_guard<std::mutex> guard(lock_);
+    if (!running_.empty()) {
+        last_ = std::move(running_);
+        running_.clear();
+    }
+}
+
+void UsdScanHistory::Add(UsdScanStats stats) {
+    std::lock_guard<std::mutex> guard(lock_);
+    running_.push_back(std::move(stats));
+}
+
+vector<UsdScanStats> UsdScanHistory::LastQuery() {
+    std::lock_guard<std::mutex> guard(lock_);
+    return last_;
+}
+
+struct UsdLastScanStatsBindData : public TableFunctionData {
+    vector<UsdScanStats> scans;
+};
+
+struct UsdLastScanStatsGlobalState : public GlobalTableFunctionState {
+    idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> UsdLastScanStatsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                     vector<LogicalType> &return_types, vector<string> &names) {
+    names = {"scan",         "function_name",    "rows",               "prims_visited", "prims_pruned",
+             "string_bytes", "stage_cache_hits", "stage_cache_misses", "wall_ms",       "open_ms",
+             "traverse_ms",  "extract_ms",       "emit_ms"};
+    return_types = {LogicalTypeId::BIGINT, LogicalTypeId::VARCHAR, LogicalTypeId::BIGINT, LogicalTypeId::BIGINT,
+                    LogicalTypeId::BIGINT, LogicalTypeId::BIGINT,  LogicalTypeId::BIGINT, LogicalTypeId::BIGINT,
+                    LogicalTypeId::DOUBLE, LogicalTypeId::DOUBLE,  LogicalTypeId::DOUBLE, LogicalTypeId::DOUBLE,
+                    LogicalTypeId::DOUBLE};
+    auto result = make_uniq<UsdLastScanStatsBindData>();
+    result->scans = UsdScanHistory::Get(context)->LastQuery();
+    return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> UsdLastScanStatsInit(ClientContext &context,
+                                                                 TableFunctionInitInput &input) {
+    return make_uniq<UsdLastScanStatsGlobalState>();
+}
+
+static void UsdLastScanStatsExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &bind_data = data_p.bind_data->Cast<UsdLastScanStatsBindData>();
+    auto &state = data_p.global_state->Cast<UsdLastScanStatsGlobalState>();
+
+    idx_t count = 0;
+    while (state.offset < bind_data.scans.size() && count < STANDARD_VECTOR_SIZE) {
+        auto &scan = bind_data.scans[state.offset];
+        output.SetValue(0, count, Value::BIGINT(NumericCast<int64_t>(state.offset)));
+        output.SetValue(1, count, Value(scan.function_name));
+        const idx_t counters[] = {scan.rows,         scan.prims_visited,    scan.prims_pruned,
+                                  scan.string_bytes, scan.stage_cache_hits, scan.stage_cache_misses};
+        for (idx_t i = 0; i < 6; i++) {
+            output.SetValue(2 + i, count, Value::BIGINT(NumericCast<int64_t>(counters[i])));
+        }
+        output.SetValue(8, count, Value::DOUBLE(Milliseconds(scan.wall_nanos)));
+        // Phase times only exist for timed scans
+        for (idx_t phase = 1; phase < USD_SCAN_PHASE_COUNT; phase++) {
+            auto value = Value(LogicalType::DOUBLE);
+            if (scan.timed) {
+                value = Value::DOUBLE(Milliseconds(scan.phase_nanos[phase]));
+            }
+            output.SetValue(8 + phase, count, value);
+        }
+        state.offset++;
+        count++;
+    }
+    output.SetCardinality(count);
+}
+
+TableFunction UsdLastScanStatsFunction::GetFunction() {
+    TableFunction func("usd_last_scan_stats", {}, UsdLastScanStatsExecute, UsdLastScanStatsBind,
+                       UsdLastScanStatsInit);
+    return func;
+}
+
+} // namespace duckdb
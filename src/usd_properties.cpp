@@ -1,5 +1,6 @@
 #include "usd_properties.hpp"
 #include "usd_helpers.hpp"
+#include "usd_values.hpp"
 #include "duckdb/common/exception.hpp"
 #include "duckdb/common/string_util.hpp"
 #include <pxr/usd/usd/stage.h>
@@ -7,38 +8,60 @@
 #include <pxr/usd/usd/attribute.h>
 #include <pxr/usd/usd/relationship.h>
 #include <pxr/base/vt/value.h>
-#include <sstream>
-#include <filesystem>
 
 namespace duckdb {
 
-struct UsdPropertiesBindData : public TableFunctionData {
-    std::string file_path;
+// Table columns, in schema order
+static constexpr idx_t COL_PRIM_PATH = 0;
+static constexpr idx_t COL_PROP_NAME = 1;
+static constexpr idx_t COL_PROP_KIND = 2;
+static constexpr idx_t COL_USD_TYPE_NAME = 3;
+static constexpr idx_t COL_IS_ARRAY = 4;
+static constexpr idx_t COL_IS_TIME_SAMPLED = 5;
+static constexpr idx_t COL_DEFAULT_VALUE = 6;
+static constexpr idx_t COL_VALUE_DOUBLE = 7;
+static constexpr idx_t COL_VALUE_INT = 8;
+static constexpr idx_t COL_VALUE_BOOL = 9;
+static constexpr idx_t COL_VALUE_TOKEN = 10;
+static constexpr idx_t COL_VALUE_VEC3 = 11;
+static constexpr idx_t COL_VALUE_ARRAY = 12;
+static constexpr idx_t COLUMN_COUNT = 13;
+// Rows per root layer spec, for estimates before the first complete scan
+static constexpr double ROWS_PER_SPEC = 0.75;
 
-    explicit UsdPropertiesBindData(std::string path) : file_path(std::move(path)) {}
+struct UsdPropertiesBindData : public TableFunctionData {
+    // Files to scan (a path, the matches of a glob, or a list)
+    vector<std::string> files;
+    // Population mask and payload loading requested with mask := / load :=
+    UsdStageLoadOptions load_options;
+    // Path and property name predicates pushed down from the query
+    UsdScanFilter filter;
+    // Row estimate for the planner and the progress bar
+    UsdScanEstimate estimate;
+
+    explicit UsdPropertiesBindData(vector<std::string> files_p) : files(std::move(files_p)) {}
 };
 
-struct UsdPropertiesGlobalState : public GlobalTableFunctionState {
-    pxr::UsdStageRefPtr stage;
+// Per-thread cursor into the file currently being scanned
+struct UsdPropertiesLocalState : public UsdMultiFileLocalState {
     std::unique_ptr<UsdPrimIterator> prim_iterator;
     pxr::UsdPrim current_prim;
     std::vector<pxr::UsdProperty> current_properties;
     size_t property_index = 0;
-    bool has_current_prim = false;
-
-    UsdPropertiesGlobalState() = default;
-};
 
-// Helper function to stringify USD attribute values
-static std::string StringifyValue(const pxr::VtValue &value) {
-    if (value.IsEmpty()) {
-        return "";
+    // Claims the next file and starts iterating its prims
+    bool NextFile(ClientContext &context, UsdMultiFileGlobalState &gstate, const UsdPropertiesBindData &bind_data) {
+        prim_iterator.reset();
+        current_properties.clear();
+        property_index = 0;
+        if (!OpenNextFile(context, gstate, bind_data.files, bind_data.load_options.WithFilter(bind_data.filter))) {
+            return false;
+        }
+        // Create prim iterator over the prims that can satisfy the filters
+        prim_iterator = make_uniq<UsdPrimIterator>(stage, bind_data.filter, &profile);
+        return true;
     }
-
-    std::ostringstream oss;
-    oss << value;
-    return oss.str();
-}
+};
 
 static unique_ptr<FunctionData> UsdPropertiesBind(ClientContext &context, TableFunctionBindInput &input,
                                                     vector<LogicalType> &return_types, vector<string> &names) {
@@ -47,132 +70,187 @@ static unique_ptr<FunctionData> UsdPropertiesBind(ClientContext &context, TableF
         throw BinderException("usd_properties requires exactly 1 argument (file_path)");
     }
 
-    auto file_path = input.inputs[0].GetValue<string>();
-
-    // Check for empty path
-    if (file_path.empty() || file_path.find_first_not_of(" \t\n\r") == std::string::npos) {
-        throw BinderException("usd_properties: file_path cannot be empty");
-    }
-
-    // Check if file exists
-    if (!std::filesystem::exists(file_path)) {
-        throw BinderException("usd_properties: USD file not found: " + file_path);
-    }
-
-    // Check if it's a directory
-    if (std::filesystem::is_directory(file_path)) {
-        throw BinderException("usd_properties: path is a directory, not a file: " + file_path);
-    }
-
-    // Validate file extension
-    if (!UsdStageManager::IsValidUsdFile(file_path)) {
-        throw BinderException("usd_properties: file must have a USD extension (.usd, .usda, .usdc, .usdz): " + file_path);
-    }
+    // One path, a glob pattern or a list of either
+    auto files = UsdFileList::Bind(context, "usd_properties", input.inputs[0]);
 
     // Define output schema
     names = {"prim_path", "prop_name", "prop_kind", "usd_type_name", "is_array", "is_time_sampled", "default_value"};
     return_types = {LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR,
                     LogicalTypeId::VARCHAR, LogicalTypeId::BOOLEAN, LogicalTypeId::BOOLEAN, LogicalTypeId::VARCHAR};
-
-    return make_uniq<UsdPropertiesBindData>(file_path);
+    // Typed copies of the default value: value_double .. value_array
+    UsdValueDispatch::AddColumns(names, return_types);
+
+    auto result = make_uniq<UsdPropertiesBindData>(std::move(files));
+    result->estimate = UsdScanStatistics::Estimate(context, "usd_properties", result->files, ROWS_PER_SPEC,
+                                                   input.named_parameters.empty(), COLUMN_COUNT);
+    result->load_options.Bind("usd_properties", input.named_parameters);
+    result->filter.BindTraversal("usd_properties", input.named_parameters);
+    return std::move(result);
 }
 
 static unique_ptr<GlobalTableFunctionState> UsdPropertiesInit(ClientContext &context, TableFunctionInitInput &input) {
     auto &bind_data = input.bind_data->Cast<UsdPropertiesBindData>();
-    auto result = make_uniq<UsdPropertiesGlobalState>();
-
-    // Open USD stage
-    result->stage = UsdStageManager::OpenStage(bind_data.file_path);
-
-    // Create prim iterator
-    result->prim_iterator = make_uniq<UsdPrimIterator>(result->stage);
-
-    // Load properties for the first prim
-    if (result->prim_iterator->HasNext()) {
-        result->current_prim = result->prim_iterator->GetNext();
-        result->current_properties = result->current_prim.GetProperties();
-        result->property_index = 0;
-        result->has_current_prim = true;
-    }
-
+    auto result = make_uniq<UsdMultiFileGlobalState>(bind_data.files.size());
+    result->projection = UsdColumnProjection(input.column_ids, COLUMN_COUNT);
+    result->tracker.Start(context, bind_data.estimate, bind_data.filter.IsEmpty());
     return std::move(result);
 }
 
+// Each thread opens (through the stage cache) the stages of the files it claims
+static unique_ptr<LocalTableFunctionState> UsdPropertiesInitLocal(ExecutionContext &context,
+                                                                  TableFunctionInitInput &input,
+                                                                  GlobalTableFunctionState *global_state) {
+    return make_uniq<UsdPropertiesLocalState>();
+}
+
 static void UsdPropertiesExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
-    auto &state = data_p.global_state->Cast<UsdPropertiesGlobalState>();
+    auto &bind_data = data_p.bind_data->Cast<UsdPropertiesBindData>();
+    auto &gstate = data_p.global_state->Cast<UsdMultiFileGlobalState>();
+    auto &state = data_p.local_state->Cast<UsdPropertiesLocalState>();
+    auto &projection = gstate.projection;
     idx_t output_idx = 0;
 
+    // Only projected columns are computed; unprojected ones get nullptr
+    auto prim_path_out = projection.GetVector(output, COL_PRIM_PATH);
+    auto prop_name_out = projection.GetVector(output, COL_PROP_NAME);
+    auto prop_kind_out = projection.GetVector(output, COL_PROP_KIND);
+    auto usd_type_name_out = projection.GetVector(output, COL_USD_TYPE_NAME);
+    auto default_value_out = projection.GetVector(output, COL_DEFAULT_VALUE);
+    auto prim_path_data = projection.GetData<string_t>(output, COL_PRIM_PATH);
+    auto prop_name_data = projection.GetData<string_t>(output, COL_PROP_NAME);
+    auto prop_kind_data = projection.GetData<string_t>(output, COL_PROP_KIND);
+    auto usd_type_name_data = projection.GetData<string_t>(output, COL_USD_TYPE_NAME);
+    auto is_array_data = projection.GetData<bool>(output, COL_IS_ARRAY);
+    auto is_time_sampled_data = projection.GetData<bool>(output, COL_IS_TIME_SAMPLED);
+    auto default_value_data = projection.GetData<string_t>(output, COL_DEFAULT_VALUE);
+    UsdValueVectors value_out;
+    value_out.value_double = projection.GetVector(output, COL_VALUE_DOUBLE);
+    value_out.value_int = projection.GetVector(output, COL_VALUE_INT);
+    value_out.value_bool = projection.GetVector(output, COL_VALUE_BOOL);
+    value_out.value_token = projection.GetVector(output, COL_VALUE_TOKEN);
+    value_out.value_vec3 = projection.GetVector(output, COL_VALUE_VEC3);
+    value_out.value_array = projection.GetVector(output, COL_VALUE_ARRAY);
+    bool typed_values = value_out.Any();
+
     while (output_idx < STANDARD_VECTOR_SIZE) {
         // Check if we need to move to the next prim
-        while (state.property_index >= state.current_properties.size()) {
-            if (!state.prim_iterator->HasNext()) {
-                // No more prims, we're done
-                output.SetCardinality(output_idx);
-                return;
+        if (state.property_index >= state.current_properties.size()) {
+            if (!state.prim_iterator || !state.prim_iterator->HasNext()) {
+                // No more prims in this file; a chunk never spans two files
+                if (output_idx > 0 || !state.NextFile(context, gstate, bind_data)) {
+                    break;
+                }
+                continue;
             }
 
             // Move to next prim
+            state.profile.Enter(UsdScanPhase::TRAVERSE);
             state.current_prim = state.prim_iterator->GetNext();
-            state.current_properties = state.current_prim.GetProperties();
+            state.profile.Enter(UsdScanPhase::EXTRACT);
+            state.current_properties = bind_data.filter.GetProperties(state.current_prim);
             state.property_index = 0;
-            state.has_current_prim = true;
+            continue;
         }
 
         // Get current property
-        auto prop = state.current_properties[state.property_index];
-
-        // Extract property information
-        std::string prim_path = state.current_prim.GetPath().GetString();
-        std::string prop_name = prop.GetName().GetString();
-        std::string prop_kind;
-        std::string usd_type_name;
-        bool is_array = false;
-        bool is_time_sampled = false;
-        std::string default_value;
-
-        // Check if it's an attribute or relationship
-        if (prop.Is<pxr::UsdAttribute>()) {
-            auto attr = prop.As<pxr::UsdAttribute>();
-            prop_kind = "attribute";
+        auto &prop = state.current_properties[state.property_index];
+        bool is_attribute = prop.Is<pxr::UsdAttribute>();
 
-            auto type_name = attr.GetTypeName();
-            usd_type_name = type_name.GetAsToken().GetString();
-            is_array = type_name.IsArray();
-            is_time_sampled = attr.ValueMightBeTimeVarying();
+        // Extract only the projected columns
+        state.profile.Enter(UsdScanPhase::EMIT);
+        if (prim_path_data) {
+            prim_path_data[output_idx] = StringVector::AddString(*prim_path_out, state.current_prim.GetPath().GetString());
+        }
+        if (prop_name_data) {
+            prop_name_data[output_idx] = StringVector::AddString(*prop_name_out, prop.GetName().GetString());
+        }
+        if (prop_kind_data) {
+            // Check if it's an attribute or relationship
+            prop_kind_data[output_idx] = StringVector::AddString(*prop_kind_out, is_attribute ? "attribute" : "relationship");
+        }
 
-            // Get default value
-            pxr::VtValue value;
-            if (attr.Get(&value)) {
-                default_value = StringifyValue(value);
+        if (is_attribute) {
+            auto attr = prop.As<pxr::UsdAttribute>();
+            pxr::SdfValueTypeName type_name;
+            state.profile.Enter(UsdScanPhase::EXTRACT);
+            if (usd_type_name_data || is_array_data || typed_values) {
+                type_name = attr.GetTypeName();
+                if (usd_type_name_data) {
+                    usd_type_name_data[output_idx] =
+                        StringVector::AddString(*usd_type_name_out, type_name.GetAsToken().GetString());
+                }
+                if (is_array_data) {
+                    is_array_data[output_idx] = type_name.IsArray();
+                }
+            }
+            if (is_time_sampled_data) {
+                is_time_sampled_data[output_idx] = attr.ValueMightBeTimeVarying();
+            }
+            if (default_value_data || typed_values) {
+                // Get default value; the string form is only built when projected
+                pxr::VtValue value;
+                bool has_value = attr.Get(&value);
+                state.profile.Enter(UsdScanPhase::EMIT);
+                if (default_value_data) {
+                    std::string default_value = has_value ? UsdValueDispatch::FormatValue(value) : "";
+                    default_value_data[output_idx] = StringVector::AddString(*default_value_out, default_value);
+                }
+                if (typed_values) {
+                    uint8_t written = 0;
+                    auto writer = has_value ? UsdValueDispatch::GetWriter(type_name) : nullptr;
+                    if (writer) {
+                        written = writer(value, value_out, output_idx);
+                    }
+                    value_out.SetNullExcept(output_idx, written);
+                }
+            }
+        } else {
+            if (usd_type_name_data) {
+                usd_type_name_data[output_idx] = StringVector::AddString(*usd_type_name_out, "relationship");
+            }
+            if (is_array_data) {
+                is_array_data[output_idx] = false;
+            }
+            if (is_time_sampled_data) {
+                is_time_sampled_data[output_idx] = false;
+            }
+            if (default_value_data) {
+                default_value_data[output_idx] = StringVector::AddString(*default_value_out, "");
+            }
+            if (typed_values) {
+                value_out.SetNullExcept(output_idx, 0);
             }
-        } else if (prop.Is<pxr::UsdRelationship>()) {
-            prop_kind = "relationship";
-            usd_type_name = "relationship";
-            is_array = false;
-            is_time_sampled = false;
-            default_value = "";
         }
 
-        // Write to output
-        FlatVector::GetData<string_t>(output.data[0])[output_idx] = StringVector::AddString(output.data[0], prim_path);
-        FlatVector::GetData<string_t>(output.data[1])[output_idx] = StringVector::AddString(output.data[1], prop_name);
-        FlatVector::GetData<string_t>(output.data[2])[output_idx] = StringVector::AddString(output.data[2], prop_kind);
-        FlatVector::GetData<string_t>(output.data[3])[output_idx] = StringVector::AddString(output.data[3], usd_type_name);
-
-
-        FlatVector::GetData<bool>(output.data[4])[output_idx] = is_array;
-        FlatVector::GetData<bool>(output.data[5])[output_idx] = is_time_sampled;
-        FlatVector::GetData<string_t>(output.data[6])[output_idx] = StringVector::AddString(output.data[6], default_value);
-
         output_idx++;
         state.property_index++;
     }
 
     output.SetCardinality(output_idx);
+    if (output_idx > 0) {
+        state.FinalizeChunk(gstate, output, bind_data.files);
+    }
+}
+
+static void UsdPropertiesPushdownFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                        vector<unique_ptr<Expression>> &filters) {
+    auto &bind_data = bind_data_p->Cast<UsdPropertiesBindData>();
+    UsdFilterColumns columns;
+    columns.prim_path = COL_PRIM_PATH;
+    columns.property_name = COL_PROP_NAME;
+    bind_data.filter.Pushdown(get, filters, columns);
 }
 
 TableFunction UsdPropertiesFunction::GetFunction() {
-    TableFunction func("usd_properties", {LogicalTypeId::VARCHAR}, UsdPropertiesExecute, UsdPropertiesBind, UsdPropertiesInit);
+    TableFunction func("usd_properties", {LogicalTypeId::VARCHAR}, UsdPropertiesExecute, UsdPropertiesBind,
+                       UsdPropertiesInit, UsdPropertiesInitLocal);
+    func.get_partition_data = UsdMultiFileLocalState::GetPartitionData;
+    func.projection_pushdown = true;
+    UsdScanStatistics::Register<UsdPropertiesBindData, UsdMultiFileGlobalState>(func);
+    UsdFileList::RegisterFilenameColumn(func);
+    UsdStageLoadOptions::RegisterParameters(func);
+    UsdScanFilter::RegisterParameters(func);
+    func.pushdown_complex_filter = UsdPropertiesPushdownFilter;
     return func;
 }
 
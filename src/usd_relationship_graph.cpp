@@ -0,0 +1,482 @@
+#include "usd_relationship_graph.hpp"
+#include "usd_helpers.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/string_util.hpp"
+
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/relationship.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/base/tf/token.h>
+#include <unordered_map>
+
+namespace duckdb {
+
+// usd_referrers columns, in schema order (those of usd_relationships)
+static constexpr idx_t COL_PRIM_PATH = 0;
+static constexpr idx_t COL_REL_NAME = 1;
+static constexpr idx_t COL_TARGET_PATH = 2;
+static constexpr idx_t COL_TARGET_INDEX = 3;
+static constexpr idx_t REFERRERS_COLUMN_COUNT = 4;
+// usd_relationship_closure columns, in schema order
+static constexpr idx_t COL_CLOSURE_PATH = 0;
+static constexpr idx_t COL_CLOSURE_DEPTH = 1;
+static constexpr idx_t COL_CLOSURE_VIA = 2;
+static constexpr idx_t COL_CLOSURE_REL_NAME = 3;
+static constexpr idx_t CLOSURE_COLUMN_COUNT = 4;
+
+// Relationship targets of a stage as a graph in compressed sparse row form,
+// built in one GetTargets pass over the traversal and cached with the stage.
+// Nodes are the source prims and the target paths, numbered in the order
+// they are met. The edges leaving node n are out_edges[out_offsets[n] ..
+// out_offsets[n + 1]), in traversal, relationship and target order; the
+// edges entering it are the same range of in_edges and in_offsets, ordered
+// by source. A lookup in either direction is a hash probe plus the edges it
+// returns, instead of a scan of every relationship of the stage.
+class UsdRelationshipGraph : public UsdStageDerivedData {
+public:
+    struct Edge {
+        // The node at the other end
+        idx_t node;
+        // Index into rel_names
+        uint32_t rel;
+        // Position of the target in the relationship
+        uint32_t target_index;
+    };
+
+    static constexpr const char *DERIVED_DATA_NAME = "relationship_graph";
+
+    UsdRelationshipGraph(const pxr::UsdStageRefPtr &stage, const UsdScanFilter &filter) {
+        struct SourceEdge {
+            idx_t source;
+            Edge edge;
+        };
+        std::vector<SourceEdge> edges;
+        pxr::SdfPathVector targets;
+        UsdPrimIterator prims(stage, filter);
+        while (prims.HasNext()) {
+            auto prim = prims.GetNext();
+            for (const auto &rel : prim.GetRelationships()) {
+                targets.clear();
+                rel.GetTargets(&targets);
+                if (targets.empty()) {
+                    continue;
+                }
+                auto source = Intern(prim.GetPath());
+                auto rel_id = InternName(rel.GetName());
+                for (idx_t i = 0; i < targets.size(); i++) {
+                    auto target =
+                        targets[i].IsAbsolutePath() ? targets[i] : targets[i].MakeAbsolutePath(prim.GetPath());
+                    edges.push_back({source, Edge {Intern(target), rel_id, static_cast<uint32_t>(i)}});
+                }
+            }
+        }
+
+        // Both directions by counting sort, which is stable: edges keep their
+        // traversal order within a node. Source ids are not in traversal order
+        // (a prim may be met as a target first).
+        out_offsets.assign(paths.size() + 1, 0);
+        in_offsets.assign(paths.size() + 1, 0);
+        for (const auto &edge : edges) {
+            out_offsets[edge.source + 1]++;
+            in_offsets[edge.edge.node + 1]++;
+        }
+        for (idx_t node = 0; node < paths.size(); node++) {
+            out_offsets[node + 1] += out_offsets[node];
+            in_offsets[node + 1] += in_offsets[node];
+        }
+        out_edges.resize(edges.size());
+        in_edges.resize(edges.size());
+        auto out_next = out_offsets;
+        auto in_next = in_offsets;
+        for (const auto &edge : edges) {
+            out_edges[out_next[edge.source]++] = edge.edge;
+            in_edges[in_next[edge.edge.node]++] = Edge {edge.source, edge.edge.rel, edge.edge.target_index};
+        }
+    }
+
+    // Shared graph of stage in the traversal of filter, built on first use
+    static std::shared_ptr<UsdRelationshipGraph> Get(ClientContext &context, const pxr::UsdStageRefPtr &stage,
+                                                     const UsdScanFilter &filter) {
+        auto name = std::string(DERIVED_DATA_NAME) + ":" + std::to_string(static_cast<int>(filter.traversal));
+        return UsdStageManager::GetDerivedData<UsdRelationshipGraph>(
+            context, stage, name, [&]() { return std::make_shared<UsdRelationshipGraph>(stage, filter); });
+    }
+
+    idx_t EstimatedSize() const override {
+        // Paths, offsets and roughly one hash node per path, and both edge arrays
+        return paths.size() * (sizeof(pxr::SdfPath) + 2 * sizeof(idx_t) + 4 * sizeof(void *)) +
+               2 * out_edges.size() * sizeof(Edge);
+    }
+
+    // Node of path, or false if no relationship starts or ends there
+    bool Find(const pxr::SdfPath &path, idx_t &node) const {
+        auto entry = ids.find(path);
+        if (entry == ids.end()) {
+            return false;
+        }
+        node = entry->second;
+        return true;
+    }
+
+    // Id of a relationship name, or false if no relationship has it
+    bool FindName(const pxr::TfToken &name, uint32_t &rel) const {
+        for (uint32_t i = 0; i < rel_names.size(); i++) {
+            if (rel_names[i] == name) {
+                rel = i;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const pxr::SdfPath &GetPath(idx_t node) const {
+        return paths[node];
+    }
+    const pxr::TfToken &GetName(uint32_t rel) const {
+        return rel_names[rel];
+    }
+
+    // Edges leaving (forward) or entering node
+    const Edge *EdgesBegin(idx_t node, bool forward) const {
+        return forward ? out_edges.data() + out_offsets[node] : in_edges.data() + in_offsets[node];
+    }
+    const Edge *EdgesEnd(idx_t node, bool forward) const {
+        return forward ? out_edges.data() + out_offsets[node + 1] : in_edges.data() + in_offsets[node + 1];
+    }
+
+    idx_t NodeCount() const {
+        return paths.size();
+    }
+
+private:
+    std::vector<pxr::SdfPath> paths;
+    std::unordered_map<pxr::SdfPath, idx_t, pxr::SdfPath::Hash> ids;
+    std::vector<pxr::TfToken> rel_names;
+    std::vector<idx_t> out_offsets;
+    std::vector<Edge> out_edges;
+    std::vector<idx_t> in_offsets;
+    std::vector<Edge> in_edges;
+
+    idx_t Intern(const pxr::SdfPath &path) {
+        auto entry = ids.emplace(path, paths.size());
+        if (entry.second) {
+            paths.push_back(path);
+        }
+        return entry.first->second;
+    }
+
+    // Stages have few distinct relationship names
+    uint32_t InternName(const pxr::TfToken &name) {
+        uint32_t rel;
+        if (FindName(name, rel)) {
+            return rel;
+        }
+        rel_names.push_back(name);
+        return static_cast<uint32_t>(rel_names.size() - 1);
+    }
+};
+
+// Bind data shared by the graph queries
+struct UsdRelationshipGraphBindData : public TableFunctionData {
+    std::string file_path;
+    // Population mask and payload loading requested with mask := / load :=
+    UsdStageLoadOptions load_options;
+    // Traversal the graph is built from
+    UsdScanFilter filter;
+    // usd_referrers: the target; usd_relationship_closure: the start
+    pxr::SdfPath path;
+    // usd_relationship_closure: followed relationship (empty = any), depth
+    // bound and direction
+    pxr::TfToken rel_name;
+    idx_t max_depth = NumericLimits<idx_t>::Maximum();
+    bool forward = true;
+
+    explicit UsdRelationshipGraphBindData(std::string path_p) : file_path(std::move(path_p)) {}
+};
+
+// A result row: a node and the edge reaching it. Closure rows of depth 0
+// (the start) have no edge.
+struct UsdGraphRow {
+    idx_t node;
+    idx_t depth;
+    const UsdRelationshipGraph::Edge *edge;
+    // The node at the near end of edge
+    idx_t via;
+};
+
+// Global state: the rows are computed in init and emitted in chunks
+struct UsdRelationshipGraphGlobalState : public GlobalTableFunctionState {
+    std::shared_ptr<UsdRelationshipGraph> graph;
+    // usd_relationship_closure: the start path, which may not be a node
+    pxr::SdfPath start;
+    vector<UsdGraphRow> rows;
+    idx_t offset = 0;
+    UsdColumnProjection projection;
+    // Queries run on a single thread: one profile serves the whole query
+    UsdScanTracker tracker;
+    UsdScanProfile profile;
+};
+
+static std::string BindFilePath(ClientContext &context, const std::string &function_name,
+                                TableFunctionBindInput &input) {
+    if (input.inputs[0].IsNull()) {
+        throw BinderException(function_name + ": file_path cannot be NULL");
+    }
+    auto file_path = input.inputs[0].GetValue<string>();
+    UsdFileList::Validate(context, function_name, file_path);
+    return file_path;
+}
+
+static pxr::SdfPath BindPath(const std::string &function_name, const std::string &argument, const Value &value) {
+    if (value.IsNull()) {
+        throw BinderException(function_name + ": " + argument + " cannot be NULL");
+    }
+    auto text = value.ToString();
+    pxr::SdfPath path(text);
+    if (!path.IsAbsolutePath() || !(path.IsPrimPath() || path.IsPropertyPath())) {
+        throw BinderException(function_name + ": " + argument + " must be an absolute prim or property path: " +
+                              text);
+    }
+    return path;
+}
+
+static unique_ptr<FunctionData> UsdReferrersBind(ClientContext &context, TableFunctionBindInput &input,
+                                                 vector<LogicalType> &return_types, vector<string> &names) {
+    auto result = make_uniq<UsdRelationshipGraphBindData>(BindFilePath(context, "usd_referrers", input));
+    result->load_options.Bind("usd_referrers", input.named_parameters);
+    result->filter.BindTraversal("usd_referrers", input.named_parameters);
+    result->path = BindPath("usd_referrers", "target_path", input.inputs[1]);
+
+    names = {"prim_path", "rel_name", "target_path", "target_index"};
+    return_types = {LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR, LogicalTypeId::INTEGER};
+    return std::move(result);
+}
+
+static unique_ptr<FunctionData> UsdRelationshipClosureBind(ClientContext &context, TableFunctionBindInput &input,
+                                                           vector<LogicalType> &return_types, vector<string> &names) {
+    auto result =
+        make_uniq<UsdRelationshipGraphBindData>(BindFilePath(context, "usd_relationship_closure", input));
+    result->load_options.Bind("usd_relationship_closure", input.named_parameters);
+    result->filter.BindTraversal("usd_relationship_closure", input.named_parameters);
+    result->path = BindPath("usd_relationship_closure", "start_path", input.inputs[1]);
+    // NULL follows every relationship, or has no depth bound
+    if (!input.inputs[2].IsNull()) {
+        result->rel_name = pxr::TfToken(input.inputs[2].ToString());
+    }
+    if (!input.inputs[3].IsNull()) {
+        auto max_depth = input.inputs[3].GetValue<int64_t>();
+        if (max_depth < 0) {
+            throw BinderException("usd_relationship_closure: max_depth must not be negative");
+        }
+        result->max_depth = NumericCast<idx_t>(max_depth);
+    }
+    auto direction = input.named_parameters.find("direction");
+    if (direction != input.named_parameters.end() && !direction->second.IsNull()) {
+        auto value = StringUtil::Lower(direction->second.ToString());
+        if (value != "forward" && value != "reverse") {
+            throw BinderException("usd_relationship_closure: direction must be 'forward' or 'reverse'");
+        }
+        result->forward = value == "forward";
+    }
+
+    names = {"prim_path", "depth", "via_path", "rel_name"};
+    return_types = {LogicalTypeId::VARCHAR, LogicalTypeId::BIGINT, LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR};
+    return std::move(result);
+}
+
+// Opens the stage and fetches (or builds) its graph. Building the graph and
+// walking it are profiled as the extract phase; the caller flushes the
+// profile once the rows are computed.
+static unique_ptr<UsdRelationshipGraphGlobalState> InitGraphState(ClientContext &context,
+                                                                  TableFunctionInitInput &input, idx_t column_count,
+                                                                  const std::string &function_name) {
+    auto &bind_data = input.bind_data->Cast<UsdRelationshipGraphBindData>();
+    auto state = make_uniq<UsdRelationshipGraphGlobalState>();
+    state->projection = UsdColumnProjection(input.column_ids, column_count);
+    state->tracker.StartProfile(context, function_name);
+    state->profile.timing = state->tracker.Timing();
+
+    // Open USD stage (shared through the stage cache, as is its graph)
+    state->profile.Enter(UsdScanPhase::OPEN);
+    auto stage = UsdStageManager::OpenStage(context, bind_data.file_path, bind_data.load_options, &state->profile);
+    state->profile.Enter(UsdScanPhase::EXTRACT);
+    state->graph = UsdRelationshipGraph::Get(context, stage, bind_data.filter);
+    return state;
+}
+
+static unique_ptr<GlobalTableFunctionState> UsdReferrersInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<UsdRelationshipGraphBindData>();
+    auto state = InitGraphState(context, input, REFERRERS_COLUMN_COUNT, "usd_referrers");
+    idx_t target;
+    if (state->graph->Find(bind_data.path, target)) {
+        for (auto edge = state->graph->EdgesBegin(target, false); edge != state->graph->EdgesEnd(target, false);
+             edge++) {
+            state->rows.push_back(UsdGraphRow {edge->node, 1, edge, target});
+        }
+    }
+    state->tracker.Flush(state->profile);
+    return std::move(state);
+}
+
+static unique_ptr<GlobalTableFunctionState> UsdRelationshipClosureInit(ClientContext &context,
+                                                                       TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<UsdRelationshipGraphBindData>();
+    auto state = InitGraphState(context, input, CLOSURE_COLUMN_COUNT, "usd_relationship_closure");
+    auto &graph = *state->graph;
+    state->start = bind_data.path;
+
+    // The start is reported even when no relationship touches it, like the
+    // seed of a recursive CTE
+    idx_t start;
+    if (!graph.Find(bind_data.path, start)) {
+        state->rows.push_back(UsdGraphRow {DConstants::INVALID_INDEX, 0, nullptr, DConstants::INVALID_INDEX});
+        state->tracker.Flush(state->profile);
+        return std::move(state);
+    }
+    uint32_t rel = 0;
+    bool any_rel = bind_data.rel_name.IsEmpty();
+    if (!any_rel && !graph.FindName(bind_data.rel_name, rel)) {
+        state->rows.push_back(UsdGraphRow {start, 0, nullptr, DConstants::INVALID_INDEX});
+        state->tracker.Flush(state->profile);
+        return std::move(state);
+    }
+
+    // Breadth first, so every node is reported once at its shortest depth;
+    // rows double as the queue
+    std::vector<bool> visited(graph.NodeCount(), false);
+    visited[start] = true;
+    state->rows.push_back(UsdGraphRow {start, 0, nullptr, DConstants::INVALID_INDEX});
+    for (idx_t next = 0; next < state->rows.size(); next++) {
+        auto row = state->rows[next];
+        if (row.depth >= bind_data.max_depth) {
+            // Rows are in depth order: the rest are as deep
+            break;
+        }
+        auto end = graph.EdgesEnd(row.node, bind_data.forward);
+        for (auto edge = graph.EdgesBegin(row.node, bind_data.forward); edge != end; edge++) {
+            if ((!any_rel && edge->rel != rel) || visited[edge->node]) {
+                continue;
+            }
+            visited[edge->node] = true;
+            state->rows.push_back(UsdGraphRow {edge->node, row.depth + 1, edge, row.node});
+        }
+    }
+    state->tracker.Flush(state->profile);
+    return std::move(state);
+}
+
+static void UsdReferrersExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &state = data_p.global_state->Cast<UsdRelationshipGraphGlobalState>();
+    auto &projection = state.projection;
+    auto &graph = *state.graph;
+
+    // Only projected columns are computed; unprojected ones get nullptr
+    auto prim_path_out = projection.GetVector(output, COL_PRIM_PATH);
+    auto rel_name_out = projection.GetVector(output, COL_REL_NAME);
+    auto target_path_out = projection.GetVector(output, COL_TARGET_PATH);
+    auto prim_path_data = projection.GetData<string_t>(output, COL_PRIM_PATH);
+    auto rel_name_data = projection.GetData<string_t>(output, COL_REL_NAME);
+    auto target_path_data = projection.GetData<string_t>(output, COL_TARGET_PATH);
+    auto target_index_data = projection.GetData<int32_t>(output, COL_TARGET_INDEX);
+
+    auto count = MinValue<idx_t>(state.rows.size() - state.offset, STANDARD_VECTOR_SIZE);
+    state.profile.Enter(UsdScanPhase::EMIT);
+    for (idx_t row = 0; row < count; row++) {
+        const auto &match = state.rows[state.offset + row];
+        if (prim_path_data) {
+            prim_path_data[row] = StringVector::AddString(*prim_path_out, graph.GetPath(match.node).GetString());
+        }
+        if (rel_name_data) {
+            rel_name_data[row] = StringVector::AddString(*rel_name_out, graph.GetName(match.edge->rel).GetString());
+        }
+        if (target_path_data) {
+            target_path_data[row] = StringVector::AddString(*target_path_out, graph.GetPath(match.via).GetString());
+        }
+        if (target_index_data) {
+            target_index_data[row] = static_cast<int32_t>(match.edge->target_index);
+        }
+    }
+    state.offset += count;
+
+    output.SetCardinality(count);
+    projection.FinalizeChunk(output);
+    state.tracker.AddRows(count);
+    state.profile.Enter(UsdScanPhase::NONE);
+    state.profile.CountStrings(output);
+    state.tracker.Flush(state.profile);
+}
+
+static void UsdRelationshipClosureExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &state = data_p.global_state->Cast<UsdRelationshipGraphGlobalState>();
+    auto &projection = state.projection;
+    auto &graph = *state.graph;
+
+    // Only projected columns are computed; unprojected ones get nullptr
+    auto path_out = projection.GetVector(output, COL_CLOSURE_PATH);
+    auto via_out = projection.GetVector(output, COL_CLOSURE_VIA);
+    auto rel_name_out = projection.GetVector(output, COL_CLOSURE_REL_NAME);
+    auto path_data = projection.GetData<string_t>(output, COL_CLOSURE_PATH);
+    auto depth_data = projection.GetData<int64_t>(output, COL_CLOSURE_DEPTH);
+    auto via_data = projection.GetData<string_t>(output, COL_CLOSURE_VIA);
+    auto rel_name_data = projection.GetData<string_t>(output, COL_CLOSURE_REL_NAME);
+
+    auto count = MinValue<idx_t>(state.rows.size() - state.offset, STANDARD_VECTOR_SIZE);
+    state.profile.Enter(UsdScanPhase::EMIT);
+    for (idx_t row = 0; row < count; row++) {
+        const auto &match = state.rows[state.offset + row];
+        if (path_data) {
+            const auto &path = match.node == DConstants::INVALID_INDEX ? state.start : graph.GetPath(match.node);
+            path_data[row] = StringVector::AddString(*path_out, path.GetString());
+        }
+        if (depth_data) {
+            depth_data[row] = NumericCast<int64_t>(match.depth);
+        }
+        // The start has no edge reaching it
+        if (via_data) {
+            if (match.edge) {
+                via_data[row] = StringVector::AddString(*via_out, graph.GetPath(match.via).GetString());
+            } else {
+                FlatVector::SetNull(*via_out, row, true);
+            }
+        }
+        if (rel_name_data) {
+            if (match.edge) {
+                rel_name_data[row] = StringVector::AddString(*rel_name_out, graph.GetName(match.edge->rel).GetString());
+            } else {
+                FlatVector::SetNull(*rel_name_out, row, true);
+            }
+        }
+    }
+    state.offset += count;
+
+    output.SetCardinality(count);
+    projection.FinalizeChunk(output);
+    state.tracker.AddRows(count);
+    state.profile.Enter(UsdScanPhase::NONE);
+    state.profile.CountStrings(output);
+    state.tracker.Flush(state.profile);
+}
+
+TableFunction UsdReferrersFunction::GetFunction() {
+    TableFunction func("usd_referrers", {LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR}, UsdReferrersExecute,
+                       UsdReferrersBind, UsdReferrersInit);
+    func.projection_pushdown = true;
+    UsdStageLoadOptions::RegisterParameters(func);
+    UsdScanFilter::RegisterParameters(func);
+    UsdScanStatistics::RegisterProfile<UsdRelationshipGraphGlobalState>(func);
+    return func;
+}
+
+TableFunction UsdRelationshipClosureFunction::GetFunction() {
+    TableFunction func("usd_relationship_closure",
+                       {LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR, LogicalTypeId::BIGINT},
+                       UsdRelationshipClosureExecute, UsdRelationshipClosureBind, UsdRelationshipClosureInit);
+    func.projection_pushdown = true;
+    UsdStageLoadOptions::RegisterParameters(func);
+    UsdScanFilter::RegisterParameters(func);
+    UsdScanStatistics::RegisterProfile<UsdRelationshipGraphGlobalState>(func);
+    func.named_parameters["direction"] = LogicalType::VARCHAR;
+    return func;
+}
+
+} // namespace duckdb
@@ -5,19 +5,33 @@
 #include <pxr/usd/usd/primRange.h>
 #include <pxr/usd/usd/relationship.h>
 #include <pxr/usd/sdf/path.h>
-#include <filesystem>
 
 namespace duckdb {
 
+// Table columns, in schema order
+static constexpr idx_t COL_PRIM_PATH = 0;
+static constexpr idx_t COL_REL_NAME = 1;
+static constexpr idx_t COL_TARGET_PATH = 2;
+static constexpr idx_t COL_TARGET_INDEX = 3;
+static constexpr idx_t COLUMN_COUNT = 4;
+// Rows per root layer spec, for estimates before the first complete scan
+static constexpr double ROWS_PER_SPEC = 0.05;
+
 // Bind data structure
 struct UsdRelationshipsBindData : public TableFunctionData {
-    std::string file_path;
-    explicit UsdRelationshipsBindData(std::string path) : file_path(std::move(path)) {}
+    // Files to scan (a path, the matches of a glob, or a list)
+    vector<std::string> files;
+    // Population mask and payload loading requested with mask := / load :=
+    UsdStageLoadOptions load_options;
+    // Path and relationship name predicates pushed down from the query
+    UsdScanFilter filter;
+    // Row estimate for the planner and the progress bar
+    UsdScanEstimate estimate;
+    explicit UsdRelationshipsBindData(vector<std::string> files_p) : files(std::move(files_p)) {}
 };
 
-// Global state for iteration
-struct UsdRelationshipsGlobalState : public GlobalTableFunctionState {
-    pxr::UsdStageRefPtr stage;
+// Per-thread cursor into the file currently being scanned
+struct UsdRelationshipsLocalState : public UsdMultiFileLocalState {
     std::unique_ptr<UsdPrimIterator> prim_iterator;
     pxr::UsdPrim current_prim;
     std::vector<pxr::UsdRelationship> current_relationships;
@@ -26,7 +40,36 @@ struct UsdRelationshipsGlobalState : public GlobalTableFunctionState {
     size_t target_index = 0;
     bool has_current_prim = false;
 
-    UsdRelationshipsGlobalState() = default;
+    // Claims the next file and loads the relationships of its first prim
+    bool NextFile(ClientContext &context, UsdMultiFileGlobalState &gstate,
+                  const UsdRelationshipsBindData &bind_data) {
+        has_current_prim = false;
+        prim_iterator.reset();
+        current_relationships.clear();
+        current_targets.clear();
+        if (!OpenNextFile(context, gstate, bind_data.files, bind_data.load_options.WithFilter(bind_data.filter))) {
+            return false;
+        }
+
+        // Create prim iterator over the prims that can satisfy the filters
+        prim_iterator = std::make_unique<UsdPrimIterator>(stage, bind_data.filter, &profile);
+
+        // Load first prim's relationships
+        if (prim_iterator->HasNext()) {
+            current_prim = prim_iterator->GetNext();
+            profile.Enter(UsdScanPhase::EXTRACT);
+            current_relationships = bind_data.filter.GetRelationships(current_prim);
+            relationship_index = 0;
+            target_index = 0;
+            has_current_prim = true;
+
+            // Load first relationship's targets if available
+            if (!current_relationships.empty()) {
+                current_relationships[0].GetTargets(&current_targets);
+            }
+        }
+        return true;
+    }
 };
 
 // Bind function
@@ -37,27 +80,8 @@ static unique_ptr<FunctionData> UsdRelationshipsBind(ClientContext &context, Tab
         throw BinderException("usd_relationships requires exactly one argument: file_path");
     }
 
-    auto file_path = input.inputs[0].GetValue<string>();
-
-    // Check for empty path
-    if (file_path.empty() || file_path.find_first_not_of(" \t\n\r") == std::string::npos) {
-        throw BinderException("usd_relationships: file_path cannot be empty");
-    }
-
-    // Check if file exists
-    if (!std::filesystem::exists(file_path)) {
-        throw BinderException("usd_relationships: USD file not found: " + file_path);
-    }
-
-    // Check if it's a directory
-    if (std::filesystem::is_directory(file_path)) {
-        throw BinderException("usd_relationships: path is a directory, not a file: " + file_path);
-    }
-
-    // Validate file extension
-    if (!UsdStageManager::IsValidUsdFile(file_path)) {
-        throw BinderException("usd_relationships: file must have a USD extension (.usd, .usda, .usdc, .usdz): " + file_path);
-    }
+    // One path, a glob pattern or a list of either
+    auto files = UsdFileList::Bind(context, "usd_relationships", input.inputs[0]);
 
     // Define output schema
     return_types = {
@@ -69,48 +93,56 @@ static unique_ptr<FunctionData> UsdRelationshipsBind(ClientContext &context, Tab
 
     names = {"prim_path", "rel_name", "target_path", "target_index"};
 
-    return make_uniq<UsdRelationshipsBindData>(file_path);
+    auto result = make_uniq<UsdRelationshipsBindData>(std::move(files));
+    result->estimate = UsdScanStatistics::Estimate(context, "usd_relationships", result->files, ROWS_PER_SPEC,
+                                                   input.named_parameters.empty(), COLUMN_COUNT);
+    result->load_options.Bind("usd_relationships", input.named_parameters);
+    result->filter.BindTraversal("usd_relationships", input.named_parameters);
+    return std::move(result);
 }
 
 // Init function
 static unique_ptr<GlobalTableFunctionState> UsdRelationshipsInit(ClientContext &context, TableFunctionInitInput &input) {
     auto &bind_data = input.bind_data->Cast<UsdRelationshipsBindData>();
-    auto state = make_uniq<UsdRelationshipsGlobalState>();
-
-    // Open USD stage
-    state->stage = UsdStageManager::OpenStage(bind_data.file_path);
-
-    // Create prim iterator
-    state->prim_iterator = std::make_unique<UsdPrimIterator>(state->stage);
-
-    // Load first prim's relationships
-    if (state->prim_iterator->HasNext()) {
-        state->current_prim = state->prim_iterator->GetNext();
-        state->current_relationships = state->current_prim.GetRelationships();
-        state->relationship_index = 0;
-        state->target_index = 0;
-        state->has_current_prim = true;
-
-        // Load first relationship's targets if available
-        if (!state->current_relationships.empty()) {
-            state->current_relationships[0].GetTargets(&state->current_targets);
-        }
-    }
-
+    auto state = make_uniq<UsdMultiFileGlobalState>(bind_data.files.size());
+    state->projection = UsdColumnProjection(input.column_ids, COLUMN_COUNT);
+    state->tracker.Start(context, bind_data.estimate, bind_data.filter.IsEmpty());
     return std::move(state);
 }
 
+// Each thread opens (through the stage cache) the stages of the files it claims
+static unique_ptr<LocalTableFunctionState> UsdRelationshipsInitLocal(ExecutionContext &context,
+                                                                     TableFunctionInitInput &input,
+                                                                     GlobalTableFunctionState *global_state) {
+    return make_uniq<UsdRelationshipsLocalState>();
+}
+
 // Execute function
 static void UsdRelationshipsExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
-    auto &state = data_p.global_state->Cast<UsdRelationshipsGlobalState>();
+    auto &bind_data = data_p.bind_data->Cast<UsdRelationshipsBindData>();
+    auto &gstate = data_p.global_state->Cast<UsdMultiFileGlobalState>();
+    auto &state = data_p.local_state->Cast<UsdRelationshipsLocalState>();
+    auto &projection = gstate.projection;
     idx_t count = 0;
 
-    auto prim_path_data = FlatVector::GetData<string_t>(output.data[0]);
-    auto rel_name_data = FlatVector::GetData<string_t>(output.data[1]);
-    auto target_path_data = FlatVector::GetData<string_t>(output.data[2]);
-    auto target_index_data = FlatVector::GetData<int32_t>(output.data[3]);
+    // Only projected columns are computed; unprojected ones get nullptr
+    auto prim_path_out = projection.GetVector(output, COL_PRIM_PATH);
+    auto rel_name_out = projection.GetVector(output, COL_REL_NAME);
+    auto target_path_out = projection.GetVector(output, COL_TARGET_PATH);
+    auto prim_path_data = projection.GetData<string_t>(output, COL_PRIM_PATH);
+    auto rel_name_data = projection.GetData<string_t>(output, COL_REL_NAME);
+    auto target_path_data = projection.GetData<string_t>(output, COL_TARGET_PATH);
+    auto target_index_data = projection.GetData<int32_t>(output, COL_TARGET_INDEX);
+
+    while (count < STANDARD_VECTOR_SIZE) {
+        if (!state.has_current_prim) {
+            // End of the file; a chunk never spans two files
+            if (count > 0 || !state.NextFile(context, gstate, bind_data)) {
+                break;
+            }
+            continue;
+        }
 
-    while (count < STANDARD_VECTOR_SIZE && state.has_current_prim) {
         // Check if we have targets to emit
         if (state.relationship_index < state.current_relationships.size() &&
             state.target_index < state.current_targets.size()) {
@@ -118,19 +150,25 @@ static void UsdRelationshipsExecute(ClientContext &context, TableFunctionInput &
             auto &rel = state.current_relationships[state.relationship_index];
             auto &target = state.current_targets[state.target_index];
 
-            // Convert target to absolute path if it's relative
-            pxr::SdfPath absolute_target = target;
-            if (target.IsAbsolutePath()) {
-                absolute_target = target;
-            } else {
-                absolute_target = target.MakeAbsolutePath(state.current_prim.GetPath());
-            }
-
             // Emit row
-            prim_path_data[count] = StringVector::AddString(output.data[0], state.current_prim.GetPath().GetString());
-            rel_name_data[count] = StringVector::AddString(output.data[1], rel.GetName().GetString());
-            target_path_data[count] = StringVector::AddString(output.data[2], absolute_target.GetString());
-            target_index_data[count] = static_cast<int32_t>(state.target_index);
+            state.profile.Enter(UsdScanPhase::EMIT);
+            if (prim_path_data) {
+                prim_path_data[count] = StringVector::AddString(*prim_path_out, state.current_prim.GetPath().GetString());
+            }
+            if (rel_name_data) {
+                rel_name_data[count] = StringVector::AddString(*rel_name_out, rel.GetName().GetString());
+            }
+            if (target_path_data) {
+                // Convert target to absolute path if it's relative
+                pxr::SdfPath absolute_target = target;
+                if (!target.IsAbsolutePath()) {
+                    absolute_target = target.MakeAbsolutePath(state.current_prim.GetPath());
+                }
+                target_path_data[count] = StringVector::AddString(*target_path_out, absolute_target.GetString());
+            }
+            if (target_index_data) {
+                target_index_data[count] = static_cast<int32_t>(state.target_index);
+            }
 
             count++;
             state.target_index++;
@@ -141,14 +179,17 @@ static void UsdRelationshipsExecute(ClientContext &context, TableFunctionInput &
 
             if (state.relationship_index < state.current_relationships.size()) {
                 // Load next relationship's targets
+                state.profile.Enter(UsdScanPhase::EXTRACT);
                 state.current_targets.clear();
                 state.current_relationships[state.relationship_index].GetTargets(&state.current_targets);
             }
         } else {
             // Move to next prim
             if (state.prim_iterator->HasNext()) {
+                state.profile.Enter(UsdScanPhase::TRAVERSE);
                 state.current_prim = state.prim_iterator->GetNext();
-                state.current_relationships = state.current_prim.GetRelationships();
+                state.profile.Enter(UsdScanPhase::EXTRACT);
+                state.current_relationships = bind_data.filter.GetRelationships(state.current_prim);
                 state.relationship_index = 0;
                 state.target_index = 0;
 
@@ -167,11 +208,31 @@ static void UsdRelationshipsExecute(ClientContext &context, TableFunctionInput &
     }
 
     output.SetCardinality(count);
+    if (count > 0) {
+        state.FinalizeChunk(gstate, output, bind_data.files);
+    }
+}
+
+static void UsdRelationshipsPushdownFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                           vector<unique_ptr<Expression>> &filters) {
+    auto &bind_data = bind_data_p->Cast<UsdRelationshipsBindData>();
+    UsdFilterColumns columns;
+    columns.prim_path = COL_PRIM_PATH;
+    columns.property_name = COL_REL_NAME;
+    bind_data.filter.Pushdown(get, filters, columns);
 }
 
 // Get the table function
 TableFunction UsdRelationshipsFunction::GetFunction() {
-    TableFunction func("usd_relationships", {LogicalTypeId::VARCHAR}, UsdRelationshipsExecute, UsdRelationshipsBind, UsdRelationshipsInit);
+    TableFunction func("usd_relationships", {LogicalTypeId::VARCHAR}, UsdRelationshipsExecute, UsdRelationshipsBind,
+                       UsdRelationshipsInit, UsdRelationshipsInitLocal);
+    func.get_partition_data = UsdMultiFileLocalState::GetPartitionData;
+    func.projection_pushdown = true;
+    UsdScanStatistics::Register<UsdRelationshipsBindData, UsdMultiFileGlobalState>(func);
+    UsdFileList::RegisterFilenameColumn(func);
+    UsdStageLoadOptions::RegisterParameters(func);
+    UsdScanFilter::RegisterParameters(func);
+    func.pushdown_complex_filter = UsdRelationshipsPushdownFilter;
     return func;
 }
 
@@ -0,0 +1,536 @@
+#include "usd_resolver.hpp"
+#include "duckdb/common/error_data.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/string_util.hpp"
+#include "duckdb/common/types/timestamp.hpp"
+#include "duckdb/main/client_context.hpp"
+#include "duckdb/main/database.hpp"
+
+#include <pxr/usd/ar/asset.h>
+#include <pxr/usd/ar/defineResolver.h>
+#include <pxr/usd/ar/resolvedPath.h>
+#include <pxr/usd/ar/resolver.h>
+#include <pxr/usd/ar/timestamp.h>
+#include <pxr/usd/ar/writableAsset.h>
+#include <pxr/base/plug/registry.h>
+#include <pxr/base/tf/diagnostic.h>
+#include <pxr/base/tf/type.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include "duckdb/common/windows.hpp"
+#else
+#include <dlfcn.h>
+#endif
+
+namespace duckdb {
+
+// Schemes DuckDB's FileSystem serves through extensions (httpfs, azure)
+static const char *const REMOTE_SCHEMES[] = {"s3",    "s3a",   "s3n",  "r2",   "gcs",   "gs",
+                                             "az",    "azure", "abfss", "http", "https", "hf"};
+
+// Resolver context object naming the database whose FileSystem reads the
+// remote layers of a stage. The database is held weakly, so that stages
+// cached process-wide do not keep a closed database alive.
+class UsdRemoteResolverContext {
+public:
+    UsdRemoteResolverContext() = default;
+    explicit UsdRemoteResolverContext(const shared_ptr<DatabaseInstance> &db_p) : db(db_p), id(db_p.get()) {
+    }
+
+    // Null once the database was closed
+    shared_ptr<DatabaseInstance> GetDatabase() const {
+        return db.lock();
+    }
+
+    bool operator<(const UsdRemoteResolverContext &other) const {
+        return std::less<const DatabaseInstance *>()(id, other.id);
+    }
+    bool operator==(const UsdRemoteResolverContext &other) const {
+        return id == other.id;
+    }
+    friend size_t hash_value(const UsdRemoteResolverContext &context) {
+        return std::hash<const DatabaseInstance *>()(context.id);
+    }
+
+private:
+    weak_ptr<DatabaseInstance> db;
+    const DatabaseInstance *id = nullptr;
+};
+
+} // namespace duckdb
+
+PXR_NAMESPACE_OPEN_SCOPE
+AR_DECLARE_RESOLVER_CONTEXT(duckdb::UsdRemoteResolverContext);
+PXR_NAMESPACE_CLOSE_SCOPE
+
+namespace duckdb {
+
+bool UsdRemoteFileSystem::IsRemotePath(const std::string &path) {
+    auto scheme_end = path.find("://");
+    if (scheme_end == std::string::npos) {
+        return false;
+    }
+    auto scheme = StringUtil::Lower(path.substr(0, scheme_end));
+    for (auto remote_scheme : REMOTE_SCHEMES) {
+        if (scheme == remote_scheme) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int64_t ModificationTime(FileSystem &fs, FileHandle &handle) {
+    return Timestamp::GetEpochMicroSeconds(fs.GetLastModifiedTime(handle));
+}
+
+bool UsdRemoteFileSystem::FileExists(ClientContext &context, const std::string &path) {
+    return FileSystem::GetFileSystem(context).FileExists(path);
+}
+
+static bool StatFile(FileSystem &fs, const std::string &path, int64_t &mtime, uint64_t &size) {
+    try {
+        auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ | FileFlags::FILE_FLAGS_NULL_IF_NOT_EXISTS);
+        if (!handle) {
+            return false;
+        }
+        mtime = ModificationTime(fs, *handle);
+        size = static_cast<uint64_t>(fs.GetFileSize(*handle));
+        return true;
+    } catch (std::exception &) {
+        // Unreachable files are treated like deleted ones: the entry is stale
+        return false;
+    }
+}
+
+bool UsdRemoteFileSystem::Stat(ClientContext &context, const std::string &path, int64_t &mtime, uint64_t &size) {
+    return StatFile(FileSystem::GetFileSystem(context), path, mtime, size);
+}
+
+pxr::ArResolverContext UsdRemoteFileSystem::CreateResolverContext(ClientContext &context, const std::string &path) {
+    std::vector<pxr::ArResolverContext> contexts;
+    // Search paths and the like of local layers
+    contexts.push_back(pxr::ArGetResolver().CreateDefaultContextForAsset(path));
+    contexts.push_back(pxr::ArResolverContext(UsdRemoteResolverContext(context.db)));
+    return pxr::ArResolverContext(contexts);
+}
+
+UsdRemoteFileSystem::ScopedContext::ScopedContext(ClientContext &context)
+    : binder(pxr::ArResolverContext(UsdRemoteResolverContext(context.db))) {
+}
+
+// Process-wide LRU cache of remote layer blocks. Blocks are keyed by the
+// identity of their file (path, modification time and size), so a layer
+// reopened after its stage was evicted is served from memory while unchanged.
+// Every reader looks the identity up through its own database's FileSystem
+// first, so blocks are never served to a database that cannot read the file.
+struct UsdBlockCache {
+    struct Block {
+        std::string key;
+        std::shared_ptr<const std::string> data;
+    };
+    std::mutex lock;
+    // Most recently used block first
+    std::list<Block> lru;
+    std::unordered_map<std::string, std::list<Block>::iterator> index;
+    idx_t resident_bytes = 0;
+
+    static UsdBlockCache &Get() {
+        static UsdBlockCache cache;
+        return cache;
+    }
+
+    std::shared_ptr<const std::string> Find(const std::string &key) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto entry = index.find(key);
+        if (entry == index.end()) {
+            return nullptr;
+        }
+        lru.splice(lru.begin(), lru, entry->second);
+        return entry->second->data;
+    }
+
+    void Insert(const std::string &key, std::shared_ptr<const std::string> data) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (index.find(key) != index.end()) {
+            // Fetched concurrently by another reader
+            return;
+        }
+        resident_bytes += data->size();
+        lru.push_front(Block {key, std::move(data)});
+        index[key] = lru.begin();
+        while (lru.size() > 1 && resident_bytes > UsdRemoteFileSystem::BLOCK_CACHE_LIMIT) {
+            resident_bytes -= lru.back().data->size();
+            index.erase(lru.back().key);
+            lru.pop_back();
+        }
+    }
+};
+
+// A remote layer. Reads are served from fixed-size blocks fetched with ranged
+// requests; runs of missing blocks are fetched with a single request. Each
+// fetch opens a handle of its own through the FileSystem of the database that
+// opened the layer: an open handle would tie the layer (which cached stages
+// keep alive) to that database's FileSystem after the database is closed.
+class UsdRemoteAsset : public pxr::ArAsset {
+public:
+    UsdRemoteAsset(weak_ptr<DatabaseInstance> db_p, std::string path_p, int64_t mtime_p, size_t size_p)
+        : db(std::move(db_p)), path(std::move(path_p)), mtime(mtime_p), size(size_p),
+          identity(path + "@" + std::to_string(mtime) + ":" + std::to_string(size)) {
+    }
+
+    size_t GetSize() const override {
+        return size;
+    }
+
+    // Whole-layer reads (text layers) bypass the block cache: they would
+    // only evict blocks of crate files that are read piecewise
+    std::shared_ptr<const char> GetBuffer() const override {
+        std::shared_ptr<char> buffer(new char[size], std::default_delete<char[]>());
+        try {
+            ReadRange(buffer.get(), size, 0);
+        } catch (std::exception &ex) {
+            ReportError(ex);
+            return nullptr;
+        }
+        return buffer;
+    }
+
+    size_t Read(void *buffer, size_t count, size_t offset) const override {
+        if (offset >= size) {
+            return 0;
+        }
+        count = MinValue<size_t>(count, size - offset);
+        if (count == 0) {
+            return 0;
+        }
+        auto first = offset / UsdRemoteFileSystem::BLOCK_SIZE;
+        auto last = (offset + count - 1) / UsdRemoteFileSystem::BLOCK_SIZE;
+        vector<std::shared_ptr<const std::string>> blocks;
+        try {
+            blocks = FetchBlocks(first, last);
+        } catch (std::exception &ex) {
+            ReportError(ex);
+            return 0;
+        }
+
+        auto out = static_cast<char *>(buffer);
+        size_t copied = 0;
+        for (idx_t block_index = first; block_index <= last; block_index++) {
+            auto &block = *blocks[block_index - first];
+            size_t block_start = block_index * UsdRemoteFileSystem::BLOCK_SIZE;
+            size_t begin = MaxValue<size_t>(offset, block_start) - block_start;
+            size_t end = MinValue<size_t>(offset + count, block_start + block.size()) - block_start;
+            memcpy(out + copied, block.data() + begin, end - begin);
+            copied += end - begin;
+        }
+        return copied;
+    }
+
+    // Remote layers have no local file to map
+    std::pair<FILE *, size_t> GetFileUnsafe() const override {
+        return std::make_pair(nullptr, 0);
+    }
+
+private:
+    std::string BlockKey(idx_t block_index) const {
+        return identity + "#" + std::to_string(block_index);
+    }
+
+    void ReadRange(char *buffer, idx_t count, idx_t offset) const {
+        auto database = db.lock();
+        if (!database) {
+            throw IOException("the database that opened the layer was closed");
+        }
+        auto &fs = FileSystem::GetFileSystem(*database);
+        auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ);
+        // Blocks of different versions of the file must not be mixed
+        if (ModificationTime(fs, *handle) != mtime || static_cast<size_t>(fs.GetFileSize(*handle)) != size) {
+            throw IOException("the file changed while it was being read");
+        }
+        handle->Read(buffer, count, offset);
+    }
+
+    vector<std::shared_ptr<const std::string>> FetchBlocks(idx_t first, idx_t last) const {
+        auto &cache = UsdBlockCache::Get();
+        vector<std::shared_ptr<const std::string>> result(last - first + 1);
+        for (idx_t block_index = first; block_index <= last; block_index++) {
+            result[block_index - first] = cache.Find(BlockKey(block_index));
+        }
+        idx_t run_start = first;
+        while (run_start <= last) {
+            if (result[run_start - first]) {
+                run_start++;
+                continue;
+            }
+            auto run_end = run_start;
+            while (run_end < last && !result[run_end + 1 - first]) {
+                run_end++;
+            }
+            auto start = run_start * UsdRemoteFileSystem::BLOCK_SIZE;
+            auto end = MinValue<idx_t>((run_end + 1) * UsdRemoteFileSystem::BLOCK_SIZE, size);
+            std::string bytes(end - start, '\0');
+            ReadRange(&bytes[0], end - start, start);
+            for (auto block_index = run_start; block_index <= run_end; block_index++) {
+                auto block = std::make_shared<const std::string>(
+                    bytes.substr((block_index - run_start) * UsdRemoteFileSystem::BLOCK_SIZE,
+                                 UsdRemoteFileSystem::BLOCK_SIZE));
+                cache.Insert(BlockKey(block_index), block);
+                result[block_index - first] = std::move(block);
+            }
+            run_start = run_end + 1;
+        }
+        return result;
+    }
+
+    void ReportError(std::exception &ex) const {
+        ErrorData error(ex);
+        TF_RUNTIME_ERROR("Failed to read '%s': %s", path.c_str(), error.RawMessage().c_str());
+    }
+
+    weak_ptr<DatabaseInstance> db;
+    std::string path;
+    int64_t mtime;
+    size_t size;
+    std::string identity;
+};
+
+// Removes "." and ".." segments from the path of a URI
+static std::string NormalizeUri(const std::string &uri) {
+    auto scheme_end = uri.find("://");
+    if (scheme_end == std::string::npos) {
+        return uri;
+    }
+    auto path_start = uri.find('/', scheme_end + 3);
+    if (path_start == std::string::npos) {
+        return uri;
+    }
+    vector<std::string> segments;
+    for (auto &segment : StringUtil::Split(uri.substr(path_start + 1), '/')) {
+        if (segment.empty() || segment == ".") {
+            continue;
+        }
+        if (segment == "..") {
+            if (!segments.empty()) {
+                segments.pop_back();
+            }
+            continue;
+        }
+        segments.push_back(segment);
+    }
+    return uri.substr(0, path_start) + "/" + StringUtil::Join(segments, "/");
+}
+
+// Resolves an asset path authored in a remote layer (a sublayer, reference or
+// payload) against that layer's URI. URIs are used as they are.
+static std::string AnchorAssetPath(const std::string &asset_path, const pxr::ArResolvedPath &anchor) {
+    const auto &base = anchor.GetPathString();
+    auto scheme_end = base.find("://");
+    if (asset_path.empty() || UsdRemoteFileSystem::IsRemotePath(asset_path) || scheme_end == std::string::npos) {
+        return NormalizeUri(asset_path);
+    }
+    auto authority_end = base.find('/', scheme_end + 3);
+    if (authority_end == std::string::npos) {
+        authority_end = base.size();
+    }
+    if (asset_path[0] == '/') {
+        // Absolute paths are relative to the bucket or host of the anchor
+        return NormalizeUri(base.substr(0, authority_end) + asset_path);
+    }
+    auto directory_end = base.rfind('/');
+    if (directory_end == std::string::npos || directory_end < authority_end) {
+        return NormalizeUri(base.substr(0, authority_end) + "/" + asset_path);
+    }
+    return NormalizeUri(base.substr(0, directory_end + 1) + asset_path);
+}
+
+// URI resolver for REMOTE_SCHEMES. Identifiers are the URIs themselves;
+// resolution does not touch the network, opening an asset does, through the
+// database named by the bound resolver context.
+class UsdRemoteResolver : public pxr::ArResolver {
+protected:
+    shared_ptr<DatabaseInstance> GetDatabase() const {
+        auto context = _GetCurrentContextObject<UsdRemoteResolverContext>();
+        return context ? context->GetDatabase() : nullptr;
+    }
+
+    std::string _CreateIdentifier(const std::string &asset_path, const pxr::ArResolvedPath &anchor) const override {
+        return AnchorAssetPath(asset_path, anchor);
+    }
+
+    std::string _CreateIdentifierForNewAsset(const std::string &asset_path,
+                                             const pxr::ArResolvedPath &anchor) const override {
+        return AnchorAssetPath(asset_path, anchor);
+    }
+
+    pxr::ArResolvedPath _Resolve(const std::string &asset_path) const override {
+        return pxr::ArResolvedPath(asset_path);
+    }
+
+    pxr::ArResolvedPath _ResolveForNewAsset(const std::string &asset_path) const override {
+        return pxr::ArResolvedPath(asset_path);
+    }
+
+    pxr::ArTimestamp _GetModificationTimestamp(const std::string &asset_path,
+                                               const pxr::ArResolvedPath &resolved_path) const override {
+        int64_t mtime;
+        uint64_t size;
+        auto db = GetDatabase();
+        if (!db || !StatFile(FileSystem::GetFileSystem(*db), resolved_path.GetPathString(), mtime, size)) {
+            return pxr::ArTimestamp();
+        }
+        return pxr::ArTimestamp(double(mtime) / Interval::MICROS_PER_SEC);
+    }
+
+    std::shared_ptr<pxr::ArAsset> _OpenAsset(const pxr::ArResolvedPath &resolved_path) const override {
+        const auto &path = resolved_path.GetPathString();
+        auto db = GetDatabase();
+        if (!db) {
+            TF_RUNTIME_ERROR("Cannot open '%s': remote USD layers can only be opened for an open DuckDB database",
+                             path.c_str());
+            return nullptr;
+        }
+        auto &fs = FileSystem::GetFileSystem(*db);
+        try {
+            auto handle = fs.OpenFile(path, FileFlags::FILE_FLAGS_READ);
+            auto size = static_cast<size_t>(fs.GetFileSize(*handle));
+            return std::make_shared<UsdRemoteAsset>(weak_ptr<DatabaseInstance>(db), path,
+                                                    ModificationTime(fs, *handle), size);
+        } catch (std::exception &ex) {
+            ErrorData error(ex);
+            TF_RUNTIME_ERROR("Failed to open '%s': %s", path.c_str(), error.RawMessage().c_str());
+            return nullptr;
+        }
+    }
+
+    // Remote layers are read-only
+    std::shared_ptr<pxr::ArWritableAsset> _OpenAssetForWrite(const pxr::ArResolvedPath &resolved_path,
+                                                             WriteMode write_mode) const override {
+        return nullptr;
+    }
+};
+
+// Path of the shared library (or executable, for static builds) holding
+// this code, which OpenUSD loads when it instantiates the resolver
+static std::string GetLibraryPath() {
+#ifdef _WIN32
+    HMODULE module = nullptr;
+    if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                            reinterpret_cast<LPCSTR>(&GetLibraryPath), &module)) {
+        return std::string();
+    }
+    char path[MAX_PATH];
+    auto length = GetModuleFileNameA(module, path, MAX_PATH);
+    return StringUtil::Replace(std::string(path, length), "\\", "/");
+#else
+    Dl_info info;
+    if (!dladdr(reinterpret_cast<void *>(&GetLibraryPath), &info) || !info.dli_fname) {
+        return std::string();
+    }
+    return info.dli_fname;
+#endif
+}
+
+// Creates a new directory only the current user can access, so that nobody
+// else can plant or swap the plugInfo written into it (empty on failure)
+static std::string CreatePrivateDirectory() {
+    std::error_code ec;
+    auto temp = std::filesystem::temp_directory_path(ec);
+    if (ec) {
+        return std::string();
+    }
+#ifdef _WIN32
+    // The temporary directory is per user; the directory must not exist yet
+    auto directory = temp / ("duckdb_usd_plugin_" + std::to_string(GetCurrentProcessId()));
+    if (!std::filesystem::create_directory(directory, ec) || ec) {
+        return std::string();
+    }
+    return directory.string();
+#else
+    // mkdtemp picks an unused name and creates the directory with mode 0700
+    auto pattern = (temp / "duckdb_usd_plugin_XXXXXX").string();
+    if (!mkdtemp(&pattern[0])) {
+        return std::string();
+    }
+    return pattern;
+#endif
+}
+
+// Removes a generated plugInfo and its directory. OpenUSD reads plugInfo
+// files when they are registered and loads the library from its absolute
+// LibraryPath, so neither is needed afterwards.
+static void RemovePlugInfo(const std::string &plug_info_path) {
+    std::error_code ec;
+    std::filesystem::path path(plug_info_path);
+    std::filesystem::remove(path, ec);
+    std::filesystem::remove(path.parent_path(), ec);
+}
+
+// OpenUSD discovers resolvers through plugInfo.json files. The extension can
+// be loaded from anywhere, so its plugInfo is generated at load time in a
+// private temporary directory; returns its path (empty on failure).
+static std::string WritePlugInfo(const std::string &type_name) {
+    auto library_path = GetLibraryPath();
+    if (library_path.empty()) {
+        return std::string();
+    }
+    auto directory_path = CreatePrivateDirectory();
+    if (directory_path.empty()) {
+        return std::string();
+    }
+    std::filesystem::path directory(directory_path);
+
+    vector<std::string> schemes;
+    for (auto scheme : REMOTE_SCHEMES) {
+        schemes.push_back("\"" + std::string(scheme) + "\"");
+    }
+    auto plug_info_path = (directory / "plugInfo.json").string();
+    std::ofstream plug_info(plug_info_path, std::ios::trunc);
+    plug_info << "{\n"
+              << "  \"Plugins\": [{\n"
+              << "    \"Type\": \"library\",\n"
+              << "    \"Name\": \"duckdb_usd\",\n"
+              << "    \"Root\": \".\",\n"
+              << "    \"LibraryPath\": \"" << library_path << "\",\n"
+              << "    \"Info\": {\n"
+              << "      \"Types\": {\n"
+              << "        \"" << type_name << "\": {\n"
+              << "          \"bases\": [\"ArResolver\"],\n"
+              << "          \"uriSchemes\": [" << StringUtil::Join(schemes, ", ") << "]\n"
+              << "        }\n"
+              << "      }\n"
+              << "    }\n"
+              << "  }]\n"
+              << "}\n";
+    plug_info.close();
+    if (!plug_info) {
+        RemovePlugInfo(plug_info_path);
+        return std::string();
+    }
+    return plug_info_path;
+}
+
+void UsdRemoteFileSystem::Register() {
+    static std::once_flag registered;
+    std::call_once(registered, [] {
+        auto type = pxr::TfType::Define<UsdRemoteResolver, pxr::TfType::Bases<pxr::ArResolver>>();
+        type.SetFactory<pxr::ArResolverFactory<UsdRemoteResolver>>();
+        auto plug_info_path = WritePlugInfo(type.GetTypeName());
+        if (plug_info_path.empty()) {
+            // Local files keep working; remote paths fail to resolve
+            TF_WARN("Could not register the USD resolver for remote files");
+            return;
+        }
+        pxr::PlugRegistry::GetInstance().RegisterPlugins(plug_info_path);
+        RemovePlugInfo(plug_info_path);
+    });
+}
+
+} // namespace duckdb
@@ -0,0 +1,330 @@
+#include "usd_scene.hpp"
+#include "usd_helpers.hpp"
+#include "usd_xforms.hpp"
+
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/modelAPI.h>
+#include <pxr/usd/usd/relationship.h>
+#include <pxr/usd/usdGeom/xformable.h>
+#include <pxr/usd/usdGeom/xformCache.h>
+
+namespace duckdb {
+
+// Table columns, in schema order: those of usd_prims, then of usd_xforms,
+// then counts of the rows usd_properties and usd_relationships give a prim
+static constexpr idx_t COL_PRIM_PATH = 0;
+static constexpr idx_t COL_PARENT_PATH = 1;
+static constexpr idx_t COL_NAME = 2;
+static constexpr idx_t COL_PRIM_TYPE = 3;
+static constexpr idx_t COL_KIND = 4;
+static constexpr idx_t COL_ACTIVE = 5;
+static constexpr idx_t COL_INSTANCEABLE = 6;
+static constexpr idx_t COL_IS_XFORMABLE = 7;
+static constexpr idx_t COL_X = 8;
+static constexpr idx_t COL_Y = 9;
+static constexpr idx_t COL_Z = 10;
+static constexpr idx_t COL_HAS_ROTATION = 11;
+static constexpr idx_t COL_HAS_SCALE = 12;
+static constexpr idx_t COL_WORLD_MATRIX = 13;
+static constexpr idx_t COL_PROPERTY_COUNT = 14;
+static constexpr idx_t COL_RELATIONSHIP_COUNT = 15;
+static constexpr idx_t COL_TARGET_COUNT = 16;
+static constexpr idx_t COLUMN_COUNT = 17;
+// Rows per root layer spec, for estimates before the first complete scan
+static constexpr double ROWS_PER_SPEC = 0.25;
+
+static constexpr idx_t MATRIX_SIZE = 16;
+
+static const std::string UNDEFINED_TYPE = "<undefined>";
+
+struct UsdSceneBindData : public TableFunctionData {
+    // Files to scan (a path, the matches of a glob, or a list)
+    vector<std::string> files;
+    // Population mask and payload loading requested with mask := / load :=
+    UsdStageLoadOptions load_options;
+    // Path, type and kind predicates pushed down from the query
+    UsdScanFilter filter;
+    // Row estimate for the planner and the progress bar
+    UsdScanEstimate estimate;
+    // Time at which transforms are evaluated (time := , default time otherwise)
+    pxr::UsdTimeCode time = pxr::UsdTimeCode::Default();
+    explicit UsdSceneBindData(vector<std::string> files_p) : files(std::move(files_p)) {}
+};
+
+// Per-thread cursor into the file currently being scanned
+struct UsdSceneLocalState : public UsdMultiFileLocalState {
+    std::unique_ptr<UsdPrimIterator> prim_iterator;
+    // One cache per file: parents' transforms are computed once for all
+    // their descendants
+    std::unique_ptr<pxr::UsdGeomXformCache> xform_cache;
+    // Dictionaries of the low-cardinality prim_type and kind columns
+    UsdTokenDictionary prim_types;
+    UsdTokenDictionary kinds;
+    pxr::SdfPathVector targets;
+
+    // Claims the next file and starts iterating its prims
+    bool NextFile(ClientContext &context, UsdMultiFileGlobalState &gstate, const UsdSceneBindData &bind_data) {
+        prim_iterator.reset();
+        if (!OpenNextFile(context, gstate, bind_data.files, bind_data.load_options.WithFilter(bind_data.filter))) {
+            return false;
+        }
+        prim_iterator = std::make_unique<UsdPrimIterator>(stage, bind_data.filter, &profile);
+        xform_cache = std::make_unique<pxr::UsdGeomXformCache>(bind_data.time);
+        return true;
+    }
+};
+
+static unique_ptr<FunctionData> UsdSceneBind(ClientContext &context, TableFunctionBindInput &input,
+                                             vector<LogicalType> &return_types, vector<string> &names) {
+    if (input.inputs.size() != 1) {
+        throw BinderException("usd_scene requires exactly one argument: file_path");
+    }
+
+    // One path, a glob pattern or a list of either
+    auto files = UsdFileList::Bind(context, "usd_scene", input.inputs[0]);
+
+    return_types = {
+        LogicalTypeId::VARCHAR,  // prim_path
+        LogicalTypeId::VARCHAR,  // parent_path
+        LogicalTypeId::VARCHAR,  // name
+        LogicalTypeId::VARCHAR,  // prim_type
+        LogicalTypeId::VARCHAR,  // kind
+        LogicalTypeId::BOOLEAN,  // active
+        LogicalTypeId::BOOLEAN,  // instanceable
+        LogicalTypeId::BOOLEAN,  // is_xformable
+        LogicalTypeId::DOUBLE,   // x
+        LogicalTypeId::DOUBLE,   // y
+        LogicalTypeId::DOUBLE,   // z
+        LogicalTypeId::BOOLEAN,  // has_rotation
+        LogicalTypeId::BOOLEAN,  // has_scale
+        LogicalType::ARRAY(LogicalType::DOUBLE, MATRIX_SIZE),  // world_matrix
+        LogicalTypeId::BIGINT,   // property_count
+        LogicalTypeId::BIGINT,   // relationship_count
+        LogicalTypeId::BIGINT    // target_count
+    };
+
+    names = {"prim_path", "parent_path", "name", "prim_type", "kind", "active", "instanceable", "is_xformable",
+             "x", "y", "z", "has_rotation", "has_scale", "world_matrix",
+             "property_count", "relationship_count", "target_count"};
+
+    auto result = make_uniq<UsdSceneBindData>(std::move(files));
+    result->estimate = UsdScanStatistics::Estimate(context, "usd_scene", result->files, ROWS_PER_SPEC,
+                                                   input.named_parameters.empty(), COLUMN_COUNT);
+    result->load_options.Bind("usd_scene", input.named_parameters);
+    result->filter.BindTraversal("usd_scene", input.named_parameters);
+    for (auto &kv : input.named_parameters) {
+        if (kv.first == "time" && !kv.second.IsNull()) {
+            result->time = pxr::UsdTimeCode(kv.second.GetValue<double>());
+        }
+    }
+    return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> UsdSceneInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<UsdSceneBindData>();
+    auto state = make_uniq<UsdMultiFileGlobalState>(bind_data.files.size());
+    state->projection = UsdColumnProjection(input.column_ids, COLUMN_COUNT);
+    state->tracker.Start(context, bind_data.estimate, bind_data.filter.IsEmpty());
+    return std::move(state);
+}
+
+// Each thread opens (through the stage cache) the stages of the files it claims
+static unique_ptr<LocalTableFunctionState> UsdSceneInitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+                                                             GlobalTableFunctionState *global_state) {
+    return make_uniq<UsdSceneLocalState>();
+}
+
+static void UsdSceneExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &bind_data = data_p.bind_data->Cast<UsdSceneBindData>();
+    auto &gstate = data_p.global_state->Cast<UsdMultiFileGlobalState>();
+    auto &state = data_p.local_state->Cast<UsdSceneLocalState>();
+    auto &projection = gstate.projection;
+
+    // Only projected columns are computed; unprojected ones get nullptr, and
+    // each group of columns is only looked up when one of them is projected
+    auto prim_path_out = projection.GetVector(output, COL_PRIM_PATH);
+    auto parent_path_out = projection.GetVector(output, COL_PARENT_PATH);
+    auto name_out = projection.GetVector(output, COL_NAME);
+    auto prim_type_out = projection.GetVector(output, COL_PRIM_TYPE);
+    auto kind_out = projection.GetVector(output, COL_KIND);
+    auto prim_path_data = projection.GetData<string_t>(output, COL_PRIM_PATH);
+    auto parent_path_data = projection.GetData<string_t>(output, COL_PARENT_PATH);
+    auto name_data = projection.GetData<string_t>(output, COL_NAME);
+    auto active_data = projection.GetData<bool>(output, COL_ACTIVE);
+    auto instanceable_data = projection.GetData<bool>(output, COL_INSTANCEABLE);
+    auto is_xformable_data = projection.GetData<bool>(output, COL_IS_XFORMABLE);
+    Vector *transform_out[] = {projection.GetVector(output, COL_X),
+                               projection.GetVector(output, COL_Y),
+                               projection.GetVector(output, COL_Z),
+                               projection.GetVector(output, COL_HAS_ROTATION),
+                               projection.GetVector(output, COL_HAS_SCALE),
+                               projection.GetVector(output, COL_WORLD_MATRIX)};
+    auto x_data = projection.GetData<double>(output, COL_X);
+    auto y_data = projection.GetData<double>(output, COL_Y);
+    auto z_data = projection.GetData<double>(output, COL_Z);
+    auto has_rotation_data = projection.GetData<bool>(output, COL_HAS_ROTATION);
+    auto has_scale_data = projection.GetData<bool>(output, COL_HAS_SCALE);
+    auto world_matrix_out = projection.GetVector(output, COL_WORLD_MATRIX);
+    auto property_count_data = projection.GetData<int64_t>(output, COL_PROPERTY_COUNT);
+    auto relationship_count_data = projection.GetData<int64_t>(output, COL_RELATIONSHIP_COUNT);
+    auto target_count_data = projection.GetData<int64_t>(output, COL_TARGET_COUNT);
+    bool need_basis = has_rotation_data || has_scale_data;
+    bool need_transform = x_data || y_data || z_data || world_matrix_out || need_basis;
+    bool need_relationships = relationship_count_data || target_count_data;
+
+    idx_t count = 0;
+    while (count < STANDARD_VECTOR_SIZE) {
+        // A chunk never spans two files
+        if (!state.prim_iterator || !state.prim_iterator->HasNext()) {
+            if (count > 0 || !state.NextFile(context, gstate, bind_data)) {
+                break;
+            }
+            continue;
+        }
+        state.profile.Enter(UsdScanPhase::TRAVERSE);
+        auto prim = state.prim_iterator->GetNext();
+
+        // Paths and names reference the strings of the stage's SdfPaths and
+        // tokens, which the stage keeps alive. Instance proxy paths are only
+        // held by the prim handle, so those are copied.
+        bool copy_strings = prim.IsInstanceProxy();
+        state.profile.Enter(UsdScanPhase::EMIT);
+        if (prim_path_data) {
+            const auto &path = prim.GetPath().GetString();
+            prim_path_data[count] = copy_strings ? StringVector::AddString(*prim_path_out, path) : UsdStringRef(path);
+        }
+        if (parent_path_data) {
+            auto parent = prim.GetParent();
+            if (!parent) {
+                parent_path_data[count] = string_t("", 0);
+            } else if (copy_strings || parent.IsInstanceProxy()) {
+                parent_path_data[count] = StringVector::AddString(*parent_path_out, parent.GetPath().GetString());
+            } else {
+                parent_path_data[count] = UsdStringRef(parent.GetPath().GetString());
+            }
+        }
+        if (name_data) {
+            const auto &name = prim.GetName().GetString();
+            name_data[count] = copy_strings ? StringVector::AddString(*name_out, name) : UsdStringRef(name);
+        }
+        if (prim_type_out) {
+            state.prim_types.Select(count, prim.GetTypeName(), UNDEFINED_TYPE);
+        }
+        if (kind_out) {
+            pxr::TfToken kind_token;
+            pxr::UsdModelAPI(prim).GetKind(&kind_token);
+            state.kinds.Select(count, kind_token);
+        }
+        if (active_data) {
+            active_data[count] = prim.IsActive();
+        }
+        if (instanceable_data) {
+            instanceable_data[count] = prim.IsInstanceable();
+        }
+
+        // Transforms of Xformable prims, from the file's shared cache; NULL
+        // for the others
+        state.profile.Enter(UsdScanPhase::EXTRACT);
+        bool is_xformable = (is_xformable_data || need_transform) && prim.IsA<pxr::UsdGeomXformable>();
+        if (is_xformable_data) {
+            is_xformable_data[count] = is_xformable;
+        }
+        if (need_transform && !is_xformable) {
+            for (auto vector : transform_out) {
+                if (vector) {
+                    FlatVector::SetNull(*vector, count, true);
+                }
+            }
+        } else if (need_transform) {
+            auto world_transform = state.xform_cache->GetLocalToWorldTransform(prim);
+            auto translation = world_transform.ExtractTranslation();
+            if (x_data) {
+                x_data[count] = translation[0];
+            }
+            if (y_data) {
+                y_data[count] = translation[1];
+            }
+            if (z_data) {
+                z_data[count] = translation[2];
+            }
+            if (world_matrix_out) {
+                UsdWriteMatrix(*world_matrix_out, count, world_transform);
+            }
+            if (need_basis) {
+                UsdXformBasis basis(world_transform);
+                if (has_rotation_data) {
+                    has_rotation_data[count] = basis.HasRotation();
+                }
+                if (has_scale_data) {
+                    has_scale_data[count] = basis.HasScale();
+                }
+            }
+        }
+
+        // Counts of the rows usd_properties and usd_relationships give the
+        // prim; names are enough for properties, targets are only resolved
+        // when target_count is projected
+        if (property_count_data) {
+            property_count_data[count] = NumericCast<int64_t>(prim.GetPropertyNames().size());
+        }
+        if (need_relationships) {
+            auto relationships = prim.GetRelationships();
+            if (relationship_count_data) {
+                relationship_count_data[count] = NumericCast<int64_t>(relationships.size());
+            }
+            if (target_count_data) {
+                idx_t targets = 0;
+                for (const auto &rel : relationships) {
+                    state.targets.clear();
+                    rel.GetTargets(&state.targets);
+                    targets += state.targets.size();
+                }
+                target_count_data[count] = NumericCast<int64_t>(targets);
+            }
+        }
+
+        count++;
+    }
+
+    output.SetCardinality(count);
+    if (count > 0) {
+        for (auto vector : {prim_path_out, parent_path_out, name_out}) {
+            if (vector) {
+                UsdKeepStageAlive(*vector, state.stage);
+            }
+        }
+        if (prim_type_out) {
+            state.prim_types.Finalize(*prim_type_out, count);
+        }
+        if (kind_out) {
+            state.kinds.Finalize(*kind_out, count);
+        }
+        state.FinalizeChunk(gstate, output, bind_data.files);
+    }
+}
+
+static void UsdScenePushdownFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                   vector<unique_ptr<Expression>> &filters) {
+    auto &bind_data = bind_data_p->Cast<UsdSceneBindData>();
+    UsdFilterColumns columns;
+    columns.prim_path = COL_PRIM_PATH;
+    columns.prim_type = COL_PRIM_TYPE;
+    columns.kind = COL_KIND;
+    bind_data.filter.Pushdown(get, filters, columns);
+}
+
+TableFunction UsdSceneFunction::GetFunction() {
+    TableFunction func("usd_scene", {LogicalTypeId::VARCHAR}, UsdSceneExecute, UsdSceneBind, UsdSceneInit,
+                       UsdSceneInitLocal);
+    func.get_partition_data = UsdMultiFileLocalState::GetPartitionData;
+    func.projection_pushdown = true;
+    UsdScanStatistics::Register<UsdSceneBindData, UsdMultiFileGlobalState>(func);
+    UsdFileList::RegisterFilenameColumn(func);
+    UsdStageLoadOptions::RegisterParameters(func);
+    UsdScanFilter::RegisterParameters(func);
+    func.pushdown_complex_filter = UsdScenePushdownFilter;
+    func.named_parameters["time"] = LogicalType::DOUBLE;
+    return func;
+}
+
+} // namespace duckdb
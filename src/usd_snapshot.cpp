@@ -0,0 +1,279 @@
+#include "usd_snapshot.hpp"
+#include "usd_helpers.hpp"
+#include "usd_resolver.hpp"
+#include "duckdb/common/exception.hpp"
+#include "duckdb/main/connection.hpp"
+#include "duckdb/main/database_manager.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+
+#include <filesystem>
+#include <functional>
+#include <map>
+
+namespace duckdb {
+
+// Tables of a snapshot other than layers, each filled by the usd_* scan of
+// the same name together with its filename column
+static const char *const SNAPSHOT_TABLES[] = {"prims", "properties", "relationships", "xforms"};
+// The layers of each file as of its scan, compared against the files on
+// refresh
+static constexpr const char *LAYERS_TABLE = "layers";
+static constexpr const char *DEFAULT_SCHEMA = "scene";
+
+//===--------------------------------------------------------------------===//
+// usd_stage_layers
+//===--------------------------------------------------------------------===//
+
+struct UsdStageLayersBindData : public TableFunctionData {
+    vector<std::string> files;
+};
+
+struct UsdStageLayersGlobalState : public GlobalTableFunctionState {
+    idx_t file_index = 0;
+    std::vector<UsdLayerStamp> layers;
+    idx_t layer_index = 0;
+};
+
+static unique_ptr<FunctionData> UsdStageLayersBind(ClientContext &context, TableFunctionBindInput &input,
+                                                   vector<LogicalType> &return_types, vector<string> &names) {
+    auto result = make_uniq<UsdStageLayersBindData>();
+    result->files = UsdFileList::Bind(context, "usd_stage_layers", input.inputs[0]);
+
+    names = {"filename", "layer_path", "mtime", "size"};
+    return_types = {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::BIGINT, LogicalType::UBIGINT};
+    return std::move(result);
+}
+
+static unique_ptr<GlobalTableFunctionState> UsdStageLayersInit(ClientContext &context,
+                                                               TableFunctionInitInput &input) {
+    return make_uniq<UsdStageLayersGlobalState>();
+}
+
+// The layers of file's stage. The file itself is always included: the root
+// layer of a package has no file of its own.
+static std::vector<UsdLayerStamp> StampFile(ClientContext &context, const std::string &file) {
+    auto stage = UsdStageManager::OpenStage(context, file);
+    auto layers = UsdStageManager::GetLayerStamps(context, stage);
+    // Layers are stamped by their absolute real path
+    std::string root_path = file;
+    if (!UsdRemoteFileSystem::IsRemotePath(file)) {
+        std::error_code ec;
+        auto absolute_path = std::filesystem::absolute(file, ec);
+        if (!ec) {
+            root_path = absolute_path.lexically_normal().string();
+        }
+    }
+    for (const auto &layer : layers) {
+        if (layer.path == root_path) {
+            return layers;
+        }
+    }
+    UsdLayerStamp root;
+    root.path = root_path;
+    if (UsdFileList::Stat(context, root_path, root.mtime, root.size)) {
+        layers.insert(layers.begin(), std::move(root));
+    }
+    return layers;
+}
+
+static void UsdStageLayersExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &bind_data = data_p.bind_data->Cast<UsdStageLayersBindData>();
+    auto &state = data_p.global_state->Cast<UsdStageLayersGlobalState>();
+
+    idx_t count = 0;
+    while (count < STANDARD_VECTOR_SIZE) {
+        if (state.layer_index >= state.layers.size()) {
+            if (state.file_index >= bind_data.files.size()) {
+                break;
+            }
+            state.layers = StampFile(context, bind_data.files[state.file_index++]);
+            state.layer_index = 0;
+            continue;
+        }
+        const auto &layer = state.layers[state.layer_index++];
+        output.SetValue(0, count, Value(bind_data.files[state.file_index - 1]));
+        output.SetValue(1, count, Value(layer.path));
+        output.SetValue(2, count, Value::BIGINT(layer.mtime));
+        output.SetValue(3, count, Value::UBIGINT(layer.size));
+        count++;
+    }
+    output.SetCardinality(count);
+}
+
+TableFunction UsdStageLayersFunction::GetFunction() {
+    TableFunction func("usd_stage_layers", {LogicalType::VARCHAR}, UsdStageLayersExecute, UsdStageLayersBind,
+                       UsdStageLayersInit);
+    return func;
+}
+
+//===--------------------------------------------------------------------===//
+// usd_snapshot / usd_refresh
+//===--------------------------------------------------------------------===//
+
+static std::string TableName(const std::string &schema, const std::string &table) {
+    return KeywordHelper::WriteOptionallyQuoted(schema) + "." + KeywordHelper::WriteOptionallyQuoted(table);
+}
+
+static std::string FileList(const vector<std::string> &files) {
+    vector<Value> values;
+    for (const auto &file : files) {
+        values.emplace_back(file);
+    }
+    return Value::LIST(LogicalType::VARCHAR, std::move(values)).ToSQLString();
+}
+
+// Name of the temporary table a refresh scans table into before the rows of
+// the snapshot are replaced
+static std::string StagingTable(const char *table) {
+    return "temp.main." + KeywordHelper::WriteOptionallyQuoted("usd_refresh_" + std::string(table));
+}
+
+// Statements scanning files into the table named by target(table) for every
+// table of a snapshot; the layers are stamped first, so that a layer edited
+// during the scans is older in the snapshot than in the scanned rows and is
+// rescanned on the next refresh
+static std::string ScanStatements(const vector<std::string> &files,
+                                  const std::function<std::string(const char *)> &target) {
+    auto file_list = FileList(files);
+    std::string sql = "CREATE OR REPLACE TABLE " + target(LAYERS_TABLE) + " AS SELECT * FROM usd_stage_layers(" +
+                      file_list + ");\n";
+    for (auto table : SNAPSHOT_TABLES) {
+        sql += "CREATE OR REPLACE TABLE " + target(table) + " AS SELECT *, filename FROM usd_" + std::string(table) +
+               "(" + file_list + ");\n";
+    }
+    return sql;
+}
+
+static std::string GetSchema(const std::string &function_name, const Value &value) {
+    if (value.IsNull() || value.ToString().empty()) {
+        throw BinderException(function_name + ": schema cannot be empty");
+    }
+    return value.ToString();
+}
+
+static std::string UsdSnapshotQuery(ClientContext &context, const FunctionParameters &parameters) {
+    auto files = UsdFileList::Bind(context, "usd_snapshot", parameters.values[0]);
+    std::string schema = DEFAULT_SCHEMA;
+    auto entry = parameters.named_parameters.find("schema");
+    if (entry != parameters.named_parameters.end()) {
+        schema = GetSchema("usd_snapshot", entry->second);
+    }
+
+    std::string sql = "CREATE SCHEMA IF NOT EXISTS " + KeywordHelper::WriteOptionallyQuoted(schema) + ";\n";
+    sql += ScanStatements(files, [&](const char *table) { return TableName(schema, table); });
+    // Rows per table of the new snapshot
+    std::string summary;
+    for (auto table : SNAPSHOT_TABLES) {
+        summary += summary.empty() ? "" : " UNION ALL ";
+        summary += "SELECT '" + std::string(table) + "' AS table_name, COUNT(*) AS row_count FROM " +
+                   TableName(schema, table);
+    }
+    return sql + summary + ";";
+}
+
+// Layers recorded per file in the layers table of a snapshot. The table is
+// read through a connection of its own: the pragma is expanded while the
+// calling connection is busy. Only committed snapshots are visible.
+static std::map<std::string, std::vector<UsdLayerStamp>> ReadSnapshotLayers(ClientContext &context,
+                                                                            const std::string &schema) {
+    auto catalog = DatabaseManager::GetDefaultDatabase(context);
+    Connection con(*context.db);
+    auto result = con.Query("SELECT filename, layer_path, mtime, size FROM " +
+                            KeywordHelper::WriteOptionallyQuoted(catalog) + "." + TableName(schema, LAYERS_TABLE));
+    if (result->HasError()) {
+        throw BinderException("usd_refresh: no snapshot in schema " + schema + " (take one with usd_snapshot): " +
+                              result->GetError());
+    }
+    std::map<std::string, std::vector<UsdLayerStamp>> snapshot;
+    for (auto &row : *result) {
+        UsdLayerStamp stamp;
+        stamp.path = row.GetValue<std::string>(1);
+        stamp.mtime = row.GetValue<int64_t>(2);
+        stamp.size = row.GetValue<uint64_t>(3);
+        snapshot[row.GetValue<std::string>(0)].push_back(std::move(stamp));
+    }
+    return snapshot;
+}
+
+static bool HasChanged(ClientContext &context, const std::vector<UsdLayerStamp> &layers) {
+    for (const auto &layer : layers) {
+        int64_t mtime;
+        uint64_t size;
+        if (!UsdFileList::Stat(context, layer.path, mtime, size) || mtime != layer.mtime || size != layer.size) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::string UsdRefreshQuery(ClientContext &context, const FunctionParameters &parameters) {
+    auto schema = GetSchema("usd_refresh", parameters.values[0]);
+    auto snapshot = ReadSnapshotLayers(context, schema);
+
+    // A file is rescanned when one of its layers changed (edits to sublayers,
+    // references and payloads included), and dropped when it is gone
+    vector<std::string> changed;
+    vector<std::string> rescanned;
+    std::string statuses;
+    for (const auto &file : snapshot) {
+        int64_t mtime;
+        uint64_t size;
+        std::string status = "unchanged";
+        if (!UsdFileList::Stat(context, file.first, mtime, size)) {
+            status = "removed";
+            changed.push_back(file.first);
+        } else if (HasChanged(context, file.second)) {
+            status = "rescanned";
+            changed.push_back(file.first);
+            rescanned.push_back(file.first);
+        }
+        statuses += statuses.empty() ? "" : ", ";
+        statuses += "(" + Value(file.first).ToSQLString() + ", '" + status + "')";
+    }
+
+    std::string sql;
+    if (!rescanned.empty()) {
+        // Scanned aside first: a file that fails to scan (such as one saved
+        // half-written) leaves the snapshot as it was, to be retried
+        sql += ScanStatements(rescanned, StagingTable);
+    }
+    if (!changed.empty()) {
+        // Rows of a changed file are replaced as a whole: finding the changed
+        // subtrees would take the same composition and traversal as a rescan.
+        // Its layers go last, so that a file whose rows were not replaced
+        // still counts as changed.
+        std::string in_list;
+        for (const auto &file : changed) {
+            in_list += (in_list.empty() ? "" : ", ") + Value(file).ToSQLString();
+        }
+        vector<const char *> tables(std::begin(SNAPSHOT_TABLES), std::end(SNAPSHOT_TABLES));
+        tables.push_back(LAYERS_TABLE);
+        for (auto table : tables) {
+            sql += "DELETE FROM " + TableName(schema, table) + " WHERE filename IN (" + in_list + ");\n";
+            if (!rescanned.empty()) {
+                sql += "INSERT INTO " + TableName(schema, table) + " SELECT * FROM " + StagingTable(table) + ";\n";
+                sql += "DROP TABLE " + StagingTable(table) + ";\n";
+            }
+        }
+    }
+    if (statuses.empty()) {
+        return sql + "SELECT NULL::VARCHAR AS filename, NULL::VARCHAR AS status WHERE false;";
+    }
+    return sql + "SELECT * FROM (VALUES " + statuses + ") AS refresh(filename, status);";
+}
+
+PragmaFunctionSet UsdSnapshotFunction::GetFunctions() {
+    PragmaFunctionSet set("usd_snapshot");
+    auto func = PragmaFunction::PragmaCall("usd_snapshot", UsdSnapshotQuery, {LogicalType::VARCHAR});
+    func.named_parameters["schema"] = LogicalType::VARCHAR;
+    set.AddFunction(func);
+    func.arguments[0] = LogicalType::LIST(LogicalType::VARCHAR);
+    set.AddFunction(func);
+    return set;
+}
+
+PragmaFunction UsdRefreshFunction::GetFunction() {
+    return PragmaFunction::PragmaCall("usd_refresh", UsdRefreshQuery, {LogicalType::VARCHAR});
+}
+
+} // namespace duckdb
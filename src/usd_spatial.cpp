@@ -0,0 +1,491 @@
+#include "usd_spatial.hpp"
+#include "usd_helpers.hpp"
+#include "duckdb/common/exception.hpp"
+
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usdGeom/xformable.h>
+#include <pxr/usd/usdGeom/xformCache.h>
+#include <pxr/base/gf/vec3d.h>
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <unordered_map>
+
+namespace duckdb {
+
+// Table columns, in schema order. usd_within_box has no distance column;
+// only usd_nearest has rank.
+static constexpr idx_t COL_PRIM_PATH = 0;
+static constexpr idx_t COL_X = 1;
+static constexpr idx_t COL_Y = 2;
+static constexpr idx_t COL_Z = 3;
+static constexpr idx_t COL_DISTANCE = 4;
+static constexpr idx_t COL_RANK = 5;
+
+// Static kd-tree over the world positions of the Xformable prims of a stage
+// (the translations usd_xforms reports at default time). It is built once
+// per cached stage and answers radius, box and k-nearest queries in about
+// O(log n + matches) instead of the O(n^2) self-join of usd_xforms.
+//
+// The tree is implicit: the points of a subtree occupy a contiguous range of
+// entries, split at the middle entry along the axis of largest extent. Points
+// before the middle are <= the split value on that axis, points after >=.
+class UsdSpatialIndex : public UsdStageDerivedData {
+public:
+    struct Entry {
+        pxr::SdfPath path;
+        pxr::GfVec3d position;
+    };
+    // Match of a query: entry index and distance to the query point
+    struct Match {
+        idx_t entry;
+        double distance;
+    };
+
+    static constexpr const char *DERIVED_DATA_NAME = "spatial_index";
+
+    explicit UsdSpatialIndex(const pxr::UsdStageRefPtr &stage) {
+        pxr::UsdGeomXformCache xform_cache;
+        for (const auto &prim : stage->Traverse()) {
+            if (!prim.IsA<pxr::UsdGeomXformable>()) {
+                continue;
+            }
+            auto translation = xform_cache.GetLocalToWorldTransform(prim).ExtractTranslation();
+            entries.push_back(Entry {prim.GetPath(), translation});
+        }
+        split_axis.resize(entries.size());
+        Build(0, entries.size());
+        for (idx_t i = 0; i < entries.size(); i++) {
+            index_of.emplace(entries[i].path, i);
+        }
+    }
+
+    // Shared index of stage, built on first use
+    static std::shared_ptr<UsdSpatialIndex> Get(ClientContext &context, const pxr::UsdStageRefPtr &stage) {
+        return UsdStageManager::GetDerivedData<UsdSpatialIndex>(
+            context, stage, DERIVED_DATA_NAME, [&stage]() { return std::make_shared<UsdSpatialIndex>(stage); });
+    }
+
+    idx_t EstimatedSize() const override {
+        // Entries and split axes, plus roughly one hash node per path
+        return entries.size() * (sizeof(Entry) + sizeof(uint8_t) + 4 * sizeof(void *));
+    }
+
+    const Entry &GetEntry(idx_t entry) const {
+        return entries[entry];
+    }
+
+    // Index of the entry for path, or false if the prim is not indexed
+    bool Find(const pxr::SdfPath &path, idx_t &entry) const {
+        auto it = index_of.find(path);
+        if (it == index_of.end()) {
+            return false;
+        }
+        entry = it->second;
+        return true;
+    }
+
+    // Entries within radius of center, nearest first
+    vector<Match> WithinRadius(const pxr::GfVec3d &center, double radius) const {
+        vector<Match> result;
+        WithinRadius(0, entries.size(), center, radius, result);
+        std::sort(result.begin(), result.end(), [this](const Match &a, const Match &b) { return Closer(a, b); });
+        return result;
+    }
+
+    // Entries inside the closed box [min, max], ordered by path
+    vector<Match> WithinBox(const pxr::GfVec3d &min, const pxr::GfVec3d &max) const {
+        vector<Match> result;
+        WithinBox(0, entries.size(), min, max, result);
+        std::sort(result.begin(), result.end(),
+                  [this](const Match &a, const Match &b) { return entries[a.entry].path < entries[b.entry].path; });
+        return result;
+    }
+
+    // The k entries nearest to entry exclude, nearest first
+    vector<Match> Nearest(idx_t exclude, idx_t k) const {
+        auto compare = [this](const Match &a, const Match &b) { return Closer(a, b); };
+        // Max-heap of the best k so far: the top is the farthest kept match
+        std::priority_queue<Match, vector<Match>, decltype(compare)> heap(compare);
+        if (k > 0) {
+            Nearest(0, entries.size(), entries[exclude].position, exclude, k, heap);
+        }
+        vector<Match> result(heap.size());
+        for (idx_t i = result.size(); i > 0; i--) {
+            result[i - 1] = heap.top();
+            heap.pop();
+        }
+        return result;
+    }
+
+private:
+    vector<Entry> entries;
+    // Split axis of the subtree whose middle entry is at the same index
+    vector<uint8_t> split_axis;
+    std::unordered_map<pxr::SdfPath, idx_t, pxr::SdfPath::Hash> index_of;
+
+    static idx_t Middle(idx_t begin, idx_t end) {
+        return begin + (end - begin) / 2;
+    }
+
+    // Orders matches by distance, then by path so that ties are deterministic
+    bool Closer(const Match &a, const Match &b) const {
+        if (a.distance != b.distance) {
+            return a.distance < b.distance;
+        }
+        return entries[a.entry].path < entries[b.entry].path;
+    }
+
+    void Build(idx_t begin, idx_t end) {
+        if (end - begin < 2) {
+            if (end > begin) {
+                split_axis[begin] = 0;
+            }
+            return;
+        }
+        pxr::GfVec3d min = entries[begin].position;
+        pxr::GfVec3d max = min;
+        for (idx_t i = begin + 1; i < end; i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                min[axis] = std::min(min[axis], entries[i].position[axis]);
+                max[axis] = std::max(max[axis], entries[i].position[axis]);
+            }
+        }
+        auto extent = max - min;
+        uint8_t axis = 0;
+        if (extent[1] > extent[axis]) {
+            axis = 1;
+        }
+        if (extent[2] > extent[axis]) {
+            axis = 2;
+        }
+
+        auto middle = Middle(begin, end);
+        std::nth_element(entries.begin() + begin, entries.begin() + middle, entries.begin() + end,
+                         [axis](const Entry &a, const Entry &b) { return a.position[axis] < b.position[axis]; });
+        split_axis[middle] = axis;
+        Build(begin, middle);
+        Build(middle + 1, end);
+    }
+
+    void WithinRadius(idx_t begin, idx_t end, const pxr::GfVec3d &center, double radius,
+                      vector<Match> &result) const {
+        if (begin >= end) {
+            return;
+        }
+        auto middle = Middle(begin, end);
+        double distance = (entries[middle].position - center).GetLength();
+        if (distance <= radius) {
+            result.push_back(Match {middle, distance});
+        }
+        auto axis = split_axis[middle];
+        double offset = center[axis] - entries[middle].position[axis];
+        if (offset <= radius) {
+            WithinRadius(begin, middle, center, radius, result);
+        }
+        if (offset >= -radius) {
+            WithinRadius(middle + 1, end, center, radius, result);
+        }
+    }
+
+    void WithinBox(idx_t begin, idx_t end, const pxr::GfVec3d &min, const pxr::GfVec3d &max,
+                   vector<Match> &result) const {
+        if (begin >= end) {
+            return;
+        }
+        auto middle = Middle(begin, end);
+        const auto &position = entries[middle].position;
+        bool inside = true;
+        for (int axis = 0; axis < 3; axis++) {
+            inside = inside && position[axis] >= min[axis] && position[axis] <= max[axis];
+        }
+        if (inside) {
+            result.push_back(Match {middle, 0});
+        }
+        auto axis = split_axis[middle];
+        if (min[axis] <= position[axis]) {
+            WithinBox(begin, middle, min, max, result);
+        }
+        if (max[axis] >= position[axis]) {
+            WithinBox(middle + 1, end, min, max, result);
+        }
+    }
+
+    template <class HEAP>
+    void Nearest(idx_t begin, idx_t end, const pxr::GfVec3d &center, idx_t exclude, idx_t k, HEAP &heap) const {
+        if (begin >= end) {
+            return;
+        }
+        auto middle = Middle(begin, end);
+        if (middle != exclude) {
+            Match match {middle, (entries[middle].position - center).GetLength()};
+            if (heap.size() < k) {
+                heap.push(match);
+            } else if (Closer(match, heap.top())) {
+                heap.pop();
+                heap.push(match);
+            }
+        }
+        // Descend into the side of the split that holds center first; the
+        // other side only matters if the split plane is within reach
+        auto axis = split_axis[middle];
+        double offset = center[axis] - entries[middle].position[axis];
+        bool left_first = offset <= 0;
+        if (left_first) {
+            Nearest(begin, middle, center, exclude, k, heap);
+        } else {
+            Nearest(middle + 1, end, center, exclude, k, heap);
+        }
+        if (heap.size() < k || std::fabs(offset) <= heap.top().distance) {
+            if (left_first) {
+                Nearest(middle + 1, end, center, exclude, k, heap);
+            } else {
+                Nearest(begin, middle, center, exclude, k, heap);
+            }
+        }
+    }
+};
+
+// Bind data shared by the three spatial queries
+struct UsdSpatialBindData : public TableFunctionData {
+    std::string file_path;
+    // Population mask and payload loading requested with mask := / load :=
+    UsdStageLoadOptions load_options;
+    // usd_within_radius: center and radius
+    pxr::GfVec3d center;
+    double radius = 0;
+    // usd_within_box: corners of the box
+    pxr::GfVec3d min;
+    pxr::GfVec3d max;
+    // usd_nearest: query prim and number of neighbours
+    pxr::SdfPath prim_path;
+    idx_t k = 0;
+
+    explicit UsdSpatialBindData(std::string path) : file_path(std::move(path)) {}
+};
+
+// Global state: the matches are computed in init and emitted in chunks
+struct UsdSpatialGlobalState : public GlobalTableFunctionState {
+    std::shared_ptr<UsdSpatialIndex> index;
+    vector<UsdSpatialIndex::Match> matches;
+    idx_t offset = 0;
+    UsdColumnProjection projection;
+    // Queries run on a single thread: one profile serves the whole query
+    UsdScanTracker tracker;
+    UsdScanProfile profile;
+
+    UsdSpatialGlobalState() = default;
+};
+
+// Checks the arguments shared by all spatial queries; returns the file path
+static std::string BindFilePath(ClientContext &context, const std::string &function_name,
+                                TableFunctionBindInput &input, idx_t argument_count, const std::string &arguments) {
+    if (input.inputs.size() != argument_count) {
+        throw BinderException(function_name + " requires exactly " + std::to_string(argument_count) +
+                              " arguments: " + arguments);
+    }
+    for (auto &argument : input.inputs) {
+        if (argument.IsNull()) {
+            throw BinderException(function_name + ": arguments cannot be NULL");
+        }
+    }
+
+    auto file_path = input.inputs[0].GetValue<string>();
+    UsdFileList::Validate(context, function_name, file_path);
+    return file_path;
+}
+
+static void AddPositionColumns(vector<LogicalType> &return_types, vector<string> &names) {
+    names = {"prim_path", "x", "y", "z"};
+    return_types = {LogicalTypeId::VARCHAR, LogicalTypeId::DOUBLE, LogicalTypeId::DOUBLE, LogicalTypeId::DOUBLE};
+}
+
+static unique_ptr<FunctionData> UsdWithinRadiusBind(ClientContext &context, TableFunctionBindInput &input,
+                                                    vector<LogicalType> &return_types, vector<string> &names) {
+    auto file_path = BindFilePath(context, "usd_within_radius", input, 5, "file_path, x, y, z, radius");
+    auto result = make_uniq<UsdSpatialBindData>(file_path);
+    result->load_options.Bind("usd_within_radius", input.named_parameters);
+    for (idx_t i = 0; i < 3; i++) {
+        result->center[i] = input.inputs[1 + i].GetValue<double>();
+    }
+    result->radius = input.inputs[4].GetValue<double>();
+    if (!(result->radius >= 0)) {
+        throw BinderException("usd_within_radius: radius must not be negative");
+    }
+
+    AddPositionColumns(return_types, names);
+    names.emplace_back("distance");
+    return_types.emplace_back(LogicalTypeId::DOUBLE);
+    return std::move(result);
+}
+
+static unique_ptr<FunctionData> UsdWithinBoxBind(ClientContext &context, TableFunctionBindInput &input,
+                                                 vector<LogicalType> &return_types, vector<string> &names) {
+    auto file_path =
+        BindFilePath(context, "usd_within_box", input, 7, "file_path, min_x, min_y, min_z, max_x, max_y, max_z");
+    auto result = make_uniq<UsdSpatialBindData>(file_path);
+    result->load_options.Bind("usd_within_box", input.named_parameters);
+    for (idx_t i = 0; i < 3; i++) {
+        result->min[i] = input.inputs[1 + i].GetValue<double>();
+        result->max[i] = input.inputs[4 + i].GetValue<double>();
+        if (result->min[i] > result->max[i]) {
+            throw BinderException("usd_within_box: min corner must not exceed max corner");
+        }
+    }
+
+    AddPositionColumns(return_types, names);
+    return std::move(result);
+}
+
+static unique_ptr<FunctionData> UsdNearestBind(ClientContext &context, TableFunctionBindInput &input,
+                                               vector<LogicalType> &return_types, vector<string> &names) {
+    auto file_path = BindFilePath(context, "usd_nearest", input, 3, "file_path, prim_path, k");
+    auto result = make_uniq<UsdSpatialBindData>(file_path);
+    result->load_options.Bind("usd_nearest", input.named_parameters);
+    auto prim_path = input.inputs[1].GetValue<string>();
+    result->prim_path = pxr::SdfPath(prim_path);
+    if (!result->prim_path.IsAbsolutePath() || !result->prim_path.IsPrimPath()) {
+        throw BinderException("usd_nearest: prim_path must be an absolute prim path: " + prim_path);
+    }
+    auto k = input.inputs[2].GetValue<int64_t>();
+    if (k < 0) {
+        throw BinderException("usd_nearest: k must not be negative");
+    }
+    result->k = NumericCast<idx_t>(k);
+
+    AddPositionColumns(return_types, names);
+    names.emplace_back("distance");
+    return_types.emplace_back(LogicalTypeId::DOUBLE);
+    names.emplace_back("rank");
+    return_types.emplace_back(LogicalTypeId::BIGINT);
+    return std::move(result);
+}
+
+// Opens the stage and fetches (or builds) its index. Building the index and
+// querying it are profiled as the extract phase; the caller flushes the
+// profile once the query ran.
+static unique_ptr<UsdSpatialGlobalState> InitSpatialState(ClientContext &context, TableFunctionInitInput &input,
+                                                          idx_t column_count, const std::string &function_name) {
+    auto &bind_data = input.bind_data->Cast<UsdSpatialBindData>();
+    auto state = make_uniq<UsdSpatialGlobalState>();
+    state->projection = UsdColumnProjection(input.column_ids, column_count);
+    state->tracker.StartProfile(context, function_name);
+    state->profile.timing = state->tracker.Timing();
+
+    // Open USD stage (shared through the stage cache, as is its index)
+    state->profile.Enter(UsdScanPhase::OPEN);
+    auto stage = UsdStageManager::OpenStage(context, bind_data.file_path, bind_data.load_options, &state->profile);
+    state->profile.Enter(UsdScanPhase::EXTRACT);
+    state->index = UsdSpatialIndex::Get(context, stage);
+    return state;
+}
+
+static unique_ptr<GlobalTableFunctionState> UsdWithinRadiusInit(ClientContext &context,
+                                                                TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<UsdSpatialBindData>();
+    auto state = InitSpatialState(context, input, COL_DISTANCE + 1, "usd_within_radius");
+    state->matches = state->index->WithinRadius(bind_data.center, bind_data.radius);
+    state->tracker.Flush(state->profile);
+    return std::move(state);
+}
+
+static unique_ptr<GlobalTableFunctionState> UsdWithinBoxInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<UsdSpatialBindData>();
+    auto state = InitSpatialState(context, input, COL_Z + 1, "usd_within_box");
+    state->matches = state->index->WithinBox(bind_data.min, bind_data.max);
+    state->tracker.Flush(state->profile);
+    return std::move(state);
+}
+
+static unique_ptr<GlobalTableFunctionState> UsdNearestInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<UsdSpatialBindData>();
+    auto state = InitSpatialState(context, input, COL_RANK + 1, "usd_nearest");
+    idx_t entry;
+    if (!state->index->Find(bind_data.prim_path, entry)) {
+        throw InvalidInputException("usd_nearest: prim is not an Xformable prim of the stage: " +
+                                    bind_data.prim_path.GetString());
+    }
+    state->matches = state->index->Nearest(entry, bind_data.k);
+    state->tracker.Flush(state->profile);
+    return std::move(state);
+}
+
+// Execute function shared by the three queries; columns missing from the
+// function's schema are never projected
+static void UsdSpatialExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &state = data_p.global_state->Cast<UsdSpatialGlobalState>();
+    auto &projection = state.projection;
+
+    // Only projected columns are computed; unprojected ones get nullptr
+    auto prim_path_out = projection.GetVector(output, COL_PRIM_PATH);
+    auto prim_path_data = projection.GetData<string_t>(output, COL_PRIM_PATH);
+    double *position_data[3];
+    for (idx_t i = 0; i < 3; i++) {
+        position_data[i] = projection.GetData<double>(output, COL_X + i);
+    }
+    auto distance_data = projection.GetData<double>(output, COL_DISTANCE);
+    auto rank_data = projection.GetData<int64_t>(output, COL_RANK);
+
+    auto count = MinValue<idx_t>(state.matches.size() - state.offset, STANDARD_VECTOR_SIZE);
+    state.profile.Enter(UsdScanPhase::EMIT);
+    for (idx_t row = 0; row < count; row++) {
+        const auto &match = state.matches[state.offset + row];
+        const auto &entry = state.index->GetEntry(match.entry);
+        if (prim_path_data) {
+            prim_path_data[row] = StringVector::AddString(*prim_path_out, entry.path.GetString());
+        }
+        for (idx_t i = 0; i < 3; i++) {
+            if (position_data[i]) {
+                position_data[i][row] = entry.position[i];
+            }
+        }
+        if (distance_data) {
+            distance_data[row] = match.distance;
+        }
+        if (rank_data) {
+            rank_data[row] = NumericCast<int64_t>(state.offset + row + 1);
+        }
+    }
+    state.offset += count;
+
+    output.SetCardinality(count);
+    projection.FinalizeChunk(output);
+    state.tracker.AddRows(count);
+    state.profile.Enter(UsdScanPhase::NONE);
+    state.profile.CountStrings(output);
+    state.tracker.Flush(state.profile);
+}
+
+TableFunction UsdWithinRadiusFunction::GetFunction() {
+    TableFunction func("usd_within_radius",
+                       {LogicalTypeId::VARCHAR, LogicalTypeId::DOUBLE, LogicalTypeId::DOUBLE, LogicalTypeId::DOUBLE,
+                        LogicalTypeId::DOUBLE},
+                       UsdSpatialExecute, UsdWithinRadiusBind, UsdWithinRadiusInit);
+    func.projection_pushdown = true;
+    UsdStageLoadOptions::RegisterParameters(func);
+    UsdScanStatistics::RegisterProfile<UsdSpatialGlobalState>(func);
+    return func;
+}
+
+TableFunction UsdWithinBoxFunction::GetFunction() {
+    TableFunction func("usd_within_box",
+                       {LogicalTypeId::VARCHAR, LogicalTypeId::DOUBLE, LogicalTypeId::DOUBLE, LogicalTypeId::DOUBLE,
+                        LogicalTypeId::DOUBLE, LogicalTypeId::DOUBLE, LogicalTypeId::DOUBLE},
+                       UsdSpatialExecute, UsdWithinBoxBind, UsdWithinBoxInit);
+    func.projection_pushdown = true;
+    UsdStageLoadOptions::RegisterParameters(func);
+    UsdScanStatistics::RegisterProfile<UsdSpatialGlobalState>(func);
+    return func;
+}
+
+TableFunction UsdNearestFunction::GetFunction() {
+    TableFunction func("usd_nearest", {LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR, LogicalTypeId::BIGINT},
+                       UsdSpatialExecute, UsdNearestBind, UsdNearestInit);
+    func.projection_pushdown = true;
+    UsdStageLoadOptions::RegisterParameters(func);
+    UsdScanStatistics::RegisterProfile<UsdSpatialGlobalState>(func);
+    return func;
+}
+
+} // namespace duckdb
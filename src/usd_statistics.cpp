@@ -0,0 +1,212 @@
+#include "usd_statistics.hpp"
+#include "usd_crate.hpp"
+#include "usd_helpers.hpp"
+#include "duckdb/common/string_util.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace duckdb {
+
+// Remembered scans are dropped wholesale past this many entries
+static constexpr idx_t MAX_REMEMBERED_SCANS = 16384;
+// Files beyond this many are not looked at during bind (nor remembered):
+// they count as the average of the sampled files
+static constexpr idx_t MAX_SAMPLED_FILES = 64;
+// Typical bytes per spec of text layers and of packages, whose layers are
+// not read at bind time
+static constexpr idx_t TEXT_BYTES_PER_SPEC = 48;
+static constexpr idx_t PACKAGE_BYTES_PER_SPEC = 24;
+
+struct UsdRememberedScan {
+    idx_t rows = 0;
+    vector<idx_t> distinct;
+};
+
+struct UsdScanMemory {
+    std::mutex lock;
+    // Keyed by function name and file version key
+    std::unordered_map<std::string, UsdRememberedScan> scans;
+
+    static UsdScanMemory &Get() {
+        static UsdScanMemory memory;
+        return memory;
+    }
+};
+
+static std::string ScanKey(const std::string &function_name, const std::string &file_key) {
+    return function_name + "|" + file_key;
+}
+
+// Specs of the root layer of file_path, from the header of crate files or
+// the size of other layers
+static idx_t EstimateSpecCount(ClientContext &context, const std::string &file_path, uint64_t file_size) {
+    auto lower = StringUtil::Lower(file_path);
+    if (StringUtil::EndsWith(lower, ".usdz")) {
+        return file_size / PACKAGE_BYTES_PER_SPEC;
+    }
+    if (!StringUtil::EndsWith(lower, ".usda")) {
+        try {
+            idx_t count;
+            if (UsdCrateReader::TryReadSpecCount(context, file_path, count)) {
+                return count;
+            }
+        } catch (std::exception &) {
+            // A corrupt file is reported by the scan itself
+        }
+    }
+    return file_size / TEXT_BYTES_PER_SPEC;
+}
+
+UsdScanEstimate UsdScanStatistics::Estimate(ClientContext &context, const std::string &function_name,
+                                            const vector<std::string> &files, double rows_per_spec,
+                                            bool rememberable, idx_t column_count) {
+    UsdScanEstimate result;
+    result.function_name = function_name;
+    result.rememberable = rememberable;
+    result.file_keys.resize(files.size());
+    result.distinct.assign(column_count, 0);
+
+    auto &memory = UsdScanMemory::Get();
+    double rows = 0;
+    idx_t sampled_files = 0;
+    bool all_remembered = !files.empty() && files.size() <= MAX_SAMPLED_FILES;
+    for (idx_t i = 0; i < MinValue(files.size(), MAX_SAMPLED_FILES); i++) {
+        const auto &file = files[i];
+        int64_t mtime;
+        uint64_t size;
+        if (!UsdFileList::Stat(context, file, mtime, size)) {
+            all_remembered = false;
+            continue;
+        }
+        sampled_files++;
+        result.file_keys[i] = file + "@" + std::to_string(mtime) + ":" + std::to_string(size);
+
+        if (rememberable) {
+            std::lock_guard<std::mutex> guard(memory.lock);
+            auto entry = memory.scans.find(ScanKey(function_name, result.file_keys[i]));
+            if (entry != memory.scans.end()) {
+                rows += double(entry->second.rows);
+                for (idx_t col = 0; col < MinValue(column_count, entry->second.distinct.size()); col++) {
+                    result.distinct[col] = MaxValue(result.distinct[col], entry->second.distinct[col]);
+                }
+                continue;
+            }
+        }
+        all_remembered = false;
+        rows += MaxValue(double(EstimateSpecCount(context, file, size)) * rows_per_spec, 1.0);
+    }
+    if (sampled_files > 0 && sampled_files < files.size()) {
+        rows *= double(files.size()) / double(sampled_files);
+    }
+    result.rows = idx_t(rows);
+    result.exact = all_remembered;
+    return result;
+}
+
+void UsdScanStatistics::Remember(const std::string &function_name, const std::string &file_key, idx_t rows,
+                                 const vector<idx_t> &distinct) {
+    auto &memory = UsdScanMemory::Get();
+    auto key = ScanKey(function_name, file_key);
+    std::lock_guard<std::mutex> guard(memory.lock);
+    if (memory.scans.size() >= MAX_REMEMBERED_SCANS && memory.scans.find(key) == memory.scans.end()) {
+        memory.scans.clear();
+    }
+    auto &entry = memory.scans[key];
+    entry.rows = rows;
+    // Scans projecting other columns may have measured other distinct counts
+    if (entry.distinct.size() < distinct.size()) {
+        entry.distinct.resize(distinct.size(), 0);
+    }
+    for (idx_t col = 0; col < distinct.size(); col++) {
+        entry.distinct[col] = MaxValue(entry.distinct[col], distinct[col]);
+    }
+}
+
+void UsdScanStatistics::Clear() {
+    auto &memory = UsdScanMemory::Get();
+    std::lock_guard<std::mutex> guard(memory.lock);
+    memory.scans.clear();
+}
+
+unique_ptr<NodeStatistics> UsdScanStatistics::Cardinality(const UsdScanEstimate &estimate) {
+    if (estimate.exact) {
+        return make_uniq<NodeStatistics>(estimate.rows, estimate.rows);
+    }
+    return make_uniq<NodeStatistics>(estimate.rows);
+}
+
+UsdScanTracker::~UsdScanTracker() {
+    if (history_) {
+        history_->Add(Snapshot());
+    }
+}
+
+void UsdScanTracker::Start(ClientContext &context, const UsdScanEstimate &estimate, bool remember) {
+    estimate_ = &estimate;
+    remember_ = remember && estimate.rememberable;
+    StartProfile(context, estimate.function_name);
+}
+
+void UsdScanTracker::StartProfile(ClientContext &context, const std::string &function_name) {
+    function_name_ = function_name;
+    history_ = UsdScanHistory::Get(context);
+    timing_ = UsdScanHistory::TimingEnabled(context);
+    start_ = std::chrono::steady_clock::now();
+}
+
+void UsdScanTracker::Flush(UsdScanProfile &profile) {
+    profile.Enter(UsdScanPhase::NONE);
+    for (idx_t phase = 0; phase < USD_SCAN_PHASE_COUNT; phase++) {
+        phase_nanos_[phase] += profile.phase_nanos[phase];
+        profile.phase_nanos[phase] = 0;
+    }
+    prims_visited_ += profile.prims_visited;
+    prims_pruned_ += profile.prims_pruned;
+    string_bytes_ += profile.string_bytes;
+    stage_cache_hits_ += profile.stage_cache_hits;
+    stage_cache_misses_ += profile.stage_cache_misses;
+    profile.prims_visited = profile.prims_pruned = profile.string_bytes = 0;
+    profile.stage_cache_hits = profile.stage_cache_misses = 0;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+    auto last = last_flush_nanos_.load();
+    while (last < elapsed.count() && !last_flush_nanos_.compare_exchange_weak(last, elapsed.count())) {
+    }
+}
+
+UsdScanStats UsdScanTracker::Snapshot() const {
+    UsdScanStats stats;
+    stats.function_name = function_name_;
+    stats.rows = rows_;
+    stats.prims_visited = prims_visited_;
+    stats.prims_pruned = prims_pruned_;
+    stats.string_bytes = string_bytes_;
+    stats.stage_cache_hits = stage_cache_hits_;
+    stats.stage_cache_misses = stage_cache_misses_;
+    stats.wall_nanos = NumericCast<idx_t>(last_flush_nanos_.load());
+    stats.timed = timing_;
+    for (idx_t phase = 0; phase < USD_SCAN_PHASE_COUNT; phase++) {
+        stats.phase_nanos[phase] = phase_nanos_[phase];
+    }
+    return stats;
+}
+
+void UsdScanTracker::FileCompleted(idx_t file, idx_t rows, const vector<idx_t> &distinct) const {
+    if (!remember_ || file >= estimate_->file_keys.size() || estimate_->file_keys[file].empty()) {
+        return;
+    }
+    UsdScanStatistics::Remember(estimate_->function_name, estimate_->file_keys[file], rows, distinct);
+}
+
+double UsdScanTracker::Progress() const {
+    if (!estimate_ || estimate_->rows == 0) {
+        // Unknown
+        return -1;
+    }
+    auto progress = 100.0 * double(rows_.load()) / double(estimate_->rows);
+    // Estimates can be low: never report completion before the scan ends
+    return MinValue(progress, estimate_->exact ? 100.0 : 99.0);
+}
+
+} // namespace duckdb
@@ -0,0 +1,343 @@
+#include "usd_time_samples.hpp"
+#include "usd_helpers.hpp"
+#include "usd_values.hpp"
+#include "duckdb/common/exception.hpp"
+
+#include <pxr/usd/usd/attribute.h>
+#include <pxr/usd/usd/attributeQuery.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/base/gf/interval.h>
+#include <cmath>
+#include <limits>
+
+namespace duckdb {
+
+// Table columns, in schema order
+static constexpr idx_t COL_PRIM_PATH = 0;
+static constexpr idx_t COL_ATTR_NAME = 1;
+static constexpr idx_t COL_USD_TYPE_NAME = 2;
+static constexpr idx_t COL_TIME = 3;
+static constexpr idx_t COL_VALUE = 4;
+static constexpr idx_t COL_VALUE_DOUBLE = 5;
+static constexpr idx_t COL_VALUE_INT = 6;
+static constexpr idx_t COL_VALUE_BOOL = 7;
+static constexpr idx_t COL_VALUE_TOKEN = 8;
+static constexpr idx_t COL_VALUE_VEC3 = 9;
+static constexpr idx_t COL_VALUE_ARRAY = 10;
+static constexpr idx_t COLUMN_COUNT = 11;
+// Rows per root layer spec, for estimates before the first complete scan
+static constexpr double ROWS_PER_SPEC = 1.0;
+// Bound of the number of times step := evaluates each attribute at
+static constexpr idx_t MAX_STEP_SAMPLES = 1000000;
+
+// Bind data structure
+struct UsdTimeSamplesBindData : public TableFunctionData {
+    // Files to scan (a path, the matches of a glob, or a list)
+    vector<std::string> files;
+    // Population mask and payload loading requested with mask := / load :=
+    UsdStageLoadOptions load_options;
+    // Path and attribute name predicates pushed down from the query
+    UsdScanFilter filter;
+    // Row estimate for the planner and the progress bar
+    UsdScanEstimate estimate;
+    // Closed time range of the samples (unbounded by default)
+    double start = -std::numeric_limits<double>::infinity();
+    double end = std::numeric_limits<double>::infinity();
+    // When set, values are interpolated at start, start + step, ... <= end
+    // instead of being read at the authored sample times
+    double step = 0;
+    // Number of those times
+    idx_t step_count = 0;
+
+    explicit UsdTimeSamplesBindData(vector<std::string> files_p) : files(std::move(files_p)) {}
+};
+
+// Per-thread cursor into the file currently being scanned
+struct UsdTimeSamplesLocalState : public UsdMultiFileLocalState {
+    std::unique_ptr<UsdPrimIterator> prim_iterator;
+
+    pxr::UsdPrim current_prim;
+    std::vector<pxr::UsdAttribute> current_attributes;
+    size_t attribute_index = 0;
+    // Query of the current attribute: resolves where its values come from
+    // once, so the Get of every sample only interpolates
+    std::unique_ptr<pxr::UsdAttributeQuery> query;
+    // Authored sample times of the current attribute (without step)
+    std::vector<double> times;
+    size_t time_count = 0;
+    size_t time_index = 0;
+
+    // Time of the current row; stepped times are computed, not stored
+    double Time(const UsdTimeSamplesBindData &bind_data) const {
+        if (bind_data.step > 0) {
+            return bind_data.start + static_cast<double>(time_index) * bind_data.step;
+        }
+        return times[time_index];
+    }
+
+    // Claims the next file and starts iterating its prims
+    bool NextFile(ClientContext &context, UsdMultiFileGlobalState &gstate, const UsdTimeSamplesBindData &bind_data) {
+        query.reset();
+        times.clear();
+        time_count = 0;
+        time_index = 0;
+        prim_iterator.reset();
+        current_attributes.clear();
+        attribute_index = 0;
+        if (!OpenNextFile(context, gstate, bind_data.files, bind_data.load_options.WithFilter(bind_data.filter))) {
+            return false;
+        }
+        // Create prim iterator over the prims that can satisfy the filters
+        prim_iterator = std::make_unique<UsdPrimIterator>(stage, bind_data.filter, &profile);
+        return true;
+    }
+
+    // Moves to the next time-sampled attribute; false when the file is done
+    bool NextAttribute(const UsdTimeSamplesBindData &bind_data) {
+        while (true) {
+            while (attribute_index >= current_attributes.size()) {
+                if (!prim_iterator || !prim_iterator->HasNext()) {
+                    return false;
+                }
+                profile.Enter(UsdScanPhase::TRAVERSE);
+                current_prim = prim_iterator->GetNext();
+                profile.Enter(UsdScanPhase::EXTRACT);
+                current_attributes.clear();
+                for (auto &prop : bind_data.filter.GetProperties(current_prim)) {
+                    if (prop.Is<pxr::UsdAttribute>()) {
+                        current_attributes.push_back(prop.As<pxr::UsdAttribute>());
+                    }
+                }
+                attribute_index = 0;
+            }
+
+            auto &attr = current_attributes[attribute_index++];
+            query = std::make_unique<pxr::UsdAttributeQuery>(attr);
+            times.clear();
+            time_index = 0;
+            if (query->GetNumTimeSamples() == 0) {
+                continue;
+            }
+            if (bind_data.step > 0) {
+                time_count = bind_data.step_count;
+            } else {
+                pxr::GfInterval interval(bind_data.start, bind_data.end);
+                query->GetTimeSamplesInInterval(interval, &times);
+                time_count = times.size();
+            }
+            if (time_count > 0) {
+                return true;
+            }
+        }
+    }
+};
+
+// Bind function
+static unique_ptr<FunctionData> UsdTimeSamplesBind(ClientContext &context, TableFunctionBindInput &input,
+                                                   vector<LogicalType> &return_types, vector<string> &names) {
+    // Validate input
+    if (input.inputs.size() != 1) {
+        throw BinderException("usd_time_samples requires exactly one argument: file_path");
+    }
+
+    // One path, a glob pattern or a list of either
+    auto files = UsdFileList::Bind(context, "usd_time_samples", input.inputs[0]);
+
+    auto result = make_uniq<UsdTimeSamplesBindData>(std::move(files));
+    result->estimate = UsdScanStatistics::Estimate(context, "usd_time_samples", result->files, ROWS_PER_SPEC,
+                                                   input.named_parameters.empty(), COLUMN_COUNT);
+    result->load_options.Bind("usd_time_samples", input.named_parameters);
+    result->filter.BindTraversal("usd_time_samples", input.named_parameters);
+    for (auto &kv : input.named_parameters) {
+        if (kv.second.IsNull()) {
+            continue;
+        }
+        if (kv.first == "start") {
+            result->start = kv.second.GetValue<double>();
+        } else if (kv.first == "end") {
+            result->end = kv.second.GetValue<double>();
+        } else if (kv.first == "step") {
+            result->step = kv.second.GetValue<double>();
+            if (!(result->step > 0)) {
+                throw BinderException("usd_time_samples: step must be positive");
+            }
+        }
+    }
+    if (result->start > result->end) {
+        throw BinderException("usd_time_samples: start must not be greater than end");
+    }
+    if (result->step > 0) {
+        if (!std::isfinite(result->start) || !std::isfinite(result->end)) {
+            throw BinderException("usd_time_samples: step requires both start and end");
+        }
+        // Times start + i * step <= end, counted before any is generated
+        double intervals = std::floor((result->end - result->start) / result->step);
+        if (!(intervals < double(MAX_STEP_SAMPLES))) {
+            throw BinderException("usd_time_samples: step evaluates each attribute at more than " +
+                                  std::to_string(MAX_STEP_SAMPLES) + " times; use a larger step or a shorter range");
+        }
+        auto count = static_cast<idx_t>(intervals) + 1;
+        // Rounding of the division may miss or add the time at end
+        while (result->start + static_cast<double>(count) * result->step <= result->end) {
+            count++;
+        }
+        while (count > 1 && result->start + static_cast<double>(count - 1) * result->step > result->end) {
+            count--;
+        }
+        result->step_count = count;
+    }
+
+    // Define output schema
+    names = {"prim_path", "attr_name", "usd_type_name", "time", "value"};
+    return_types = {LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR, LogicalTypeId::VARCHAR, LogicalTypeId::DOUBLE,
+                    LogicalTypeId::VARCHAR};
+    // Typed copies of each sample: value_double .. value_array
+    UsdValueDispatch::AddColumns(names, return_types);
+
+    return std::move(result);
+}
+
+// Init function
+static unique_ptr<GlobalTableFunctionState> UsdTimeSamplesInit(ClientContext &context, TableFunctionInitInput &input) {
+    auto &bind_data = input.bind_data->Cast<UsdTimeSamplesBindData>();
+    auto state = make_uniq<UsdMultiFileGlobalState>(bind_data.files.size());
+    state->projection = UsdColumnProjection(input.column_ids, COLUMN_COUNT);
+    state->tracker.Start(context, bind_data.estimate, bind_data.filter.IsEmpty());
+    return std::move(state);
+}
+
+// Each thread opens (through the stage cache) the stages of the files it claims
+static unique_ptr<LocalTableFunctionState> UsdTimeSamplesInitLocal(ExecutionContext &context,
+                                                                   TableFunctionInitInput &input,
+                                                                   GlobalTableFunctionState *global_state) {
+    return make_uniq<UsdTimeSamplesLocalState>();
+}
+
+// Execute function
+static void UsdTimeSamplesExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
+    auto &bind_data = data_p.bind_data->Cast<UsdTimeSamplesBindData>();
+    auto &gstate = data_p.global_state->Cast<UsdMultiFileGlobalState>();
+    auto &state = data_p.local_state->Cast<UsdTimeSamplesLocalState>();
+    auto &projection = gstate.projection;
+
+    // Only projected columns are computed; unprojected ones get nullptr
+    auto prim_path_out = projection.GetVector(output, COL_PRIM_PATH);
+    auto attr_name_out = projection.GetVector(output, COL_ATTR_NAME);
+    auto usd_type_name_out = projection.GetVector(output, COL_USD_TYPE_NAME);
+    auto value_str_out = projection.GetVector(output, COL_VALUE);
+    auto prim_path_data = projection.GetData<string_t>(output, COL_PRIM_PATH);
+    auto attr_name_data = projection.GetData<string_t>(output, COL_ATTR_NAME);
+    auto usd_type_name_data = projection.GetData<string_t>(output, COL_USD_TYPE_NAME);
+    auto time_data = projection.GetData<double>(output, COL_TIME);
+    auto value_str_data = projection.GetData<string_t>(output, COL_VALUE);
+    UsdValueVectors value_out;
+    value_out.value_double = projection.GetVector(output, COL_VALUE_DOUBLE);
+    value_out.value_int = projection.GetVector(output, COL_VALUE_INT);
+    value_out.value_bool = projection.GetVector(output, COL_VALUE_BOOL);
+    value_out.value_token = projection.GetVector(output, COL_VALUE_TOKEN);
+    value_out.value_vec3 = projection.GetVector(output, COL_VALUE_VEC3);
+    value_out.value_array = projection.GetVector(output, COL_VALUE_ARRAY);
+    bool typed_values = value_out.Any();
+    bool need_value = value_str_data || typed_values;
+
+    idx_t count = 0;
+    while (count < STANDARD_VECTOR_SIZE) {
+        if (state.time_index >= state.time_count && !state.NextAttribute(bind_data)) {
+            // A chunk never spans two files
+            if (count > 0 || !state.NextFile(context, gstate, bind_data)) {
+                break;
+            }
+            continue;
+        }
+
+        // Strings shared by every sample of the attribute in this chunk
+        state.profile.Enter(UsdScanPhase::EMIT);
+        const auto &attr = state.query->GetAttribute();
+        auto type_name = attr.GetTypeName();
+        string_t prim_path;
+        string_t attr_name;
+        string_t usd_type_name;
+        if (prim_path_data) {
+            prim_path = StringVector::AddString(*prim_path_out, state.current_prim.GetPath().GetString());
+        }
+        if (attr_name_data) {
+            attr_name = StringVector::AddString(*attr_name_out, attr.GetName().GetString());
+        }
+        if (usd_type_name_data) {
+            usd_type_name = StringVector::AddString(*usd_type_name_out, type_name.GetAsToken().GetString());
+        }
+        auto writer = typed_values ? UsdValueDispatch::GetWriter(type_name) : nullptr;
+
+        for (; state.time_index < state.time_count && count < STANDARD_VECTOR_SIZE; state.time_index++, count++) {
+            double time = state.Time(bind_data);
+            if (prim_path_data) {
+                prim_path_data[count] = prim_path;
+            }
+            if (attr_name_data) {
+                attr_name_data[count] = attr_name;
+            }
+            if (usd_type_name_data) {
+                usd_type_name_data[count] = usd_type_name;
+            }
+            if (time_data) {
+                time_data[count] = time;
+            }
+            if (!need_value) {
+                continue;
+            }
+
+            pxr::VtValue value;
+            state.profile.Enter(UsdScanPhase::EXTRACT);
+            bool has_value = state.query->Get(&value, pxr::UsdTimeCode(time));
+            state.profile.Enter(UsdScanPhase::EMIT);
+            if (value_str_data) {
+                if (has_value) {
+                    value_str_data[count] =
+                        StringVector::AddString(*value_str_out, UsdValueDispatch::FormatValue(value));
+                } else {
+                    FlatVector::SetNull(*value_str_out, count, true);
+                }
+            }
+            if (typed_values) {
+                uint8_t written = 0;
+                if (has_value && writer) {
+                    written = writer(value, value_out, count);
+                }
+                value_out.SetNullExcept(count, written);
+            }
+        }
+    }
+
+    output.SetCardinality(count);
+    if (count > 0) {
+        state.FinalizeChunk(gstate, output, bind_data.files);
+    }
+}
+
+static void UsdTimeSamplesPushdownFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                         vector<unique_ptr<Expression>> &filters) {
+    auto &bind_data = bind_data_p->Cast<UsdTimeSamplesBindData>();
+    UsdFilterColumns columns;
+    columns.prim_path = COL_PRIM_PATH;
+    columns.property_name = COL_ATTR_NAME;
+    bind_data.filter.Pushdown(get, filters, columns);
+}
+
+// Get the table function
+TableFunction UsdTimeSamplesFunction::GetFunction() {
+    TableFunction func("usd_time_samples", {LogicalTypeId::VARCHAR}, UsdTimeSamplesExecute, UsdTimeSamplesBind,
+                       UsdTimeSamplesInit, UsdTimeSamplesInitLocal);
+    func.get_partition_data = UsdMultiFileLocalState::GetPartitionData;
+    func.projection_pushdown = true;
+    UsdScanStatistics::Register<UsdTimeSamplesBindData, UsdMultiFileGlobalState>(func);
+    UsdFileList::RegisterFilenameColumn(func);
+    UsdStageLoadOptions::RegisterParameters(func);
+    UsdScanFilter::RegisterParameters(func);
+    func.pushdown_complex_filter = UsdTimeSamplesPushdownFilter;
+    func.named_parameters["start"] = LogicalType::DOUBLE;
+    func.named_parameters["end"] = LogicalType::DOUBLE;
+    func.named_parameters["step"] = LogicalType::DOUBLE;
+    return func;
+}
+
+} // namespace duckdb
@@ -0,0 +1,342 @@
+#include "usd_values.hpp"
+#include "duckdb/common/operator/cast_operators.hpp"
+#include <pxr/base/gf/half.h>
+#include <pxr/base/gf/vec2d.h>
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/gf/vec2h.h>
+#include <pxr/base/gf/vec2i.h>
+#include <pxr/base/gf/vec3d.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/gf/vec3h.h>
+#include <pxr/base/gf/vec3i.h>
+#include <pxr/base/gf/vec4d.h>
+#include <pxr/base/gf/vec4f.h>
+#include <pxr/base/gf/vec4h.h>
+#include <pxr/base/gf/vec4i.h>
+#include <pxr/base/tf/hash.h>
+#include <pxr/base/tf/token.h>
+#include <pxr/base/vt/array.h>
+#include <pxr/usd/sdf/assetPath.h>
+#include <pxr/usd/sdf/schema.h>
+#include <cstring>
+#include <sstream>
+#include <type_traits>
+#include <unordered_map>
+
+namespace duckdb {
+
+static constexpr idx_t VEC3_SIZE = 3;
+
+void UsdValueVectors::SetNullExcept(idx_t row, uint8_t written) const {
+    if (value_double && !(written & USD_VALUE_DOUBLE)) {
+        FlatVector::SetNull(*value_double, row, true);
+    }
+    if (value_int && !(written & USD_VALUE_INT)) {
+        FlatVector::SetNull(*value_int, row, true);
+    }
+    if (value_bool && !(written & USD_VALUE_BOOL)) {
+        FlatVector::SetNull(*value_bool, row, true);
+    }
+    if (value_token && !(written & USD_VALUE_TOKEN)) {
+        FlatVector::SetNull(*value_token, row, true);
+    }
+    if (value_vec3 && !(written & USD_VALUE_VEC3)) {
+        FlatVector::SetNull(*value_vec3, row, true);
+    }
+    if (value_array && !(written & USD_VALUE_ARRAY)) {
+        FlatVector::SetNull(*value_array, row, true);
+    }
+}
+
+// Reserves count doubles for row in a LIST(DOUBLE) vector
+static double *AppendListEntry(Vector &list, idx_t row, idx_t count) {
+    auto offset = ListVector::GetListSize(list);
+    ListVector::Reserve(list, offset + count);
+    auto entries = FlatVector::GetData<list_entry_t>(list);
+    entries[row] = list_entry_t(offset, count);
+    ListVector::SetListSize(list, offset + count);
+    return FlatVector::GetData<double>(ListVector::GetEntry(list)) + offset;
+}
+
+static void WriteString(Vector &vector, idx_t row, const std::string &str) {
+    FlatVector::GetData<string_t>(vector)[row] = StringVector::AddString(vector, str);
+}
+
+template <class T>
+static uint8_t WriteReal(const pxr::VtValue &value, const UsdValueVectors &out, idx_t row) {
+    if (!value.IsHolding<T>() || !out.value_double) {
+        return 0;
+    }
+    FlatVector::GetData<double>(*out.value_double)[row] = static_cast<double>(value.UncheckedGet<T>());
+    return USD_VALUE_DOUBLE;
+}
+
+// Integers fill value_int and, so that numeric aggregates need no cast,
+// value_double as well
+template <class T>
+static uint8_t WriteInteger(const pxr::VtValue &value, const UsdValueVectors &out, idx_t row) {
+    if (!value.IsHolding<T>()) {
+        return 0;
+    }
+    auto integer = value.UncheckedGet<T>();
+    uint8_t written = 0;
+    if (out.value_double) {
+        FlatVector::GetData<double>(*out.value_double)[row] = static_cast<double>(integer);
+        written |= USD_VALUE_DOUBLE;
+    }
+    int64_t result;
+    if (out.value_int && TryCast::Operation<T, int64_t>(integer, result)) {
+        FlatVector::GetData<int64_t>(*out.value_int)[row] = result;
+        written |= USD_VALUE_INT;
+    }
+    return written;
+}
+
+static uint8_t WriteBool(const pxr::VtValue &value, const UsdValueVectors &out, idx_t row) {
+    if (!value.IsHolding<bool>() || !out.value_bool) {
+        return 0;
+    }
+    FlatVector::GetData<bool>(*out.value_bool)[row] = value.UncheckedGet<bool>();
+    return USD_VALUE_BOOL;
+}
+
+static uint8_t WriteToken(const pxr::VtValue &value, const UsdValueVectors &out, idx_t row) {
+    if (!out.value_token) {
+        return 0;
+    }
+    if (value.IsHolding<pxr::TfToken>()) {
+        WriteString(*out.value_token, row, value.UncheckedGet<pxr::TfToken>().GetString());
+    } else if (value.IsHolding<std::string>()) {
+        WriteString(*out.value_token, row, value.UncheckedGet<std::string>());
+    } else if (value.IsHolding<pxr::SdfAssetPath>()) {
+        WriteString(*out.value_token, row, value.UncheckedGet<pxr::SdfAssetPath>().GetAssetPath());
+    } else {
+        return 0;
+    }
+    return USD_VALUE_TOKEN;
+}
+
+template <class V>
+static uint8_t WriteVec3(const pxr::VtValue &value, const UsdValueVectors &out, idx_t row) {
+    if (!value.IsHolding<V>() || !out.value_vec3) {
+        return 0;
+    }
+    const auto &vec = value.UncheckedGet<V>();
+    auto child = FlatVector::GetData<double>(ArrayVector::GetEntry(*out.value_vec3)) + row * VEC3_SIZE;
+    for (idx_t i = 0; i < VEC3_SIZE; i++) {
+        child[i] = static_cast<double>(vec[i]);
+    }
+    return USD_VALUE_VEC3;
+}
+
+template <class T>
+static uint8_t WriteScalarArray(const pxr::VtValue &value, const UsdValueVectors &out, idx_t row) {
+    if (!value.IsHolding<pxr::VtArray<T>>() || !out.value_array) {
+        return 0;
+    }
+    const auto &array = value.UncheckedGet<pxr::VtArray<T>>();
+    auto child = AppendListEntry(*out.value_array, row, array.size());
+    const T *source = array.cdata();
+    for (idx_t i = 0; i < array.size(); i++) {
+        child[i] = static_cast<double>(source[i]);
+    }
+    return USD_VALUE_ARRAY;
+}
+
+// Vector arrays (points, normals, ...) are flattened component by component
+template <class V>
+static uint8_t WriteVectorArray(const pxr::VtValue &value, const UsdValueVectors &out, idx_t row) {
+    if (!value.IsHolding<pxr::VtArray<V>>() || !out.value_array) {
+        return 0;
+    }
+    const auto &array = value.UncheckedGet<pxr::VtArray<V>>();
+    constexpr idx_t dimension = V::dimension;
+    auto child = AppendListEntry(*out.value_array, row, array.size() * dimension);
+    const V *source = array.cdata();
+    for (idx_t i = 0; i < array.size(); i++) {
+        for (idx_t d = 0; d < dimension; d++) {
+            child[i * dimension + d] = static_cast<double>(source[i][d]);
+        }
+    }
+    return USD_VALUE_ARRAY;
+}
+
+typedef std::unordered_map<pxr::TfType, usd_value_writer_t, pxr::TfHash> writer_by_type_t;
+
+template <class T>
+static void RegisterWriter(writer_by_type_t &writers, usd_value_writer_t writer) {
+    writers[pxr::TfType::Find<T>()] = writer;
+}
+
+// Writers by the C++ value type held in the VtValue
+static writer_by_type_t BuildWritersByType() {
+    writer_by_type_t writers;
+    RegisterWriter<double>(writers, WriteReal<double>);
+    RegisterWriter<float>(writers, WriteReal<float>);
+    RegisterWriter<pxr::GfHalf>(writers, WriteReal<pxr::GfHalf>);
+    RegisterWriter<int>(writers, WriteInteger<int>);
+    RegisterWriter<unsigned int>(writers, WriteInteger<unsigned int>);
+    RegisterWriter<int64_t>(writers, WriteInteger<int64_t>);
+    RegisterWriter<uint64_t>(writers, WriteInteger<uint64_t>);
+    RegisterWriter<unsigned char>(writers, WriteInteger<unsigned char>);
+    RegisterWriter<bool>(writers, WriteBool);
+    RegisterWriter<pxr::TfToken>(writers, WriteToken);
+    RegisterWriter<std::string>(writers, WriteToken);
+    RegisterWriter<pxr::SdfAssetPath>(writers, WriteToken);
+    RegisterWriter<pxr::GfVec3d>(writers, WriteVec3<pxr::GfVec3d>);
+    RegisterWriter<pxr::GfVec3f>(writers, WriteVec3<pxr::GfVec3f>);
+    RegisterWriter<pxr::GfVec3h>(writers, WriteVec3<pxr::GfVec3h>);
+    RegisterWriter<pxr::GfVec3i>(writers, WriteVec3<pxr::GfVec3i>);
+    RegisterWriter<pxr::VtArray<double>>(writers, WriteScalarArray<double>);
+    RegisterWriter<pxr::VtArray<float>>(writers, WriteScalarArray<float>);
+    RegisterWriter<pxr::VtArray<pxr::GfHalf>>(writers, WriteScalarArray<pxr::GfHalf>);
+    RegisterWriter<pxr::VtArray<int>>(writers, WriteScalarArray<int>);
+    RegisterWriter<pxr::VtArray<unsigned int>>(writers, WriteScalarArray<unsigned int>);
+    RegisterWriter<pxr::VtArray<int64_t>>(writers, WriteScalarArray<int64_t>);
+    RegisterWriter<pxr::VtArray<uint64_t>>(writers, WriteScalarArray<uint64_t>);
+    RegisterWriter<pxr::VtArray<unsigned char>>(writers, WriteScalarArray<unsigned char>);
+    RegisterWriter<pxr::VtArray<pxr::GfVec2d>>(writers, WriteVectorArray<pxr::GfVec2d>);
+    RegisterWriter<pxr::VtArray<pxr::GfVec2f>>(writers, WriteVectorArray<pxr::GfVec2f>);
+    RegisterWriter<pxr::VtArray<pxr::GfVec2h>>(writers, WriteVectorArray<pxr::GfVec2h>);
+    RegisterWriter<pxr::VtArray<pxr::GfVec3d>>(writers, WriteVectorArray<pxr::GfVec3d>);
+    RegisterWriter<pxr::VtArray<pxr::GfVec3f>>(writers, WriteVectorArray<pxr::GfVec3f>);
+    RegisterWriter<pxr::VtArray<pxr::GfVec3h>>(writers, WriteVectorArray<pxr::GfVec3h>);
+    RegisterWriter<pxr::VtArray<pxr::GfVec4d>>(writers, WriteVectorArray<pxr::GfVec4d>);
+    RegisterWriter<pxr::VtArray<pxr::GfVec4f>>(writers, WriteVectorArray<pxr::GfVec4f>);
+    RegisterWriter<pxr::VtArray<pxr::GfVec4h>>(writers, WriteVectorArray<pxr::GfVec4h>);
+    return writers;
+}
+
+typedef std::unordered_map<pxr::SdfValueTypeName, usd_value_writer_t, pxr::TfHash> writer_by_name_t;
+
+// Every registered value type name (including roles such as point3f or
+// color3f) mapped to the writer of the C++ type it holds
+static writer_by_name_t BuildWritersByName() {
+    auto by_type = BuildWritersByType();
+    writer_by_name_t writers;
+    for (const auto &type_name : pxr::SdfSchema::GetInstance().GetAllTypes()) {
+        auto entry = by_type.find(type_name.GetType());
+        if (entry != by_type.end()) {
+            writers[type_name] = entry->second;
+        }
+    }
+    return writers;
+}
+
+usd_value_writer_t UsdValueDispatch::GetWriter(const pxr::SdfValueTypeName &type_name) {
+    static const writer_by_name_t writers = BuildWritersByName();
+    auto entry = writers.find(type_name);
+    return entry == writers.end() ? nullptr : entry->second;
+}
+
+template <class T>
+static idx_t ArraySize(const pxr::VtValue &value) {
+    return value.UncheckedGet<pxr::VtArray<T>>().size();
+}
+
+template <class T, class DST>
+static void CopyScalarArray(const pxr::VtValue &value, idx_t offset, idx_t count, Vector &target,
+                            idx_t target_offset) {
+    const T *source = value.UncheckedGet<pxr::VtArray<T>>().cdata() + offset;
+    auto dest = FlatVector::GetData<DST>(target) + target_offset;
+    if (std::is_same<T, DST>::value) {
+        memcpy(static_cast<void *>(dest), static_cast<const void *>(source), count * sizeof(T));
+        return;
+    }
+    for (idx_t i = 0; i < count; i++) {
+        dest[i] = static_cast<DST>(source[i]);
+    }
+}
+
+// GfVec types are tightly packed, so a run of vectors is a run of components
+template <class V, class DST>
+static void CopyVectorArray(const pxr::VtValue &value, idx_t offset, idx_t count, Vector &target,
+                            idx_t target_offset) {
+    constexpr idx_t dimension = V::dimension;
+    const V *source = value.UncheckedGet<pxr::VtArray<V>>().cdata() + offset;
+    auto dest = FlatVector::GetData<DST>(ArrayVector::GetEntry(target)) + target_offset * dimension;
+    if (std::is_same<typename V::ScalarType, DST>::value && sizeof(V) == dimension * sizeof(DST)) {
+        memcpy(static_cast<void *>(dest), static_cast<const void *>(source), count * sizeof(V));
+        return;
+    }
+    for (idx_t i = 0; i < count; i++) {
+        for (idx_t d = 0; d < dimension; d++) {
+            dest[i * dimension + d] = static_cast<DST>(source[i][d]);
+        }
+    }
+}
+
+template <class T, class DST>
+static UsdArrayCopier ScalarCopier(const LogicalType &element_type) {
+    return UsdArrayCopier {pxr::TfType::Find<pxr::VtArray<T>>(), element_type, ArraySize<T>, CopyScalarArray<T, DST>};
+}
+
+template <class V, class DST>
+static UsdArrayCopier VectorCopier(const LogicalType &component_type) {
+    return UsdArrayCopier {pxr::TfType::Find<pxr::VtArray<V>>(), LogicalType::ARRAY(component_type, V::dimension),
+                           ArraySize<V>, CopyVectorArray<V, DST>};
+}
+
+static vector<UsdArrayCopier> BuildArrayCopiers() {
+    vector<UsdArrayCopier> copiers;
+    copiers.push_back(ScalarCopier<float, float>(LogicalType::FLOAT));
+    copiers.push_back(ScalarCopier<double, double>(LogicalType::DOUBLE));
+    copiers.push_back(ScalarCopier<pxr::GfHalf, float>(LogicalType::FLOAT));
+    copiers.push_back(ScalarCopier<int, int32_t>(LogicalType::INTEGER));
+    copiers.push_back(ScalarCopier<unsigned int, uint32_t>(LogicalType::UINTEGER));
+    copiers.push_back(ScalarCopier<int64_t, int64_t>(LogicalType::BIGINT));
+    copiers.push_back(ScalarCopier<uint64_t, uint64_t>(LogicalType::UBIGINT));
+    copiers.push_back(ScalarCopier<unsigned char, uint8_t>(LogicalType::UTINYINT));
+    copiers.push_back(ScalarCopier<bool, bool>(LogicalType::BOOLEAN));
+    copiers.push_back(VectorCopier<pxr::GfVec2f, float>(LogicalType::FLOAT));
+    copiers.push_back(VectorCopier<pxr::GfVec3f, float>(LogicalType::FLOAT));
+    copiers.push_back(VectorCopier<pxr::GfVec4f, float>(LogicalType::FLOAT));
+    copiers.push_back(VectorCopier<pxr::GfVec2d, double>(LogicalType::DOUBLE));
+    copiers.push_back(VectorCopier<pxr::GfVec3d, double>(LogicalType::DOUBLE));
+    copiers.push_back(VectorCopier<pxr::GfVec4d, double>(LogicalType::DOUBLE));
+    copiers.push_back(VectorCopier<pxr::GfVec2h, float>(LogicalType::FLOAT));
+    copiers.push_back(VectorCopier<pxr::GfVec3h, float>(LogicalType::FLOAT));
+    copiers.push_back(VectorCopier<pxr::GfVec4h, float>(LogicalType::FLOAT));
+    copiers.push_back(VectorCopier<pxr::GfVec2i, int32_t>(LogicalType::INTEGER));
+    copiers.push_back(VectorCopier<pxr::GfVec3i, int32_t>(LogicalType::INTEGER));
+    copiers.push_back(VectorCopier<pxr::GfVec4i, int32_t>(LogicalType::INTEGER));
+    return copiers;
+}
+
+const UsdArrayCopier *UsdArrayCopier::Get(const pxr::SdfValueTypeName &type_name) {
+    static const vector<UsdArrayCopier> copiers = BuildArrayCopiers();
+    auto value_type = type_name.GetType();
+    for (auto &copier : copiers) {
+        if (copier.value_type == value_type) {
+            return &copier;
+        }
+    }
+    return nullptr;
+}
+
+std::string UsdValueDispatch::FormatValue(const pxr::VtValue &value) {
+    if (value.IsEmpty()) {
+        return "";
+    }
+
+    std::ostringstream oss;
+    oss << value;
+    return oss.str();
+}
+
+void UsdValueDispatch::AddColumns(vector<string> &names, vector<LogicalType> &return_types) {
+    names.emplace_back("value_double");
+    return_types.emplace_back(LogicalType::DOUBLE);
+    names.emplace_back("value_int");
+    return_types.emplace_back(LogicalType::BIGINT);
+    names.emplace_back("value_bool");
+    return_types.emplace_back(LogicalType::BOOLEAN);
+    names.emplace_back("value_token");
+    return_types.emplace_back(LogicalType::VARCHAR);
+    names.emplace_back("value_vec3");
+    return_types.emplace_back(LogicalType::ARRAY(LogicalType::DOUBLE, VEC3_SIZE));
+    names.emplace_back("value_array");
+    return_types.emplace_back(LogicalType::LIST(LogicalType::DOUBLE));
+}
+
+} // namespace duckdb
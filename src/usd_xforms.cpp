@@ -5,26 +5,68 @@
 #include <pxr/usd/usd/primRange.h>
 #include <pxr/usd/usdGeom/xformable.h>
 #include <pxr/usd/usdGeom/xformCache.h>
+#include <pxr/base/gf/matrix3d.h>
 #include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/quatd.h>
+#include <pxr/base/gf/rotation.h>
 #include <pxr/base/gf/vec3d.h>
-#include <filesystem>
+#include <cmath>
+#include <cstring>
 
 namespace duckdb {
 
+// Table columns, in schema order
+static constexpr idx_t COL_PRIM_PATH = 0;
+static constexpr idx_t COL_X = 1;
+static constexpr idx_t COL_Y = 2;
+static constexpr idx_t COL_Z = 3;
+static constexpr idx_t COL_HAS_ROTATION = 4;
+static constexpr idx_t COL_HAS_SCALE = 5;
+static constexpr idx_t COL_WORLD_MATRIX = 6;
+static constexpr idx_t COL_LOCAL_MATRIX = 7;
+static constexpr idx_t COL_ROTATION_QUAT = 8;
+static constexpr idx_t COL_SCALE = 9;
+static constexpr idx_t COLUMN_COUNT = 10;
+// Rows per root layer spec, for estimates before the first complete scan
+static constexpr double ROWS_PER_SPEC = 0.15;
+
+static constexpr idx_t MATRIX_SIZE = 16;
+static constexpr idx_t QUAT_SIZE = 4;
+static constexpr idx_t SCALE_SIZE = 3;
+static constexpr double XFORM_EPSILON = 1e-6;
+
 // Bind data structure
 struct UsdXformsBindData : public TableFunctionData {
-    std::string file_path;
-    explicit UsdXformsBindData(std::string path) : file_path(std::move(path)) {}
+    // Files to scan (a path, the matches of a glob, or a list)
+    vector<std::string> files;
+    // Population mask and payload loading requested with mask := / load :=
+    UsdStageLoadOptions load_options;
+    // Path predicates pushed down from the query
+    UsdScanFilter filter;
+    // Row estimate for the planner and the progress bar
+    UsdScanEstimate estimate;
+    // Time at which transforms are evaluated (time := , default time otherwise)
+    pxr::UsdTimeCode time = pxr::UsdTimeCode::Default();
+    explicit UsdXformsBindData(vector<std::string> files_p) : files(std::move(files_p)) {}
 };
 
-// Global state for iteration
-struct UsdXformsGlobalState : public GlobalTableFunctionState {
-    pxr::UsdStageRefPtr stage;
+// Per-thread cursor into the file currently being scanned
+struct UsdXformsLocalState : public UsdMultiFileLocalState {
     std::unique_ptr<UsdPrimIterator> prim_iterator;
     std::unique_ptr<pxr::UsdGeomXformCache> xform_cache;
-    bool finished = false;
 
-    UsdXformsGlobalState() = default;
+    // Claims the next file and starts iterating its prims
+    bool NextFile(ClientContext &context, UsdMultiFileGlobalState &gstate, const UsdXformsBindData &bind_data) {
+        prim_iterator.reset();
+        if (!OpenNextFile(context, gstate, bind_data.files, bind_data.load_options.WithFilter(bind_data.filter))) {
+            return false;
+        }
+        // Create prim iterator over the prims that can satisfy the filters
+        prim_iterator = std::make_unique<UsdPrimIterator>(stage, bind_data.filter, &profile);
+        // Create XformCache for efficient transform computation at the requested time
+        xform_cache = std::make_unique<pxr::UsdGeomXformCache>(bind_data.time);
+        return true;
+    }
 };
 
 // Bind function
@@ -35,27 +77,8 @@ static unique_ptr<FunctionData> UsdXformsBind(ClientContext &context, TableFunct
         throw BinderException("usd_xforms requires exactly one argument: file_path");
     }
 
-    auto file_path = input.inputs[0].GetValue<string>();
-
-    // Check for empty path
-    if (file_path.empty() || file_path.find_first_not_of(" \t\n\r") == std::string::npos) {
-        throw BinderException("usd_xforms: file_path cannot be empty");
-    }
-
-    // Check if file exists
-    if (!std::filesystem::exists(file_path)) {
-        throw BinderException("usd_xforms: USD file not found: " + file_path);
-    }
-
-    // Check if it's a directory
-    if (std::filesystem::is_directory(file_path)) {
-        throw BinderException("usd_xforms: path is a directory, not a file: " + file_path);
-    }
-
-    // Validate file extension
-    if (!UsdStageManager::IsValidUsdFile(file_path)) {
-        throw BinderException("usd_xforms: file must have a USD extension (.usd, .usda, .usdc, .usdz): " + file_path);
-    }
+    // One path, a glob pattern or a list of either
+    auto files = UsdFileList::Bind(context, "usd_xforms", input.inputs[0]);
 
     // Define output schema
     return_types = {
@@ -64,50 +87,120 @@ static unique_ptr<FunctionData> UsdXformsBind(ClientContext &context, TableFunct
         LogicalTypeId::DOUBLE,   // y
         LogicalTypeId::DOUBLE,   // z
         LogicalTypeId::BOOLEAN,  // has_rotation
-        LogicalTypeId::BOOLEAN   // has_scale
+        LogicalTypeId::BOOLEAN,  // has_scale
+        LogicalType::ARRAY(LogicalType::DOUBLE, MATRIX_SIZE),  // world_matrix
+        LogicalType::ARRAY(LogicalType::DOUBLE, MATRIX_SIZE),  // local_matrix
+        LogicalType::ARRAY(LogicalType::DOUBLE, QUAT_SIZE),    // rotation_quat
+        LogicalType::ARRAY(LogicalType::DOUBLE, SCALE_SIZE)    // scale
     };
 
-    names = {"prim_path", "x", "y", "z", "has_rotation", "has_scale"};
-
-    return make_uniq<UsdXformsBindData>(file_path);
+    names = {"prim_path", "x", "y", "z", "has_rotation", "has_scale",
+             "world_matrix", "local_matrix", "rotation_quat", "scale"};
+
+    auto result = make_uniq<UsdXformsBindData>(std::move(files));
+    result->estimate = UsdScanStatistics::Estimate(context, "usd_xforms", result->files, ROWS_PER_SPEC,
+                                                   input.named_parameters.empty(), COLUMN_COUNT);
+    result->load_options.Bind("usd_xforms", input.named_parameters);
+    result->filter.BindTraversal("usd_xforms", input.named_parameters);
+    for (auto &kv : input.named_parameters) {
+        if (kv.first == "time" && !kv.second.IsNull()) {
+            result->time = pxr::UsdTimeCode(kv.second.GetValue<double>());
+        }
+    }
+    return std::move(result);
 }
 
 // Init function
 static unique_ptr<GlobalTableFunctionState> UsdXformsInit(ClientContext &context, TableFunctionInitInput &input) {
     auto &bind_data = input.bind_data->Cast<UsdXformsBindData>();
-    auto state = make_uniq<UsdXformsGlobalState>();
+    auto state = make_uniq<UsdMultiFileGlobalState>(bind_data.files.size());
+    state->projection = UsdColumnProjection(input.column_ids, COLUMN_COUNT);
+    state->tracker.Start(context, bind_data.estimate, bind_data.filter.IsEmpty());
+    return std::move(state);
+}
 
-    // Open USD stage
-    state->stage = UsdStageManager::OpenStage(bind_data.file_path);
+// Each thread opens (through the stage cache) the stages of the files it claims
+static unique_ptr<LocalTableFunctionState> UsdXformsInitLocal(ExecutionContext &context, TableFunctionInitInput &input,
+                                                              GlobalTableFunctionState *global_state) {
+    return make_uniq<UsdXformsLocalState>();
+}
+
+UsdXformBasis::UsdXformBasis(const pxr::GfMatrix4d &matrix) {
+    rotation.SetIdentity();
+    double sign = matrix.ExtractRotationMatrix().GetDeterminant() < 0 ? -1.0 : 1.0;
+    for (int i = 0; i < 3; i++) {
+        auto row = matrix.GetRow3(i);
+        double length = row.GetLength();
+        scale[i] = sign * length;
+        if (length > XFORM_EPSILON) {
+            rotation.SetRow(i, row / scale[i]);
+        }
+    }
+}
 
-    // Create prim iterator
-    state->prim_iterator = std::make_unique<UsdPrimIterator>(state->stage);
+bool UsdXformBasis::HasScale() const {
+    for (int i = 0; i < 3; i++) {
+        if (!pxr::GfIsClose(scale[i], 1.0, XFORM_EPSILON)) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    // Create XformCache for efficient transform computation at default time
-    state->xform_cache = std::make_unique<pxr::UsdGeomXformCache>(pxr::UsdTimeCode::Default());
+bool UsdXformBasis::HasRotation() const {
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            if (!pxr::GfIsClose(rotation[i][j], i == j ? 1.0 : 0.0, XFORM_EPSILON)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
 
-    return std::move(state);
+void UsdWriteMatrix(Vector &vector, idx_t row, const pxr::GfMatrix4d &matrix) {
+    auto dest = FlatVector::GetData<double>(ArrayVector::GetEntry(vector)) + row * MATRIX_SIZE;
+    memcpy(dest, matrix.data(), MATRIX_SIZE * sizeof(double));
 }
 
 // Execute function
 static void UsdXformsExecute(ClientContext &context, TableFunctionInput &data_p, DataChunk &output) {
-    auto &state = data_p.global_state->Cast<UsdXformsGlobalState>();
-
-    if (state.finished) {
-        output.SetCardinality(0);
-        return;
-    }
+    auto &bind_data = data_p.bind_data->Cast<UsdXformsBindData>();
+    auto &gstate = data_p.global_state->Cast<UsdMultiFileGlobalState>();
+    auto &state = data_p.local_state->Cast<UsdXformsLocalState>();
 
     idx_t count = 0;
-
-    auto prim_path_data = FlatVector::GetData<string_t>(output.data[0]);
-    auto x_data = FlatVector::GetData<double>(output.data[1]);
-    auto y_data = FlatVector::GetData<double>(output.data[2]);
-    auto z_data = FlatVector::GetData<double>(output.data[3]);
-    auto has_rotation_data = FlatVector::GetData<bool>(output.data[4]);
-    auto has_scale_data = FlatVector::GetData<bool>(output.data[5]);
-
-    while (count < STANDARD_VECTOR_SIZE && state.prim_iterator->HasNext()) {
+    auto &projection = gstate.projection;
+
+    // Only projected columns are computed; unprojected ones get nullptr
+    auto prim_path_out = projection.GetVector(output, COL_PRIM_PATH);
+    auto prim_path_data = projection.GetData<string_t>(output, COL_PRIM_PATH);
+    auto x_data = projection.GetData<double>(output, COL_X);
+    auto y_data = projection.GetData<double>(output, COL_Y);
+    auto z_data = projection.GetData<double>(output, COL_Z);
+    auto has_rotation_data = projection.GetData<bool>(output, COL_HAS_ROTATION);
+    auto has_scale_data = projection.GetData<bool>(output, COL_HAS_SCALE);
+    auto world_matrix_out = projection.GetVector(output, COL_WORLD_MATRIX);
+    auto local_matrix_out = projection.GetVector(output, COL_LOCAL_MATRIX);
+    auto rotation_quat_out = projection.GetVector(output, COL_ROTATION_QUAT);
+    auto scale_out = projection.GetVector(output, COL_SCALE);
+    auto rotation_quat_data =
+        rotation_quat_out ? FlatVector::GetData<double>(ArrayVector::GetEntry(*rotation_quat_out)) : nullptr;
+    auto scale_data = scale_out ? FlatVector::GetData<double>(ArrayVector::GetEntry(*scale_out)) : nullptr;
+    // The basis (row lengths) is only computed for the flag, quaternion and
+    // scale columns; no column needs a full Factor() decomposition
+    bool need_basis = has_rotation_data || has_scale_data || rotation_quat_data || scale_data;
+    bool need_transform = x_data || y_data || z_data || world_matrix_out || need_basis;
+
+    while (count < STANDARD_VECTOR_SIZE) {
+        // A chunk never spans two files
+        if (!state.prim_iterator || !state.prim_iterator->HasNext()) {
+            if (count > 0 || !state.NextFile(context, gstate, bind_data)) {
+                break;
+            }
+            continue;
+        }
+        state.profile.Enter(UsdScanPhase::TRAVERSE);
         auto prim = state.prim_iterator->GetNext();
 
         // Check if prim is Xformable
@@ -115,64 +208,94 @@ static void UsdXformsExecute(ClientContext &context, TableFunctionInput &data_p,
             continue;
         }
 
-        // Get world-space transform
-        pxr::GfMatrix4d world_transform = state.xform_cache->GetLocalToWorldTransform(prim);
-
-        // Extract translation
-        pxr::GfVec3d translation = world_transform.ExtractTranslation();
-
-        // Decompose matrix to detect rotation and scale
-        // Factor() decomposes into: M = r * s * -r * u * t
-        // where r is rotation, s is scale, u may contain shear, t is translation
-        pxr::GfMatrix4d r, u, p;
-        pxr::GfVec3d s, t;
-        bool has_rotation = false;
-        bool has_scale = false;
-
-        if (world_transform.Factor(&r, &s, &u, &t, &p)) {
-            // Check if there's non-identity rotation
-            // Compare rotation matrix rows with identity matrix
-            pxr::GfMatrix4d identity;
-            identity.SetIdentity();
-            auto r0 = r.GetRow3(0);
-            auto r1 = r.GetRow3(1);
-            auto r2 = r.GetRow3(2);
-            auto i0 = identity.GetRow3(0);
-            auto i1 = identity.GetRow3(1);
-            auto i2 = identity.GetRow3(2);
-
-            has_rotation = !pxr::GfIsClose(r0[0], i0[0], 1e-6) || !pxr::GfIsClose(r0[1], i0[1], 1e-6) || !pxr::GfIsClose(r0[2], i0[2], 1e-6) ||
-                          !pxr::GfIsClose(r1[0], i1[0], 1e-6) || !pxr::GfIsClose(r1[1], i1[1], 1e-6) || !pxr::GfIsClose(r1[2], i1[2], 1e-6) ||
-                          !pxr::GfIsClose(r2[0], i2[0], 1e-6) || !pxr::GfIsClose(r2[1], i2[1], 1e-6) || !pxr::GfIsClose(r2[2], i2[2], 1e-6);
-
-            // Check if there's non-uniform or non-identity scale
-            // Scale factors of (1, 1, 1) mean no scale
-            has_scale = !pxr::GfIsClose(s[0], 1.0, 1e-6) ||
-                       !pxr::GfIsClose(s[1], 1.0, 1e-6) ||
-                       !pxr::GfIsClose(s[2], 1.0, 1e-6);
+        // Emit row
+        state.profile.Enter(UsdScanPhase::EMIT);
+        if (prim_path_data) {
+            prim_path_data[count] = StringVector::AddString(*prim_path_out, prim.GetPath().GetString());
         }
 
-        // Emit row
-        prim_path_data[count] = StringVector::AddString(output.data[0], prim.GetPath().GetString());
-        x_data[count] = translation[0];
-        y_data[count] = translation[1];
-        z_data[count] = translation[2];
-        has_rotation_data[count] = has_rotation;
-        has_scale_data[count] = has_scale;
+        // Transforms are written as they are computed
+        state.profile.Enter(UsdScanPhase::EXTRACT);
+        if (need_transform) {
+            // Get world-space transform
+            pxr::GfMatrix4d world_transform = state.xform_cache->GetLocalToWorldTransform(prim);
+
+            // Extract translation
+            pxr::GfVec3d translation = world_transform.ExtractTranslation();
+            if (x_data) {
+                x_data[count] = translation[0];
+            }
+            if (y_data) {
+                y_data[count] = translation[1];
+            }
+            if (z_data) {
+                z_data[count] = translation[2];
+            }
+            if (world_matrix_out) {
+                UsdWriteMatrix(*world_matrix_out, count, world_transform);
+            }
+
+            if (need_basis) {
+                UsdXformBasis basis(world_transform);
+                if (has_rotation_data) {
+                    has_rotation_data[count] = basis.HasRotation();
+                }
+                if (has_scale_data) {
+                    has_scale_data[count] = basis.HasScale();
+                }
+                if (rotation_quat_data) {
+                    // (w, x, y, z)
+                    auto quat = basis.rotation.ExtractRotation().GetQuat();
+                    auto dest = rotation_quat_data + count * QUAT_SIZE;
+                    dest[0] = quat.GetReal();
+                    dest[1] = quat.GetImaginary()[0];
+                    dest[2] = quat.GetImaginary()[1];
+                    dest[3] = quat.GetImaginary()[2];
+                }
+                if (scale_data) {
+                    auto dest = scale_data + count * SCALE_SIZE;
+                    for (idx_t i = 0; i < SCALE_SIZE; i++) {
+                        dest[i] = basis.scale[i];
+                    }
+                }
+            }
+        }
+
+        if (local_matrix_out) {
+            bool resets_xform_stack;
+            UsdWriteMatrix(*local_matrix_out, count,
+                           state.xform_cache->GetLocalTransformation(prim, &resets_xform_stack));
+        }
 
         count++;
     }
 
-    if (!state.prim_iterator->HasNext()) {
-        state.finished = true;
+    output.SetCardinality(count);
+    if (count > 0) {
+        state.FinalizeChunk(gstate, output, bind_data.files);
     }
+}
 
-    output.SetCardinality(count);
+static void UsdXformsPushdownFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+                                    vector<unique_ptr<Expression>> &filters) {
+    auto &bind_data = bind_data_p->Cast<UsdXformsBindData>();
+    UsdFilterColumns columns;
+    columns.prim_path = COL_PRIM_PATH;
+    bind_data.filter.Pushdown(get, filters, columns);
 }
 
 // Get the table function
 TableFunction UsdXformsFunction::GetFunction() {
-    TableFunction func("usd_xforms", {LogicalTypeId::VARCHAR}, UsdXformsExecute, UsdXformsBind, UsdXformsInit);
+    TableFunction func("usd_xforms", {LogicalTypeId::VARCHAR}, UsdXformsExecute, UsdXformsBind, UsdXformsInit,
+                       UsdXformsInitLocal);
+    func.get_partition_data = UsdMultiFileLocalState::GetPartitionData;
+    func.projection_pushdown = true;
+    UsdScanStatistics::Register<UsdXformsBindData, UsdMultiFileGlobalState>(func);
+    UsdFileList::RegisterFilenameColumn(func);
+    UsdStageLoadOptions::RegisterParameters(func);
+    UsdScanFilter::RegisterParameters(func);
+    func.pushdown_complex_filter = UsdXformsPushdownFilter;
+    func.named_parameters["time"] = LogicalType::DOUBLE;
     return func;
 }
 